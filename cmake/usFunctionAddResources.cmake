@@ -85,7 +85,8 @@ function(usFunctionAddResources)
     set(US_RESOURCE_WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/${US_RESOURCE_WORKING_DIRECTORY}")
   endif()
 
-  if(US_RESOURCE_COMPRESSION_LEVEL)
+  # Level 0 evaluates to false
+  if(DEFINED US_RESOURCE_COMPRESSION_LEVEL)
     set(cmd_line_args -c ${US_RESOURCE_COMPRESSION_LEVEL})
   endif()
 
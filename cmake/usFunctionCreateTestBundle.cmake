@@ -21,14 +21,21 @@ macro(_us_create_test_bundle_helper)
   
   target_link_libraries(${name} ${${PROJECT_NAME}_TARGET} ${US_TEST_LINK_LIBRARIES} ${US_TEST_OTHER_LIBRARIES} CppMicroServices)
 
+  set(_compression_level )
+  if(DEFINED US_TEST_COMPRESSION_LEVEL)
+    set(_compression_level COMPRESSION_LEVEL ${US_TEST_COMPRESSION_LEVEL})
+  endif()
+
   if(_res_files OR US_TEST_LINK_LIBRARIES)
     usFunctionAddResources(TARGET ${name} WORKING_DIRECTORY ${_res_root}
                            FILES ${_res_files}
-                           ZIP_ARCHIVES ${US_TEST_LINK_LIBRARIES})
+                           ZIP_ARCHIVES ${US_TEST_LINK_LIBRARIES}
+                           ${_compression_level})
   endif()
   if(_bin_res_files)
     usFunctionAddResources(TARGET ${name} WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/resources
-                           FILES ${_bin_res_files})
+                           FILES ${_bin_res_files}
+                           ${_compression_level})
   endif()
 
   usFunctionEmbedResources(TARGET ${name} ${_mode})
@@ -49,7 +56,7 @@ function(usFunctionCreateTestBundle name)
 endfunction()
 
 function(usFunctionCreateTestBundleWithResources name)
-  cmake_parse_arguments(US_TEST "SKIP_BUNDLE_LIST;LINK_RESOURCES;APPEND_RESOURCES" "RESOURCES_ROOT;LIBRARY_EXTENSION;BUNDLE_SYMBOLIC_NAME" "SOURCES;RESOURCES;BINARY_RESOURCES;LINK_LIBRARIES;OTHER_LIBRARIES" "" ${ARGN})
+  cmake_parse_arguments(US_TEST "SKIP_BUNDLE_LIST;LINK_RESOURCES;APPEND_RESOURCES" "RESOURCES_ROOT;LIBRARY_EXTENSION;BUNDLE_SYMBOLIC_NAME;COMPRESSION_LEVEL" "SOURCES;RESOURCES;BINARY_RESOURCES;LINK_LIBRARIES;OTHER_LIBRARIES" "" ${ARGN})
 
   if(US_TEST_BUNDLE_SYMBOLIC_NAME)
     set(_bundle_symbolic_name ${US_TEST_BUNDLE_SYMBOLIC_NAME})
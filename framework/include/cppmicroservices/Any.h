@@ -37,12 +37,15 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <functional>
 #include <list>
 #include <map>
 #include <memory>
+#include <new>
 #include <set>
 #include <sstream>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -296,7 +299,7 @@ public:
    */
   template<typename ValueType>
   Any(const ValueType& value)
-    : _content(new Holder<ValueType>(value))
+    : _content(Construct<ValueType>(value))
   {}
 
   /**
@@ -305,7 +308,7 @@ public:
    * \param other The Any to copy
    */
   Any(const Any& other)
-    : _content(other._content ? other._content->Clone() : nullptr)
+    : _content(other._content ? other._content->CloneInto(&_buffer) : nullptr)
   {}
 
   /**
@@ -314,8 +317,12 @@ public:
    * @param other The Any to move
    */
   Any(Any&& other) noexcept
-    : _content(std::move(other._content))
-  {}
+    : _content(other._content ? other._content->MoveInto(&_buffer) : nullptr)
+  {
+    other._content = nullptr;
+  }
+
+  ~Any() { Reset(); }
 
   /**
    * Swaps the content of the two Anys.
@@ -324,7 +331,11 @@ public:
    */
   Any& Swap(Any& rhs)
   {
-    std::swap(_content, rhs._content);
+    if (this != &rhs) {
+      Any tmp(std::move(rhs));
+      rhs = std::move(*this);
+      *this = std::move(tmp);
+    }
     return *this;
   }
 
@@ -409,7 +420,14 @@ public:
    */
   Any& operator=(Any&& rhs) noexcept
   {
-    _content = std::move(rhs._content);
+    if (this != &rhs) {
+      // rhs may live inside our own content, so detach it before
+      // destroying the old value
+      Any tmp(std::move(rhs));
+      Reset();
+      _content = tmp._content ? tmp._content->MoveInto(&_buffer) : nullptr;
+      tmp._content = nullptr;
+    }
     return *this;
   }
 
@@ -485,10 +503,38 @@ private:
                                const int32_t indent = 0) const = 0;
 
     virtual const std::type_info& Type() const = 0;
-    virtual std::unique_ptr<Placeholder> Clone() const = 0;
     virtual bool compare(const Any& lhs) const = 0;
+
+    // Copies this holder into the given inline buffer of an Any, or onto
+    // the heap if the held type is not stored inline.
+    virtual Placeholder* CloneInto(void* buffer) const = 0;
+
+    // Moves this holder into the given inline buffer of an Any and
+    // destroys it, or just hands over this heap allocated holder.
+    virtual Placeholder* MoveInto(void* buffer) noexcept = 0;
+
+    // Destroys an inline holder, or deletes a heap allocated one.
+    virtual void Destroy() noexcept = 0;
   };
 
+  // Size of the inline buffer, large enough for a holder of the built-in
+  // scalar types, std::string and std::vector<std::string>.
+  static constexpr std::size_t BufferSize =
+    sizeof(void*) + (sizeof(std::string) > sizeof(std::vector<std::string>)
+                       ? sizeof(std::string)
+                       : sizeof(std::vector<std::string>));
+
+  using Buffer = std::aligned_storage_t<BufferSize, alignof(void*)>;
+
+  template<typename HolderType, typename ValueType>
+  struct IsInline
+    : std::integral_constant<
+        bool,
+        sizeof(HolderType) <= sizeof(Buffer) &&
+          alignof(Buffer) % alignof(HolderType) == 0 &&
+          std::is_nothrow_move_constructible<ValueType>::value>
+  {};
+
   template<typename ValueType>
   class Holder : public Placeholder
   {
@@ -518,9 +564,35 @@ private:
 
     const std::type_info& Type() const override { return typeid(ValueType); }
 
-    std::unique_ptr<Placeholder> Clone() const override
+    Placeholder* CloneInto(void* buffer) const override
+    {
+      if constexpr (IsInline<Holder, ValueType>::value) {
+        return new (buffer) Holder(_held);
+      } else {
+        US_UNUSED(buffer);
+        return new Holder(_held);
+      }
+    }
+
+    Placeholder* MoveInto(void* buffer) noexcept override
+    {
+      if constexpr (IsInline<Holder, ValueType>::value) {
+        Placeholder* moved = new (buffer) Holder(std::move(_held));
+        this->~Holder();
+        return moved;
+      } else {
+        US_UNUSED(buffer);
+        return this;
+      }
+    }
+
+    void Destroy() noexcept override
     {
-      return std::unique_ptr<Placeholder>(new Holder(_held));
+      if constexpr (IsInline<Holder, ValueType>::value) {
+        this->~Holder();
+      } else {
+        delete this;
+      }
     }
 
     ValueType _held;
@@ -543,7 +615,28 @@ private:
   template<typename ValueType>
   friend ValueType* unsafe_any_cast(Any*);
 
-  std::unique_ptr<Placeholder> _content;
+  template<typename ValueType>
+  Placeholder* Construct(const ValueType& value)
+  {
+    if constexpr (IsInline<Holder<ValueType>, ValueType>::value) {
+      return new (&_buffer) Holder<ValueType>(value);
+    } else {
+      return new Holder<ValueType>(value);
+    }
+  }
+
+  void Reset() noexcept
+  {
+    if (_content) {
+      _content->Destroy();
+      _content = nullptr;
+    }
+  }
+
+  // Small values are stored in _buffer, in which case _content points
+  // into it. Otherwise _content points to a heap allocated holder.
+  Buffer _buffer;
+  Placeholder* _content;
 };
 
 /**
@@ -606,8 +699,7 @@ template<typename ValueType>
 ValueType* any_cast(Any* operand)
 {
   return operand && operand->Type() == typeid(ValueType)
-           ? &static_cast<Any::Holder<ValueType>*>(operand->_content.get())
-                ->_held
+           ? &static_cast<Any::Holder<ValueType>*>(operand->_content)->_held
            : nullptr;
 }
 
@@ -741,7 +833,7 @@ ValueType& ref_any_cast(Any& operand)
 template<typename ValueType>
 ValueType* unsafe_any_cast(Any* operand)
 {
-  return &static_cast<Any::Holder<ValueType>*>(operand->_content.get())->_held;
+  return &static_cast<Any::Holder<ValueType>*>(operand->_content)->_held;
 }
 
 /**
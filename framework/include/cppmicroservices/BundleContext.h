@@ -31,6 +31,8 @@
 #include "cppmicroservices/ServiceRegistration.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace cppmicroservices {
 
@@ -305,6 +307,38 @@ public:
     const InterfaceMapConstPtr& service,
     const ServiceProperties& properties = ServiceProperties());
 
+  /**
+   * Registers several services with their properties with the framework.
+   *
+   * <p>
+   * This method behaves like calling
+   * RegisterService(const InterfaceMap&, const ServiceProperties&) for each
+   * element of <code>services</code>, but adds all services to the framework
+   * service registry at once and then fires their
+   * ServiceEvent#SERVICE_REGISTERED events in the given order. A service
+   * listener therefore sees all services of the batch as registered when it
+   * receives the first event. Prefer this method when a bundle registers
+   * many services at the same time, e.g. in its activator.
+   *
+   * <p>
+   * If one of the services is invalid, none of the services is registered.
+   *
+   * @param services Pairs of a shared_ptr to a map of interface identifiers
+   *        to service objects and the properties for that service.
+   * @return The <code>ServiceRegistration</code> objects for the registered
+   *         services, in the order of <code>services</code>.
+   *
+   * @throws std::runtime_error If this BundleContext is no longer valid, or if there are
+             case variants of the same key in one of the supplied properties maps.
+   * @throws std::invalid_argument If one of the InterfaceMaps is empty, or
+   *         if a service is registered as a null class.
+   *
+   * @see RegisterService(const InterfaceMap&, const ServiceProperties&)
+   */
+  std::vector<ServiceRegistrationU> RegisterServices(
+    const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+      services);
+
   /**
    * Registers the specified service object with the specified properties
    * using the specified interfaces types with the framework.
@@ -732,6 +766,23 @@ public:
    */
   ListenerToken AddBundleListener(const BundleListener& listener);
 
+  /**
+   * Adds the specified <code>listener</code> to the context bundles's list
+   * of bundle events listeners. Bundle events listeners are notified of
+   * the lifecycle state changes of bundles in batches, see
+   * BundleEventsListener.
+   *
+   * @param listener Any callable object.
+   * @returns a ListenerToken object which can be used to remove the
+   *          <code>listener</code> from the list of registered listeners.
+   * @throws std::runtime_error If this BundleContext is no
+   *         longer valid.
+   * @see BundleEvent
+   * @see BundleEventsListener
+   * @see RemoveListener()
+   */
+  ListenerToken AddBundleEventsListener(const BundleEventsListener& listener);
+
   /**
    * Removes the specified <code>listener</code> from the context bundle's
    * list of listeners.
@@ -1122,6 +1173,29 @@ public:
     const cppmicroservices::AnyMap& bundleManifest = cppmicroservices::AnyMap(
       cppmicroservices::any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
 
+  /**
+   * Installs all bundles from the bundle libraries at the specified locations.
+   *
+   * This is equivalent to calling InstallBundles(const std::string&, const AnyMap&)
+   * for each location in turn, but the bundle libraries which are not installed
+   * yet are opened and their manifests are read concurrently. The installed
+   * bundles get their bundle ids and <code>BundleEvent::BUNDLE_INSTALLED</code>
+   * events in the order of the locations.
+   *
+   * If the installation of a bundle library fails, the bundles installed from
+   * the preceding locations stay installed and the remaining locations are not
+   * installed.
+   *
+   * @param locations The locations of the bundle libraries to install.
+   *        Duplicate locations are installed once.
+   * @return The Bundle objects of the installed bundle libraries, in the order
+   *         of the locations.
+   * @throws std::runtime_error If the BundleContext is no longer valid, or if the installation failed.
+   * @throws std::logic_error If the framework instance is no longer active
+   * @throws std::invalid_argument If a location is not a valid UTF8 string
+   */
+  std::vector<Bundle> InstallBundles(const std::vector<std::string>& locations);
+
 private:
   friend US_Framework_EXPORT BundleContext
   MakeBundleContext(BundleContextPrivate*);
@@ -36,6 +36,10 @@ namespace cppmicroservices {
 class BundleResourcePrivate;
 struct BundleArchive;
 
+namespace detail {
+class BundleResourceReader;
+}
+
 /**
 \defgroup gr_bundleresource BundleResource
 
@@ -297,6 +301,25 @@ public:
    */
   uint32_t GetCrc32() const;
 
+  /**
+   * Returns a read-only view of the (uncompressed) resource data for this
+   * %BundleResource object. The view holds GetSize() bytes.
+   *
+   * If the resource is stored uncompressed in a bundle whose resources are
+   * mapped into memory, like the resources embedded in a bundle library,
+   * the view aliases the mapped bytes and no copy is made. Otherwise the
+   * resource data is uncompressed into a heap buffer.
+   *
+   * The data stays valid as long as the returned pointer or a copy of it
+   * exists, even if the bundle is uninstalled.
+   *
+   * @return A pointer to the resource data, or \c nullptr if this object is
+   *         invalid or the data cannot be read.
+   *
+   * @see BundleResourceStream
+   */
+  std::shared_ptr<const char> GetDataView() const;
+
 private:
   BundleResource(const std::string& file,
                  const std::shared_ptr<const BundleArchive>& archive);
@@ -318,6 +341,8 @@ private:
 
   std::unique_ptr<void, void (*)(void*)> GetData() const;
 
+  std::unique_ptr<detail::BundleResourceReader> GetDataReader() const;
+
   std::shared_ptr<BundleResourcePrivate> d;
 };
 
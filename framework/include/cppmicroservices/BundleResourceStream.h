@@ -42,7 +42,8 @@ class BundleResource;
  * An input stream class for BundleResource objects.
  *
  * This class provides access to the resource data embedded in a bundle's
- * shared library via a STL input stream interface.
+ * shared library via a STL input stream interface. Resources which are
+ * stored uncompressed in memory are read in place, without a copy.
  *
  * \see BundleResource for an example how to use this class.
  */
@@ -52,6 +53,20 @@ class US_Framework_EXPORT BundleResourceStream
 {
 
 public:
+  /**
+   * The maximum number of bytes of the uncompressed resource data a
+   * stream keeps in memory, see BundleResourceStream(const BundleResource&,
+   * Window, std::ios_base::openmode).
+   */
+  struct Window
+  {
+    explicit Window(std::size_t size)
+      : size(size)
+    {}
+
+    std::size_t size;
+  };
+
   BundleResourceStream(const BundleResourceStream&) = delete;
   BundleResourceStream& operator=(const BundleResourceStream&) = delete;
 
@@ -67,6 +82,28 @@ public:
    */
   BundleResourceStream(const BundleResource& resource,
                        std::ios_base::openmode mode = std::ios_base::in);
+
+  /**
+   * Construct a %BundleResourceStream object which uncompresses the
+   * resource data incrementally while it is read.
+   *
+   * At most \c window.size bytes of the uncompressed data are kept in
+   * memory, which bounds the memory used for reading large resources.
+   * Seeking forward skips data, seeking backward before the data in
+   * memory reads from the beginning of the resource again, so the stream
+   * is best read sequentially.
+   *
+   * @param resource The BundleResource object for which an input stream
+   * should be constructed.
+   * @param window The maximum number of bytes of the resource data to
+   * keep in memory.
+   * @param mode The open mode of the stream. If \c std::ios_base::binary
+   * is not used, all of the resource data is read into memory for the
+   * end-of-line translations.
+   */
+  BundleResourceStream(const BundleResource& resource,
+                       Window window,
+                       std::ios_base::openmode mode = std::ios_base::in);
 };
 }
 
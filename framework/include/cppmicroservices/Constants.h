@@ -212,6 +212,23 @@ US_Framework_EXPORT extern const std::string
  */
 US_Framework_EXPORT extern const std::string ACTIVATION_LAZY; // = "lazy";
 
+/**
+ * Manifest header identifying the bundle's start level.
+ *
+ * When the framework is launched, the bundles to be started are started in
+ * ascending order of their start level. Bundles with the same start level
+ * are started in ascending order of their bundle id, or concurrently if
+ * #FRAMEWORK_BUNDLE_START_THREADS allows it.
+ *
+ * The header value must be an integer. Bundles without this header have
+ * the start level 1.
+ *
+ * The header value may be retrieved from the \c AnyMap object
+ * returned by the \c Bundle::GetHeaders() method.
+ */
+US_Framework_EXPORT extern const std::string
+  BUNDLE_STARTLEVEL; // = "bundle.start_level";
+
 /**
  * Framework environment property identifying the Framework version.
  *
@@ -337,6 +354,87 @@ US_Framework_EXPORT extern const std::string
  */
 US_Framework_EXPORT extern const std::string FRAMEWORK_BUNDLE_VALIDATION_FUNC; // = "org.cppmicroservices.framework.bundle.validation.function"
 
+/**
+ * Framework launching property specifying the service property keys for
+ * which the service registry maintains a secondary index. The value must be
+ * a <code>std::vector<std::string></code> of property keys.
+ *
+ * Service queries whose filter requires an equality match on one of these
+ * keys, such as <code>(plugin.id=foo)</code>, only evaluate the filter
+ * against services registered with that value instead of against all
+ * services of the requested class. By default, no property is indexed.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_INDEX_PROPERTIES; // = "org.cppmicroservices.framework.service.index.properties";
+
+/**
+ * Framework launching property specifying whether the service registry
+ * publishes its lookup structures as immutable snapshots. If set to
+ * boolean <code>true</code>, service lookups do not lock the service
+ * registry, at the cost of copying the affected lookup structures each time
+ * a service is registered, unregistered or changes its ranking. Lookups
+ * in snapshots do not use the indexes of
+ * #FRAMEWORK_SERVICE_INDEX_PROPERTIES.
+ *
+ * This property's default value is boolean <code>false</code>.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_SNAPSHOTS; // = "org.cppmicroservices.framework.service.snapshots";
+
+/**
+ * Framework launching property specifying whether installed bundles are
+ * kept across framework restarts. If set to boolean <code>true</code>, the
+ * framework records the installed bundles, their autostart settings and
+ * their manifests in the persistent storage area (see #FRAMEWORK_STORAGE)
+ * when it stops. The next framework initialization reinstalls the recorded
+ * bundles whose files did not change, without opening the files or parsing
+ * their manifests, and starts the ones which were started persistently.
+ *
+ * This property's default value is boolean <code>false</code>.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_CACHE; // = "org.cppmicroservices.framework.bundle.cache";
+
+/**
+ * Framework launching property specifying the number of threads used to
+ * start bundles when the framework is launched. Bundles with the same start
+ * level (see #BUNDLE_STARTLEVEL) are then started concurrently, and a start
+ * level is only entered once all bundles of the previous start levels have
+ * been started.
+ *
+ * The value must be an integer. With a value of 1 or less the bundles are
+ * started one after the other, in the order of their start level and bundle
+ * id. The value is ignored if the framework was built without threading
+ * support.
+ *
+ * This property's default value is 1.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_BUNDLE_START_THREADS; // = "org.cppmicroservices.framework.bundle.start.threads";
+
+/**
+ * Framework launching property specifying the number of threads which
+ * deliver service events. With a value greater than 0, registering,
+ * modifying and unregistering a service returns without waiting for the
+ * service listeners, and the listeners are called on these threads instead.
+ *
+ * The listeners of one bundle receive their events one at a time and in
+ * the order in which the events occurred. Listeners of different bundles
+ * may receive events concurrently. A listener therefore may see a
+ * service event after the service has changed again, for example a
+ * <code>SERVICE_UNREGISTERING</code> event for an already unregistered
+ * service. Events which have not been delivered yet when the framework
+ * stops are delivered before the framework has stopped.
+ *
+ * The value must be an integer. The value is ignored if the framework was
+ * built without threading support.
+ *
+ * This property's default value is 0, which delivers service events
+ * synchronously on the thread causing them.
+ */
+US_Framework_EXPORT extern const std::string
+  FRAMEWORK_SERVICE_EVENT_THREADS; // = "org.cppmicroservices.framework.service.event.threads";
+
 /*
  * Service properties.
  */
@@ -28,6 +28,7 @@
 
 #include <cstring>
 #include <functional>
+#include <vector>
 
 namespace cppmicroservices {
 
@@ -79,6 +80,28 @@ using ServiceListener = std::function<void(const ServiceEvent&)>;
  */
 using BundleListener = std::function<void(const BundleEvent&)>;
 
+/**
+ * \ingroup MicroServices
+ * \ingroup gr_listeners
+ *
+ * A listener for batches of \c BundleEvent objects. While the Framework
+ * causes many bundle events at once, for example when it starts the
+ * bundles on launch or installs several bundles with one call, it
+ * collects the events and delivers them in one call to a
+ * \c BundleEventsListener, in the order they occurred. Other bundle events
+ * are delivered in batches of one event when they occur.
+ *
+ * A \c BundleEventsListener can be any callable object and is registered
+ * with the Framework using the
+ * {@link BundleContext#AddBundleEventsListener(const BundleEventsListener&)}
+ * method.
+ *
+ * @see BundleEvent
+ * @see BundleListener
+ */
+using BundleEventsListener =
+  std::function<void(const std::vector<BundleEvent>&)>;
+
 /**
  * \ingroup MicroServices
  * \ingroup gr_listeners
@@ -94,6 +94,15 @@ namespace detail {
 US_Framework_EXPORT std::string GetDemangledName(
   const std::type_info& typeInfo);
 
+/**
+ * Returns the process-wide interned copy of an interface id. All calls
+ * with equal ids return the same string object, which lives until the
+ * process exits. Interned ids can therefore be compared and hashed by
+ * address.
+ */
+US_Framework_EXPORT const std::string& InternInterfaceId(
+  const std::string& interfaceId);
+
 template<class Interfaces, size_t size>
 struct InsertInterfaceHelper
 {
@@ -157,15 +166,16 @@ struct Contains<T> : std::false_type
 template<class T>
 const std::string& us_service_interface_iid()
 {
-  static const std::string name =
-    cppmicroservices::detail::GetDemangledName(typeid(T));
+  static const std::string& name = cppmicroservices::detail::InternInterfaceId(
+    cppmicroservices::detail::GetDemangledName(typeid(T)));
   return name;
 }
 
 template<>
 inline const std::string& us_service_interface_iid<void>()
 {
-  static const std::string name;
+  static const std::string& name =
+    cppmicroservices::detail::InternInterfaceId(std::string());
   return name;
 }
 /// \endcond
@@ -221,7 +231,8 @@ inline const std::string& us_service_interface_iid<void>()
   inline const std::string&                                                    \
   us_service_interface_iid<_service_interface_type>()                          \
   {                                                                            \
-    static const std::string name(_service_interface_id);                      \
+    static const std::string& name =                                           \
+      cppmicroservices::detail::InternInterfaceId(_service_interface_id);      \
     return name;                                                               \
   }
 
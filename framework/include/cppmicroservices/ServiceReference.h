@@ -88,8 +88,8 @@ public:
   ServiceReference(const ServiceReferenceBase& base)
     : ServiceReferenceBase(base)
   {
-    const std::string interfaceId(us_service_interface_iid<S>());
-    if (GetInterfaceId() != interfaceId) {
+    const std::string& interfaceId(us_service_interface_iid<S>());
+    if (!this->HasInterfaceId(interfaceId)) {
       if (this->IsConvertibleTo(interfaceId)) {
         this->SetInterfaceId(interfaceId);
       } else {
@@ -235,6 +235,12 @@ private:
 
   void SetInterfaceId(const std::string& interfaceId);
 
+  /**
+   * Same as <code>GetInterfaceId() == interfaceId</code>, but does not
+   * copy the id and compares interned ids by address.
+   */
+  bool HasInterfaceId(const std::string& interfaceId) const;
+
   // This class is not thread-safe, but we support thread-safe
   // copying and assignment.
   std::atomic<ServiceReferenceBasePrivate*> d;
@@ -130,6 +130,34 @@ public:
    */
   void SetProperties(const ServiceProperties& properties);
 
+  /**
+   * Updates some of the properties associated with a service.
+   *
+   * <p>
+   * Unlike SetProperties(), only the keys contained in <code>patch</code>
+   * are changed and all other properties are kept. A key mapped to an
+   * empty Any is removed. Keys are compared case-insensitively, so a
+   * patch key replaces an existing key which differs only in case. The
+   * Constants#OBJECTCLASS, Constants#SERVICE_ID and
+   * Constants#SERVICE_SCOPE keys cannot be modified by this method and
+   * are ignored.
+   *
+   * <p>
+   * A service event of type ServiceEvent#SERVICE_MODIFIED is fired,
+   * unless the patch is empty. Since only listener filters referencing
+   * a changed key need to be evaluated again, this is cheaper than
+   * SetProperties() when a few properties change frequently.
+   *
+   * @param patch The properties to add, change or remove.
+   *
+   * @throws std::logic_error If this <code>ServiceRegistrationBase</code>
+   *         object has already been unregistered or if it is invalid.
+   * @throws std::invalid_argument If <code>patch</code> contains case
+   *         variants of the same key name or a Constants#SERVICE_RANKING
+   *         value which is not an <code>int</code>.
+   */
+  void UpdateProperties(const ServiceProperties& patch);
+
   /**
    * Unregisters a service. Remove a <code>ServiceRegistrationBase</code> object
    * from the framework service registry. All <code>ServiceRegistrationBase</code>
@@ -25,6 +25,7 @@
 
 #include "cppmicroservices/FrameworkExport.h"
 
+#include <cstddef>
 #include <memory>
 #include <streambuf>
 
@@ -34,6 +35,21 @@ namespace detail {
 
 class BundleResourceBufferPrivate;
 
+/// Reads the data of a bundle resource sequentially, uncompressing it
+/// as needed.
+class BundleResourceReader
+{
+public:
+  virtual ~BundleResourceReader() = default;
+
+  /// Reads up to size bytes into buffer. Returns the number of bytes
+  /// read, which is 0 at the end of the data or if it cannot be read.
+  virtual std::size_t Read(char* buffer, std::size_t size) = 0;
+
+  /// Continues reading from the beginning of the data.
+  virtual void Rewind() = 0;
+};
+
 class US_Framework_EXPORT BundleResourceBuffer : public std::streambuf
 {
 
@@ -45,9 +61,31 @@ public:
                                 std::size_t size,
                                 std::ios_base::openmode mode);
 
+  /// Reads from data without copying it. The buffer shares the ownership
+  /// of data.
+  explicit BundleResourceBuffer(std::shared_ptr<const char> data,
+                                std::size_t size,
+                                std::ios_base::openmode mode);
+
+  /// Reads the data from reader, keeping at most windowSize bytes of it in
+  /// memory. Seeking before the buffered data reads from the beginning
+  /// again. In text mode, all of the data is read up front.
+  explicit BundleResourceBuffer(std::unique_ptr<BundleResourceReader> reader,
+                                std::size_t size,
+                                std::size_t windowSize,
+                                std::ios_base::openmode mode);
+
   ~BundleResourceBuffer() override;
 
 private:
+  void Init(std::shared_ptr<const char> data,
+            std::size_t size,
+            std::ios_base::openmode mode);
+
+  int_type StreamUnderflow();
+
+  pos_type StreamSeek(off_type off, std::ios_base::seekdir way);
+
   int_type underflow() override;
 
   int_type uflow() override;
@@ -73,39 +73,38 @@ struct LogMsg
 {
 
   LogMsg(LogSink& sink, const char* file, int ln, const char* func)
-    : enabled(false)
-    , buffer()
+    : buffer()
     , _sink(sink)
   {
-    enabled = _sink.Enabled();
-    if (enabled) {
-      buffer << "In " << func << " at " << file << ":" << ln << " : ";
+    // Only pay for the stream when logging is enabled, DIAG_LOG is used
+    // on hot paths such as ServiceTracker::GetService().
+    if (_sink.Enabled()) {
+      buffer = std::make_unique<std::ostringstream>();
+      *buffer << "In " << func << " at " << file << ":" << ln << " : ";
     }
   }
 
   LogMsg(const LogMsg& other)
-    : enabled(other.enabled)
-    , buffer()
+    : buffer(other.buffer ? std::make_unique<std::ostringstream>() : nullptr)
     , _sink(other._sink)
   {}
 
   ~LogMsg()
   {
-    if (enabled)
-      _sink.Log(buffer.str());
+    if (buffer)
+      _sink.Log(buffer->str());
   }
 
   template<typename T>
   LogMsg& operator<<(T&& t)
   {
-    if (enabled)
-      buffer << std::forward<T>(t);
+    if (buffer)
+      *buffer << std::forward<T>(t);
     return *this;
   }
 
 private:
-  bool enabled;
-  std::ostringstream buffer;
+  std::unique_ptr<std::ostringstream> buffer;
   LogSink& _sink;
 };
 
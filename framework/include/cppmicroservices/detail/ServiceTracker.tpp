@@ -186,7 +186,7 @@ void ServiceTracker<S,T>::Close()
   }
   
   if (d->context.GetLogSink()->Enabled()) {
-    if (!d->cachedReference.Load().GetBundle() &&
+    if (!d->cachedReference.Load() &&
         d->cachedService.Load() == nullptr) {
       DIAG_LOG(*d->context.GetLogSink()) << "ServiceTracker<S,TTT>::close[cached cleared]:"
                     << d->filter;
@@ -270,12 +270,12 @@ template<class S, class T>
 ServiceReference<S>
 ServiceTracker<S,T>::GetServiceReference() const
 {
-  ServiceReference<S> reference = d->cachedReference.Load();
-  if (reference.GetBundle())
+  auto reference = d->cachedReference.Load();
+  if (reference && reference->GetBundle())
   {
     DIAG_LOG(*d->context.GetLogSink()) << "ServiceTracker<S,TTT>::getServiceReference[cached]:"
                   << d->filter;
-    return reference;
+    return *reference;
   }
   DIAG_LOG(*d->context.GetLogSink()) << "ServiceTracker<S,TTT>::getServiceReference:" << d->filter;
   auto references = GetServiceReferences();
@@ -341,7 +341,8 @@ ServiceTracker<S,T>::GetServiceReference() const
     }
   }
 
-  d->cachedReference.Store(*selectedRef);
+  d->cachedReference.Store(
+    std::make_shared<const ServiceReference<S>>(*selectedRef));
   return *selectedRef;
 }
 
@@ -149,7 +149,7 @@ public:
   /**
    * Cached ServiceReference for getServiceReference.
    */
-  mutable Atomic<ServiceReference<S>> cachedReference;
+  mutable Atomic<std::shared_ptr<const ServiceReference<S>>> cachedReference;
 
   /**
    * Cached service object for GetService.
@@ -153,7 +153,7 @@ std::shared_ptr<detail::TrackedService<S,TTT>> ServiceTrackerPrivate<S,TTT>::Tra
 template<class S, class TTT>
 void ServiceTrackerPrivate<S,TTT>::Modified()
 {
-  cachedReference.Store(ServiceReference<S>()); /* clear cached value */
+  cachedReference.Store(std::shared_ptr<const ServiceReference<S>>()); /* clear cached value */
   cachedService.Store(std::shared_ptr<TrackedParamType>()); /* clear cached value */
   DIAG_LOG(*context.GetLogSink()) << "ServiceTracker::Modified(): " << filter;
 }
@@ -26,6 +26,7 @@
 #include "cppmicroservices/FrameworkConfig.h"
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 
@@ -196,7 +197,175 @@ public:
   }
 };
 
-#if !defined(__GNUC__) || __GNUC__ > 4
+#if defined(__x86_64__) || defined(_M_X64)
+// Specialize cppmicroservices::Atomic for std::shared_ptr with a lock-free
+// split reference count. The standard library atomic functions for
+// std::shared_ptr serialize on a global pool of mutexes.
+//
+// The stored value lives in a heap allocated Node. The 64 bit word m_t packs
+// the Node address into its lower 48 bits, which is sufficient for user space
+// addresses on x86-64, and the number of in-flight Load() calls into its upper
+// 16 bits. A reader increments that local count to keep the Node alive while
+// it copies the value. Replacing the Node transfers the local count of the old
+// word to the Node's own reference count, so readers that lost the race release
+// their reference on the Node instead of on the word.
+template<class T>
+class Atomic<std::shared_ptr<T>>
+{
+  static constexpr unsigned CountShift = 48;
+  static constexpr std::uint64_t CountOne = std::uint64_t(1) << CountShift;
+  static constexpr std::uint64_t NodeMask = CountOne - 1;
+
+  // Larger than any local count, keeps Node::refs positive until the Node is
+  // replaced and the local count has been transferred.
+  static constexpr std::int64_t Bias = std::int64_t(1) << 32;
+
+  struct Node
+  {
+    explicit Node(const std::shared_ptr<T>& t)
+      : refs(Bias)
+      , value(t)
+    {}
+
+    std::atomic<std::int64_t> refs;
+    const std::shared_ptr<T> value;
+  };
+
+  mutable std::atomic<std::uint64_t> m_t;
+
+  static Node* MakeNode(const std::shared_ptr<T>& t)
+  {
+    return t ? new Node(t) : nullptr;
+  }
+
+  static std::uint64_t ToWord(Node* node)
+  {
+    return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(node));
+  }
+
+  static Node* ToNode(std::uint64_t word)
+  {
+    return reinterpret_cast<Node*>(static_cast<std::uintptr_t>(word & NodeMask));
+  }
+
+  static void Unref(Node* node, std::int64_t count)
+  {
+    if (node->refs.fetch_sub(count, std::memory_order_acq_rel) == count) {
+      delete node;
+    }
+  }
+
+  // Drops the reference of a replaced word on its Node, crediting the
+  // Node with the local count of in-flight readers
+  static void Retire(std::uint64_t word)
+  {
+    if (Node* node = ToNode(word)) {
+      Unref(node, Bias - static_cast<std::int64_t>(word >> CountShift));
+    }
+  }
+
+  // Takes a local reference on the current Node, returns the updated word
+  std::uint64_t Acquire() const
+  {
+    return m_t.fetch_add(CountOne, std::memory_order_acquire) + CountOne;
+  }
+
+  // Gives back a local reference taken by Acquire()
+  void Release(std::uint64_t word) const
+  {
+    Node* node = ToNode(word);
+    while (ToNode(word) == node) {
+      if (m_t.compare_exchange_weak(word,
+                                    word - CountOne,
+                                    std::memory_order_release,
+                                    std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    // The Node has been replaced and our local reference transferred to it
+    if (node) {
+      Unref(node, 1);
+    }
+  }
+
+  static std::shared_ptr<T> Value(Node* node)
+  {
+    return node ? node->value : std::shared_ptr<T>();
+  }
+
+public:
+  Atomic()
+    : m_t(0)
+  {}
+
+  explicit Atomic(const std::shared_ptr<T>& t)
+    : m_t(ToWord(MakeNode(t)))
+  {}
+
+  Atomic(const Atomic&) = delete;
+  Atomic& operator=(const Atomic&) = delete;
+
+  ~Atomic() { Retire(m_t.load(std::memory_order_acquire)); }
+
+  std::shared_ptr<T> Load() const
+  {
+    if (ToNode(m_t.load(std::memory_order_relaxed)) == nullptr) {
+      return std::shared_ptr<T>();
+    }
+    std::uint64_t word = Acquire();
+    std::shared_ptr<T> t = Value(ToNode(word));
+    Release(word);
+    return t;
+  }
+
+  void Store(const std::shared_ptr<T>& t)
+  {
+    Retire(m_t.exchange(ToWord(MakeNode(t)), std::memory_order_acq_rel));
+  }
+
+  std::shared_ptr<T> Exchange(const std::shared_ptr<T>& t)
+  {
+    std::uint64_t word =
+      m_t.exchange(ToWord(MakeNode(t)), std::memory_order_acq_rel);
+    // The reference of the word keeps the Node alive until it is retired
+    std::shared_ptr<T> o = Value(ToNode(word));
+    Retire(word);
+    return o;
+  }
+
+  bool CompareExchange(std::shared_ptr<T>& expected,
+                       const std::shared_ptr<T>& desired)
+  {
+    Node* desiredNode = MakeNode(desired);
+    std::uint64_t word = Acquire();
+    for (;;) {
+      Node* node = ToNode(word);
+      std::shared_ptr<T> current = Value(node);
+      if (current != expected || current.owner_before(expected) ||
+          expected.owner_before(current)) {
+        expected = std::move(current);
+        Release(word);
+        delete desiredNode;
+        return false;
+      }
+      if (m_t.compare_exchange_strong(word,
+                                      ToWord(desiredNode),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+        // Our own local reference is not transferred to the Node
+        Retire(word - CountOne);
+        return true;
+      }
+      if (ToNode(word) != node) {
+        if (node) {
+          Unref(node, 1);
+        }
+        word = Acquire();
+      }
+    }
+  }
+};
+#elif !defined(__GNUC__) || __GNUC__ > 4
 // The std::atomic_load() et.al. overloads for std::shared_ptr are only available
 // in libstdc++ since GCC 5.0. Visual Studio 2013 has it, but the Clang version
 // is unknown so far.
@@ -197,6 +197,21 @@ ServiceRegistrationU BundleContext::RegisterService(
   return b->coreCtx->services.RegisterService(b.get(), service, properties);
 }
 
+std::vector<ServiceRegistrationU> BundleContext::RegisterServices(
+  const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+    services)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  auto regs = b->coreCtx->services.RegisterServices(b.get(), services);
+  return std::vector<ServiceRegistrationU>(regs.begin(), regs.end());
+}
+
 std::vector<ServiceReferenceU> BundleContext::GetServiceReferences(
   const std::string& clazz,
   const std::string& filter)
@@ -348,6 +363,19 @@ ListenerToken BundleContext::AddBundleListener(const BundleListener& delegate)
   return b->coreCtx->listeners.AddBundleListener(d, delegate, nullptr);
 }
 
+ListenerToken BundleContext::AddBundleEventsListener(
+  const BundleEventsListener& delegate)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  return b->coreCtx->listeners.AddBundleEventsListener(d, delegate);
+}
+
 void BundleContext::RemoveBundleListener(const BundleListener& delegate)
 {
   if (!d) {
@@ -484,4 +512,17 @@ std::vector<Bundle> BundleContext::InstallBundles(
   return b->coreCtx->bundleRegistry.Install(location, b.get(), bundleManifest);
 }
 
+std::vector<Bundle> BundleContext::InstallBundles(
+  const std::vector<std::string>& locations)
+{
+  if (!d) {
+    throw std::runtime_error("The bundle context is no longer valid");
+  }
+
+  d->CheckValid();
+  auto b = GetAndCheckBundlePrivate(d);
+
+  return b->coreCtx->bundleRegistry.Install(locations, b.get());
+}
+
 }
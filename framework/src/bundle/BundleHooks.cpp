@@ -92,21 +92,20 @@ void BundleHooks::FilterBundles(const BundleContext& context,
 
 void BundleHooks::FilterBundleEventReceivers(
   const BundleEvent& evt,
-  ServiceListeners::BundleListenerMap& bundleListeners)
+  std::shared_ptr<const ServiceListeners::BundleListenerMap>& bundleListeners,
+  std::shared_ptr<const ServiceListeners::BundleEventsListenerMap>&
+    eventsListeners)
 {
   std::vector<ServiceRegistrationBase> eventHooks;
   coreCtx->services.Get(us_service_interface_iid<BundleEventHook>(),
                         eventHooks);
 
-  {
-    auto l = coreCtx->listeners.bundleListenerMap.Lock();
-    US_UNUSED(l);
-    bundleListeners = coreCtx->listeners.bundleListenerMap.value;
-  }
-
   if (!eventHooks.empty()) {
     std::vector<BundleContext> bundleContexts;
-    for (auto& le : bundleListeners) {
+    for (auto& le : *bundleListeners) {
+      bundleContexts.push_back(MakeBundleContext(le.first->shared_from_this()));
+    }
+    for (auto& le : *eventsListeners) {
       bundleContexts.push_back(MakeBundleContext(le.first->shared_from_this()));
     }
     std::sort(bundleContexts.begin(), bundleContexts.end());
@@ -153,17 +152,38 @@ void BundleHooks::FilterBundleEventReceivers(
     }
 
     if (unfilteredSize != bundleContexts.size()) {
-      for (auto le = bundleListeners.begin(); le != bundleListeners.end();) {
-        if (std::find_if(bundleContexts.begin(),
-                         bundleContexts.end(),
-                         [&le](const BundleContext& bc) {
-                           return GetPrivate(bc) == le->first;
-                         }) == bundleContexts.end()) {
-          bundleListeners.erase(le++);
+      auto isFiltered = [&bundleContexts](const auto& le) {
+        return std::find_if(bundleContexts.begin(),
+                            bundleContexts.end(),
+                            [&le](const BundleContext& bc) {
+                              return GetPrivate(bc) == le.first;
+                            }) == bundleContexts.end();
+      };
+      auto filteredListeners =
+        std::make_shared<ServiceListeners::BundleListenerMap>(
+          *bundleListeners);
+      for (auto le = filteredListeners->begin();
+           le != filteredListeners->end();) {
+        if (isFiltered(*le)) {
+          filteredListeners->erase(le++);
+        } else {
+          ++le;
+        }
+      }
+      bundleListeners = std::move(filteredListeners);
+
+      auto filteredEventsListeners =
+        std::make_shared<ServiceListeners::BundleEventsListenerMap>(
+          *eventsListeners);
+      for (auto le = filteredEventsListeners->begin();
+           le != filteredEventsListeners->end();) {
+        if (isFiltered(*le)) {
+          filteredEventsListeners->erase(le++);
         } else {
           ++le;
         }
       }
+      eventsListeners = std::move(filteredEventsListeners);
     }
   }
 }
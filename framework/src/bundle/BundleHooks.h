@@ -49,9 +49,17 @@ public:
   void FilterBundles(const BundleContext& context,
                      std::vector<Bundle>& bundles) const;
 
+  /**
+   * Lets the bundle event hooks filter the bundle contexts receiving the
+   * event. If a hook removes bundle contexts, the listener maps are
+   * replaced by copies without the listeners of those bundle contexts.
+   */
   void FilterBundleEventReceivers(
     const BundleEvent& evt,
-    ServiceListeners::BundleListenerMap& bundleListeners);
+    std::shared_ptr<const ServiceListeners::BundleListenerMap>&
+      bundleListeners,
+    std::shared_ptr<const ServiceListeners::BundleEventsListenerMap>&
+      eventsListeners);
 };
 }
 
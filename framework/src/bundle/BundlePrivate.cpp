@@ -443,6 +443,8 @@ std::exception_ptr BundlePrivate::Start0()
     }
 
     try {
+      using Milliseconds = std::chrono::duration<double, std::milli>;
+      Milliseconds loadTime(0);
       void* libHandle = nullptr;
       if ((lib.GetFilePath() == util::GetExecutablePath())) {
         libHandle = BundleUtils::GetExecutableHandle();
@@ -452,7 +454,9 @@ std::exception_ptr BundlePrivate::Start0()
                                "Loading shared library for Bundle #" +
                                  util::ToString(id) + " (location=" + location +
                                  ")");
+          const auto loadStart = std::chrono::steady_clock::now();
           lib.Load(coreCtx->libraryLoadOptions);
+          loadTime = std::chrono::steady_clock::now() - loadStart;
           coreCtx->logger->Log(logservice::SeverityLevel::LOG_INFO,
                                "Finished loading shared library for Bundle #" +
                                  util::ToString(id) + " (location=" + location +
@@ -500,7 +504,17 @@ std::exception_ptr BundlePrivate::Start0()
       // get a BundleActivator instance
       bactivator = std::unique_ptr<BundleActivator, DestroyActivatorHook>(
         createActivatorHook(), destroyActivatorHook);
+      const auto activationStart = std::chrono::steady_clock::now();
       bactivator->Start(MakeBundleContext(ctx));
+      Milliseconds activationTime =
+        std::chrono::steady_clock::now() - activationStart;
+      coreCtx->logger->Log(logservice::SeverityLevel::LOG_DEBUG,
+                           "Started Bundle #" + util::ToString(id) +
+                             " (location=" + location +
+                             "): loading the shared library took " +
+                             util::ToString(loadTime.count()) +
+                             " ms, the activator took " +
+                             util::ToString(activationTime.count()) + " ms");
     } catch (const std::system_error& ex) {
       // SharedLibrary::Load(int flags) will throw a std::system_error when a shared library
       //fails to load. Creating a SharedLibraryException here to throw.
@@ -638,6 +652,7 @@ BundlePrivate::BundlePrivate(CoreBundleContext* coreCtx,
             ba->GetResourcePrefix() + " at " + location +
             " failed: " + util::GetLastExceptionStr());
         }
+        coreCtx->storage->SetParsedManifest(*ba, bundleManifest.GetHeaders());
         // It is unlikely that clients will access bundle resources
         // if the only resource is the manifest file. On this assumption,
         // close the open file handle to the zip file to improve performance
@@ -25,23 +25,33 @@
 #include "cppmicroservices/Bundle.h"
 #include "cppmicroservices/BundleActivator.h"
 #include "cppmicroservices/BundleEvent.h"
+#include "cppmicroservices/BundleResource.h"
+#include "cppmicroservices/BundleResourceStream.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/GetBundleContext.h"
 
 #include "cppmicroservices/util/Error.h"
 #include "cppmicroservices/util/String.h"
 
+#include "BundleArchive.h"
 #include "BundleContextPrivate.h"
+#include "BundleManifest.h"
 #include "BundlePrivate.h"
 #include "BundleResourceContainer.h"
 #include "BundleStorage.h"
 #include "CoreBundleContext.h"
 #include "FrameworkPrivate.h"
+#include "SerialExecutor.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <map>
+#include <thread>
+#include <unordered_map>
 
 namespace {
 
@@ -58,6 +68,63 @@ private:
   std::function<void()> _cleanupFcn;
 };
 
+// The result of opening a bundle library and parsing the manifests of all
+// bundles in it, ahead of adding the bundles to the registry.
+struct PreparedInstall
+{
+  PreparedInstall()
+    : manifests(
+        cppmicroservices::any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS)
+  {}
+
+  std::shared_ptr<cppmicroservices::BundleResourceContainer> resCont;
+  cppmicroservices::AnyMap manifests;
+  std::exception_ptr error;
+};
+
+// Does the part of installing the bundle library at location which does
+// not touch the registry. This is safe to call concurrently for different
+// locations.
+void PrepareInstall(const std::string& location, PreparedInstall& prepared)
+{
+  using namespace cppmicroservices;
+
+  try {
+    prepared.resCont = std::make_shared<BundleResourceContainer>(
+      location, AnyMap(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
+    for (auto const& symbolicName : prepared.resCont->GetTopLevelDirs()) {
+      // An archive which is not known to the bundle storage, only used to
+      // read the manifest resource of the bundle.
+      auto ba = std::make_shared<BundleArchive>(
+        nullptr,
+        prepared.resCont,
+        symbolicName,
+        location,
+        0,
+        AnyMap(any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
+      auto manifestRes = ba->GetResource("/manifest.json");
+      if (!manifestRes) {
+        continue;
+      }
+      BundleResourceStream manifestStream(manifestRes);
+      BundleManifest manifest;
+      try {
+        manifest.Parse(manifestStream);
+      } catch (...) {
+        throw std::runtime_error(
+          std::string("Parsing of manifest.json for bundle ") + symbolicName +
+          " at " + location + " failed: " + util::GetLastExceptionStr());
+      }
+      prepared.manifests.emplace(symbolicName, manifest.GetHeaders());
+    }
+    if (OnlyContainsManifest(prepared.resCont)) {
+      prepared.resCont->CloseContainer();
+    }
+  } catch (...) {
+    prepared.error = std::current_exception();
+  }
+}
+
 }
 
 namespace cppmicroservices {
@@ -70,8 +137,7 @@ BundleRegistry::~BundleRegistry() = default;
 
 void BundleRegistry::Init()
 {
-  bundles.v.insert(
-    std::make_pair(coreCtx->systemBundle->location, coreCtx->systemBundle));
+  AddBundle_unlocked(coreCtx->systemBundle->location, coreCtx->systemBundle);
 }
 
 void BundleRegistry::Clear()
@@ -79,6 +145,8 @@ void BundleRegistry::Clear()
   auto l = bundles.Lock();
   US_UNUSED(l);
   bundles.v.clear();
+  bundles.byId.clear();
+  bundles.bySymbolicName.clear();
 }
 
 /*
@@ -98,6 +166,27 @@ void BundleRegistry::DecrementInitialBundleMapRef(
   l.UnLock();
 }
 
+/*
+  This function notifies all threads waiting for the first install of the
+  bundle at the specified location that it is done, and releases the
+  installing thread's reference to the initialBundleInstallMap entry.
+*/
+void BundleRegistry::NotifyInitialBundleInstalled(
+  cppmicroservices::detail::MutexLockingStrategy<>::UniqueLock& l,
+  const std::string& location)
+{
+  {
+    l.Lock();
+    auto& p = initialBundleInstallMap[location];
+    // Notify all waiting threads that it is safe to install the bundle
+    std::lock_guard<std::mutex> lock(*(p.second.m));
+    p.second.waitFlag = false;
+    p.second.cv->notify_all();
+    l.UnLock();
+  }
+  DecrementInitialBundleMapRef(l, location);
+}
+
 /*
   This function populates the res and alreadyInstalled vectors with the
   appropriate entries so that they can be used by the Install0 call. This was
@@ -224,16 +313,7 @@ std::vector<Bundle> BundleRegistry::Install(
       {
         // create instance of clean-up object to ensure RAII
         InitialBundleMapCleanup cleanup([this, &l, &location]() {
-          {
-            l.Lock();
-            auto& p = initialBundleInstallMap[location];
-            // Notify all waiting threads that it is safe to install the bundle
-            std::lock_guard<std::mutex> lock(*(p.second.m));
-            p.second.waitFlag = false;
-            p.second.cv->notify_all();
-            l.UnLock();
-          }
-          DecrementInitialBundleMapRef(l, location);
+          NotifyInitialBundleInstalled(l, location);
         });
 
         // Perform the install
@@ -299,6 +379,125 @@ std::vector<Bundle> BundleRegistry::Install(
   }
 }
 
+std::vector<Bundle> BundleRegistry::Install(
+  const std::vector<std::string>& locations,
+  BundlePrivate* caller)
+{
+  CheckIllegalState();
+
+  // deliver the BUNDLE_INSTALLED events of all locations in one batch
+  ServiceListeners::BundleEventBatch eventBatch(coreCtx->listeners);
+
+  std::vector<std::string> uniqueLocations;
+  {
+    std::unordered_set<std::string> seen;
+    for (auto const& location : locations) {
+      if (seen.insert(location).second) {
+        uniqueLocations.push_back(location);
+      }
+    }
+  }
+
+  /*
+    Claim the first install of every location which is neither installed
+    nor being installed by another thread, the same way Install() does for
+    a single location. Threads installing a claimed location wait until it
+    has been added to the registry.
+
+    Locations which are being installed by another thread are deferred
+    until all claims of this thread have been released, so that two threads
+    installing overlapping sets of locations cannot wait for each other.
+  */
+  std::vector<std::string> claimed;
+  std::unordered_map<std::string, std::size_t> claimedIndex;
+  std::vector<std::string> deferred;
+  auto l = this->Lock();
+  for (auto const& location : uniqueLocations) {
+    if ((bundles.Lock(), bundles.v.count(location)) != 0) {
+      continue;
+    }
+    if (initialBundleInstallMap.count(location) != 0) {
+      deferred.push_back(location);
+      continue;
+    }
+    initialBundleInstallMap.insert(
+      std::make_pair(location, std::make_pair(uint32_t(1), WaitCondition{})));
+    claimedIndex.emplace(location, claimed.size());
+    claimed.push_back(location);
+  }
+  l.UnLock();
+
+  std::vector<bool> released(claimed.size(), false);
+  auto release = [this, &l, &claimed, &released](std::size_t i) {
+    if (!released[i]) {
+      released[i] = true;
+      NotifyInitialBundleInstalled(l, claimed[i]);
+    }
+  };
+
+  std::vector<Bundle> installedBundles;
+  {
+    // create instance of clean-up object to ensure RAII
+    InitialBundleMapCleanup cleanup([&claimed, &release]() {
+      for (std::size_t i = 0; i < claimed.size(); ++i) {
+        release(i);
+      }
+    });
+
+    // Open the bundle libraries and parse their manifests concurrently
+    std::vector<PreparedInstall> prepared(claimed.size());
+    std::atomic<std::size_t> next(0);
+    auto prepare = [&claimed, &prepared, &next]() {
+      for (auto i = next++; i < claimed.size(); i = next++) {
+        PrepareInstall(claimed[i], prepared[i]);
+      }
+    };
+
+    // the calling thread is one of the workers
+    auto numWorkers = std::min<std::size_t>(
+      std::max(1u, std::thread::hardware_concurrency()), claimed.size());
+    auto workers = StartThreads(numWorkers > 1 ? numWorkers - 1 : 0, prepare);
+    prepare();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    // Add the bundles to the registry in the order of the locations
+    for (auto const& location : uniqueLocations) {
+      std::vector<Bundle> newBundles;
+      auto iter = claimedIndex.find(location);
+      if (iter == claimedIndex.end()) {
+        if (std::find(deferred.begin(), deferred.end(), location) ==
+            deferred.end()) {
+          newBundles = Install(location, caller);
+        }
+      } else {
+        auto& p = prepared[iter->second];
+        if (p.error) {
+          try {
+            std::rethrow_exception(p.error);
+          } catch (...) {
+            throw std::runtime_error("Failed to install bundle library at " +
+                                     location + ": " +
+                                     util::GetLastExceptionStr());
+          }
+        }
+        newBundles = Install0(location, p.resCont, {}, p.manifests);
+        release(iter->second);
+      }
+      installedBundles.insert(
+        installedBundles.end(), newBundles.begin(), newBundles.end());
+    }
+  }
+
+  for (auto const& location : deferred) {
+    auto newBundles = Install(location, caller);
+    installedBundles.insert(
+      installedBundles.end(), newBundles.begin(), newBundles.end());
+  }
+  return installedBundles;
+}
+
 std::vector<Bundle> BundleRegistry::Install0(
   const std::string& location,
   const std::shared_ptr<BundleResourceContainer>& resCont,
@@ -360,11 +559,12 @@ std::vector<Bundle> BundleRegistry::Install0(
       auto l = bundles.Lock();
       US_UNUSED(l);
       for (auto& b : installedBundles) {
-        bundles.v.insert(std::make_pair(location, b.d));
+        AddBundle_unlocked(location, b.d);
       }
     }
 
     // Now fire off the bundle event listeners.
+    ServiceListeners::BundleEventBatch eventBatch(coreCtx->listeners);
     for (auto& b : installedBundles) {
       coreCtx->listeners.BundleChanged(
         BundleEvent(BundleEvent::BUNDLE_INSTALLED, b));
@@ -388,7 +588,7 @@ void BundleRegistry::Remove(const std::string& location, long id)
   auto range = bundles.v.equal_range(location);
   for (auto iter = range.first; iter != range.second; ++iter) {
     if (iter->second->id == id) {
-      bundles.v.erase(iter);
+      RemoveBundle_unlocked(iter);
       return;
     }
   }
@@ -401,12 +601,8 @@ std::shared_ptr<BundlePrivate> BundleRegistry::GetBundle(long id) const
   auto l = bundles.Lock();
   US_UNUSED(l);
 
-  for (auto& m : bundles.v) {
-    if (m.second->id == id) {
-      return m.second;
-    }
-  }
-  return nullptr;
+  auto iter = bundles.byId.find(id);
+  return iter != bundles.byId.end() ? iter->second : nullptr;
 }
 
 std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles(
@@ -437,10 +633,10 @@ std::vector<std::shared_ptr<BundlePrivate>> BundleRegistry::GetBundles(
   auto l = bundles.Lock();
   US_UNUSED(l);
 
-  for (auto& p : bundles.v) {
-    auto& b = p.second;
-    if (name == b->symbolicName && version == b->version) {
-      res.push_back(b);
+  auto range = bundles.bySymbolicName.equal_range(name);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (version == iter->second->version) {
+      res.push_back(iter->second);
     }
   }
 
@@ -485,9 +681,10 @@ void BundleRegistry::Load()
   for (auto const& ba : bas) {
     try {
       auto impl = std::make_shared<BundlePrivate>(coreCtx, ba);
-      bundles.v.insert(std::make_pair(impl->location, impl));
+      AddBundle_unlocked(impl->location, impl);
     } catch (...) {
       ba->SetAutostartSetting(-1); // Do not start on launch
+      ba->Purge();
       std::cerr << "Failed to load bundle " << util::ToString(ba->GetBundleId())
                 << " (" + ba->GetBundleLocation() + ") uninstalled it!"
                 << " (exception: "
@@ -497,6 +694,29 @@ void BundleRegistry::Load()
   }
 }
 
+void BundleRegistry::AddBundle_unlocked(
+  const std::string& location,
+  const std::shared_ptr<BundlePrivate>& bundle)
+{
+  bundles.v.insert(std::make_pair(location, bundle));
+  bundles.byId.insert(std::make_pair(bundle->id, bundle));
+  bundles.bySymbolicName.insert(std::make_pair(bundle->symbolicName, bundle));
+}
+
+void BundleRegistry::RemoveBundle_unlocked(BundleMap::iterator iter)
+{
+  auto bundle = iter->second;
+  bundles.v.erase(iter);
+  bundles.byId.erase(bundle->id);
+  auto range = bundles.bySymbolicName.equal_range(bundle->symbolicName);
+  for (auto nameIter = range.first; nameIter != range.second; ++nameIter) {
+    if (nameIter->second == bundle) {
+      bundles.bySymbolicName.erase(nameIter);
+      break;
+    }
+  }
+}
+
 void BundleRegistry::CheckIllegalState() const
 {
   if (coreCtx == nullptr) {
@@ -30,6 +30,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "BundleResourceContainer.h"
@@ -71,6 +72,23 @@ public:
     const cppmicroservices::AnyMap& bundleManifest = cppmicroservices::AnyMap(
       cppmicroservices::any_map::UNORDERED_MAP_CASEINSENSITIVE_KEYS));
 
+  /**
+   * Install several bundle libraries.
+   *
+   * The bundle libraries which are not installed yet are opened and their
+   * manifests parsed on a pool of worker threads. The bundles are then
+   * added to the registry in the order of the given locations, so they
+   * get the same bundle ids as if they were installed one after the other.
+   * Locations which another thread is installing at the same time are
+   * installed last.
+   *
+   * @param locations The locations to be installed
+   * @param caller The bundle performing the install
+   * @return A vector of bundles installed, in the order of the locations
+   */
+  std::vector<Bundle> Install(const std::vector<std::string>& locations,
+                              BundlePrivate* caller);
+
   /**
    * Remove bundle registration.
    *
@@ -146,6 +164,13 @@ private:
 
   void CheckIllegalState() const;
 
+  /// Adds a bundle to the table of installed bundles and its indexes.
+  void AddBundle_unlocked(const std::string& location,
+                          const std::shared_ptr<BundlePrivate>& bundle);
+
+  /// Removes a bundle from the table of installed bundles and its indexes.
+  void RemoveBundle_unlocked(BundleMap::iterator iter);
+
   /** This function populates the res and alreadyInstalled vectors with the appropriate entries so
    * that they can be used by the Install0 call. This was extracted from Install() for convenience.
    *
@@ -168,6 +193,10 @@ private:
     cppmicroservices::detail::MutexLockingStrategy<>::UniqueLock& l,
     const std::string& location);
 
+  void NotifyInitialBundleInstalled(
+    cppmicroservices::detail::MutexLockingStrategy<>::UniqueLock& l,
+    const std::string& location);
+
   /*
     A struct which contains the necessary objects to utilize condition
     variables. A thread will wait on this WaitCondition if the waitFlag
@@ -193,11 +222,15 @@ private:
 
   /**
    * Table of all installed bundles in this framework.
-   * Key is the bundle location.
+   * Key is the bundle location. The installed bundles are also indexed
+   * by bundle id and by symbolic name.
    */
   struct : MultiThreaded<>
   {
     BundleMap v;
+    std::unordered_map<long, std::shared_ptr<BundlePrivate>> byId;
+    std::unordered_multimap<std::string, std::shared_ptr<BundlePrivate>>
+      bySymbolicName;
   } bundles;
 };
 }
@@ -23,6 +23,7 @@
 #include "cppmicroservices/BundleResource.h"
 
 #include "cppmicroservices/GetBundleContext.h"
+#include "cppmicroservices/detail/BundleResourceBuffer.h"
 #include "cppmicroservices/detail/Log.h"
 
 #include "BundleArchive.h"
@@ -283,6 +284,42 @@ std::unique_ptr<void, void (*)(void*)> BundleResource::GetData() const
   return data;
 }
 
+std::shared_ptr<const char> BundleResource::GetDataView() const
+{
+  if (!IsValid()) {
+    return nullptr;
+  }
+
+  auto data = d->archive->GetResourceContainer()->GetDataView(d->stat.index);
+  if (!data) {
+    auto sink = GetBundleContext().GetLogSink();
+    DIAG_LOG(*sink) << "Error uncompressing resource data for "
+                    << this->GetResourcePath() << " from "
+                    << d->archive->GetBundleLocation();
+  }
+
+  return data;
+}
+
+std::unique_ptr<detail::BundleResourceReader> BundleResource::GetDataReader()
+  const
+{
+  if (!IsValid()) {
+    return nullptr;
+  }
+
+  auto reader =
+    d->archive->GetResourceContainer()->GetDataReader(d->stat.index);
+  if (!reader) {
+    auto sink = GetBundleContext().GetLogSink();
+    DIAG_LOG(*sink) << "Error reading resource data for "
+                    << this->GetResourcePath() << " from "
+                    << d->archive->GetBundleLocation();
+  }
+
+  return reader;
+}
+
 std::ostream& operator<<(std::ostream& os, const BundleResource& resource)
 {
   return os << resource.GetResourcePath();
@@ -22,6 +22,7 @@
 
 #include "cppmicroservices/detail/BundleResourceBuffer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -43,7 +44,7 @@ namespace detail {
 class BundleResourceBufferPrivate
 {
 public:
-  BundleResourceBufferPrivate(std::unique_ptr<void, void (*)(void*)> data,
+  BundleResourceBufferPrivate(std::shared_ptr<const char> data,
                               std::size_t size,
                               const char* begin,
                               std::ios_base::openmode mode)
@@ -51,8 +52,30 @@ public:
     , end(begin + size)
     , current(begin)
     , mode(mode)
-    , uncompressedData(reinterpret_cast<unsigned char*>(data.release()),
-                       data.get_deleter())
+    , data(std::move(data))
+    , size(size)
+    , windowSize(0)
+    , windowStart(0)
+    , decoded(0)
+#ifdef DATA_NEEDS_NEWLINE_CONVERSION
+    , pos(0)
+#endif
+  {}
+
+  BundleResourceBufferPrivate(std::unique_ptr<BundleResourceReader> reader,
+                              std::size_t size,
+                              std::size_t windowSize,
+                              std::ios_base::openmode mode)
+    : begin(nullptr)
+    , end(nullptr)
+    , current(nullptr)
+    , mode(mode)
+    , reader(std::move(reader))
+    , window(new char[windowSize])
+    , size(size)
+    , windowSize(windowSize)
+    , windowStart(0)
+    , decoded(0)
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
     , pos(0)
 #endif
@@ -64,7 +87,20 @@ public:
 
   const std::ios_base::openmode mode;
 
-  std::unique_ptr<unsigned char, void (*)(void*)> uncompressedData;
+  // either a heap copy of the uncompressed data, or the stored data of
+  // an in-memory archive
+  std::shared_ptr<const char> data;
+
+  // If set, the data is read incrementally into the get area, which is
+  // the window buffer. begin, end and current are not used.
+  std::unique_ptr<BundleResourceReader> reader;
+  std::unique_ptr<char[]> window;
+  const std::size_t size;
+  const std::size_t windowSize;
+  // the position of eback() in the data
+  std::size_t windowStart;
+  // the number of bytes read from reader
+  std::size_t decoded;
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   // records the stream position ignoring CR characters
@@ -74,14 +110,66 @@ public:
 
 BundleResourceBuffer::BundleResourceBuffer(
   std::unique_ptr<void, void (*)(void*)> data,
-  std::size_t _size,
+  std::size_t size,
   std::ios_base::openmode mode)
+  : BundleResourceBuffer(
+      std::shared_ptr<const char>(
+        static_cast<const char*>(data.release()),
+        [deleter = data.get_deleter()](const char* p) {
+          deleter(const_cast<char*>(p));
+        }),
+      size,
+      mode)
+{}
+
+BundleResourceBuffer::BundleResourceBuffer(std::shared_ptr<const char> data,
+                                           std::size_t size,
+                                           std::ios_base::openmode mode)
   : d(nullptr)
+{
+  Init(std::move(data), size, mode);
+}
+
+BundleResourceBuffer::BundleResourceBuffer(
+  std::unique_ptr<BundleResourceReader> reader,
+  std::size_t size,
+  std::size_t windowSize,
+  std::ios_base::openmode mode)
+  : d(nullptr)
+{
+  if (reader && !(mode & std::ios_base::binary)) {
+    // The end-of-line translations need random access to the data
+    std::shared_ptr<char> data(new char[size],
+                               std::default_delete<char[]>());
+    std::size_t read = 0;
+    while (read < size) {
+      auto n = reader->Read(data.get() + read, size - read);
+      if (n == 0) {
+        break;
+      }
+      read += n;
+    }
+    Init(read == size ? std::move(data) : nullptr, size, mode);
+    return;
+  }
+  if (!reader) {
+    Init(nullptr, size, mode);
+    return;
+  }
+
+  d = std::make_unique<BundleResourceBufferPrivate>(
+    std::move(reader), size, windowSize > 0 ? windowSize : 1, mode);
+  setg(d->window.get(), d->window.get(), d->window.get());
+}
+
+void BundleResourceBuffer::Init(std::shared_ptr<const char> data,
+                                std::size_t _size,
+                                std::ios_base::openmode mode)
 {
   assert(_size <
          static_cast<std::size_t>(std::numeric_limits<uint32_t>::max()));
 
-  auto* begin = reinterpret_cast<char*>(data.get());
+  const char* begin = data.get();
   std::size_t size = begin ? _size : 0;
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
@@ -92,7 +180,7 @@ BundleResourceBuffer::BundleResourceBuffer(
 #endif
 
 #ifdef REMOVE_LAST_NEWLINE_IN_TEXT_MODE
-  if (begin != nullptr && !(mode & std::ios_base::binary) &&
+  if (begin != nullptr && size > 0 && !(mode & std::ios_base::binary) &&
       begin[size - 1] == '\n') {
     --size;
   }
@@ -106,6 +194,10 @@ BundleResourceBuffer::~BundleResourceBuffer() = default;
 
 BundleResourceBuffer::int_type BundleResourceBuffer::underflow()
 {
+  if (d->reader) {
+    return StreamUnderflow();
+  }
+
   if (d->current == d->end)
     return traits_type::eof();
 
@@ -127,6 +219,14 @@ BundleResourceBuffer::int_type BundleResourceBuffer::underflow()
 
 BundleResourceBuffer::int_type BundleResourceBuffer::uflow()
 {
+  if (d->reader) {
+    auto c = StreamUnderflow();
+    if (c != traits_type::eof()) {
+      gbump(1);
+    }
+    return c;
+  }
+
   if (d->current == d->end)
     return traits_type::eof();
 
@@ -148,6 +248,11 @@ BundleResourceBuffer::int_type BundleResourceBuffer::uflow()
 
 BundleResourceBuffer::int_type BundleResourceBuffer::pbackfail(int_type ch)
 {
+  if (d->reader) {
+    // only the window can be put back into
+    return traits_type::eof();
+  }
+
   int backOffset = -1;
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   if (!(d->mode & std::ios_base::binary)) {
@@ -169,6 +274,11 @@ BundleResourceBuffer::int_type BundleResourceBuffer::pbackfail(int_type ch)
 
 std::streamsize BundleResourceBuffer::showmanyc()
 {
+  if (d->reader) {
+    return static_cast<std::streamsize>(
+      d->size - (d->windowStart + (gptr() - eback())));
+  }
+
   assert(d->current <= d->end);
 
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
@@ -190,6 +300,10 @@ std::streambuf::pos_type BundleResourceBuffer::seekoff(
   std::ios_base::seekdir way,
   std::ios_base::openmode /*which*/)
 {
+  if (d->reader) {
+    return StreamSeek(off, way);
+  }
+
 #ifdef DATA_NEEDS_NEWLINE_CONVERSION
   std::streambuf::off_type step = 1;
   if (way == std::ios_base::beg) {
@@ -256,6 +370,68 @@ std::streambuf::pos_type BundleResourceBuffer::seekpos(
   return this->seekoff(sp, std::ios_base::beg);
 }
 
+BundleResourceBuffer::int_type BundleResourceBuffer::StreamUnderflow()
+{
+  if (gptr() < egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+
+  const std::size_t pos = d->windowStart + (gptr() - eback());
+  if (pos >= d->size) {
+    return traits_type::eof();
+  }
+
+  char* window = d->window.get();
+  if (pos < d->decoded) {
+    // a seek before the window
+    d->reader->Rewind();
+    d->decoded = 0;
+  }
+  while (d->decoded < pos) {
+    auto n = d->reader->Read(window, std::min(d->windowSize, pos - d->decoded));
+    if (n == 0) {
+      return traits_type::eof();
+    }
+    d->decoded += n;
+  }
+
+  auto n = d->reader->Read(window, d->windowSize);
+  if (n == 0) {
+    return traits_type::eof();
+  }
+  d->windowStart = d->decoded;
+  d->decoded += n;
+  setg(window, window, window + n);
+  return traits_type::to_int_type(*gptr());
+}
+
+BundleResourceBuffer::pos_type BundleResourceBuffer::StreamSeek(
+  off_type off,
+  std::ios_base::seekdir way)
+{
+  const auto windowEnd =
+    static_cast<off_type>(d->windowStart + (egptr() - eback()));
+  const auto windowStart = static_cast<off_type>(d->windowStart);
+  off_type target = off;
+  if (way == std::ios_base::cur) {
+    target += windowStart + (gptr() - eback());
+  } else if (way == std::ios_base::end) {
+    target += static_cast<off_type>(d->size);
+  }
+  if (target < 0 || target > static_cast<off_type>(d->size)) {
+    return pos_type(off_type(-1));
+  }
+
+  if (target >= windowStart && target <= windowEnd) {
+    setg(eback(), eback() + (target - windowStart), egptr());
+  } else {
+    // The data is read when it is accessed
+    d->windowStart = static_cast<std::size_t>(target);
+    setg(d->window.get(), d->window.get(), d->window.get());
+  }
+  return pos_type(target);
+}
+
 } // namespace detail
 
 } // namespace cppmicroservices
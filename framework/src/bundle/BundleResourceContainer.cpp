@@ -27,24 +27,246 @@
 
 #include "cppmicroservices/BundleResource.h"
 #include "cppmicroservices/GetBundleContext.h"
+#include "cppmicroservices/detail/BundleResourceBuffer.h"
 #include "cppmicroservices/detail/Log.h"
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
+#include <cstdint>
 #include <cstring>
 #include <exception>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 
 namespace cppmicroservices {
 
+namespace {
+
+// The local file header of a zip entry, see the zip APPNOTE
+const std::size_t LocalHeaderSize = 30;
+const unsigned LocalHeaderSignature = 0x04034b50;
+
+unsigned ReadLE16(const unsigned char* p)
+{
+  return static_cast<unsigned>(p[0]) | (static_cast<unsigned>(p[1]) << 8);
+}
+
+// Reads the offset of the data of a zip entry. The data follows the local
+// file header of the entry, whose size depends on the file name and extra
+// field lengths stored in the header. The archive may start after some
+// leading bytes of the file or memory block read by reader.
+bool ReadEntryDataOffset(mz_zip_archive* reader,
+                         const mz_zip_archive_file_stat& stat,
+                         mz_uint64& offset)
+{
+  unsigned char header[LocalHeaderSize];
+  const mz_uint64 headerOffset =
+    reader->m_archive_file_ofs + stat.m_local_header_ofs;
+  if (reader->m_pRead(reader->m_pIO_opaque,
+                      headerOffset,
+                      header,
+                      LocalHeaderSize) != LocalHeaderSize ||
+      ReadLE16(header) != (LocalHeaderSignature & 0xFFFF) ||
+      ReadLE16(header + 2) != (LocalHeaderSignature >> 16)) {
+    return false;
+  }
+  offset = headerOffset + LocalHeaderSize + ReadLE16(header + 26) +
+           ReadLE16(header + 28);
+  return offset + stat.m_comp_size <= reader->m_archive_size;
+}
+}
+
+/// Uncompresses the data of a zip entry incrementally. The data of file
+/// backed archives is read in chunks, with a zip reader taken from the
+/// pool for each chunk.
+class BundleResourceContainer::EntryReader final
+  : public detail::BundleResourceReader
+{
+public:
+  EntryReader(std::shared_ptr<BundleResourceContainer> container,
+              std::shared_ptr<RawBundleResources> rawData,
+              const mz_zip_archive_file_stat& stat,
+              mz_uint64 dataOffset)
+    : m_Container(std::move(container))
+    , m_RawData(std::move(rawData))
+    , m_Stat(stat)
+    , m_DataOffset(dataOffset)
+    , m_Dict(stat.m_method != 0 ? new unsigned char[TINFL_LZ_DICT_SIZE]
+                                : nullptr)
+  {
+    Rewind();
+  }
+
+  std::size_t Read(char* buffer, std::size_t size) override;
+
+  void Rewind() override;
+
+private:
+  static constexpr std::size_t InputBufferSize = 64 * 1024;
+
+  /// Reads size bytes at offset from the start of the entry data.
+  bool ReadInput(void* buffer, mz_uint64 offset, std::size_t size);
+
+  std::size_t Inflate(char* buffer, std::size_t size);
+
+  const std::shared_ptr<BundleResourceContainer> m_Container;
+  const std::shared_ptr<RawBundleResources> m_RawData;
+  const mz_zip_archive_file_stat m_Stat;
+  const mz_uint64 m_DataOffset;
+
+  mz_uint64 m_InputOffset;  // of the entry data read so far
+  mz_uint64 m_OutputOffset; // of the uncompressed data returned so far
+  mz_ulong m_Crc32;
+  bool m_Failed;
+
+  tinfl_decompressor m_Inflator;
+  tinfl_status m_Status;
+  // The uncompressed data is written to a wrapping dictionary buffer,
+  // of which m_DictAvail bytes at m_DictOffset are not returned yet.
+  std::unique_ptr<unsigned char[]> m_Dict;
+  std::size_t m_DictOffset;
+  std::size_t m_DictAvail;
+  std::unique_ptr<unsigned char[]> m_Input;
+  const unsigned char* m_InputPtr;
+  std::size_t m_InputAvail;
+};
+
+std::size_t BundleResourceContainer::EntryReader::Read(char* buffer,
+                                                       std::size_t size)
+{
+  if (m_Failed) {
+    return 0;
+  }
+
+  std::size_t read = 0;
+  if (m_Stat.m_method == 0) {
+    read = static_cast<std::size_t>(
+      std::min<mz_uint64>(size, m_Stat.m_comp_size - m_InputOffset));
+    if (!ReadInput(buffer, m_InputOffset, read)) {
+      m_Failed = true;
+      return 0;
+    }
+    m_InputOffset += read;
+    m_OutputOffset += read;
+  } else {
+    read = Inflate(buffer, size);
+  }
+
+  m_Crc32 =
+    mz_crc32(m_Crc32, reinterpret_cast<const unsigned char*>(buffer), read);
+  if (m_OutputOffset > m_Stat.m_uncomp_size ||
+      (m_OutputOffset == m_Stat.m_uncomp_size && m_Crc32 != m_Stat.m_crc32)) {
+    m_Failed = true;
+    return 0;
+  }
+  return read;
+}
+
+void BundleResourceContainer::EntryReader::Rewind()
+{
+  m_InputOffset = 0;
+  m_OutputOffset = 0;
+  m_Crc32 = MZ_CRC32_INIT;
+  m_Failed = false;
+  tinfl_init(&m_Inflator);
+  m_Status = TINFL_STATUS_NEEDS_MORE_INPUT;
+  m_DictOffset = 0;
+  m_DictAvail = 0;
+  m_InputPtr = nullptr;
+  m_InputAvail = 0;
+}
+
+bool BundleResourceContainer::EntryReader::ReadInput(void* buffer,
+                                                     mz_uint64 offset,
+                                                     std::size_t size)
+{
+  if (m_RawData) {
+    memcpy(buffer,
+           static_cast<const char*>(m_RawData->GetData()) + m_DataOffset +
+             offset,
+           size);
+    return true;
+  }
+
+  auto reader = m_Container->AcquireZipFileReader();
+  auto read =
+    reader->m_pRead(reader->m_pIO_opaque, m_DataOffset + offset, buffer, size);
+  m_Container->ReleaseZipFileReader(reader);
+  return read == size;
+}
+
+std::size_t BundleResourceContainer::EntryReader::Inflate(char* buffer,
+                                                          std::size_t size)
+{
+  std::size_t copied = 0;
+  while (copied < size) {
+    if (m_DictAvail == 0) {
+      if (m_Status == TINFL_STATUS_DONE) {
+        break;
+      }
+      if (m_InputAvail == 0 && m_InputOffset < m_Stat.m_comp_size) {
+        if (m_RawData) {
+          // inflate directly from memory
+          m_InputPtr = static_cast<const unsigned char*>(m_RawData->GetData()) +
+                       m_DataOffset;
+          m_InputAvail = static_cast<std::size_t>(m_Stat.m_comp_size);
+        } else {
+          m_InputAvail = static_cast<std::size_t>(std::min<mz_uint64>(
+            InputBufferSize, m_Stat.m_comp_size - m_InputOffset));
+          if (!m_Input) {
+            m_Input.reset(new unsigned char[InputBufferSize]);
+          }
+          if (!ReadInput(m_Input.get(), m_InputOffset, m_InputAvail)) {
+            m_Failed = true;
+            break;
+          }
+          m_InputPtr = m_Input.get();
+        }
+        m_InputOffset += m_InputAvail;
+      }
+
+      std::size_t inSize = m_InputAvail;
+      m_DictOffset =
+        static_cast<std::size_t>(m_OutputOffset & (TINFL_LZ_DICT_SIZE - 1));
+      std::size_t outSize = TINFL_LZ_DICT_SIZE - m_DictOffset;
+      m_Status = tinfl_decompress(
+        &m_Inflator,
+        m_InputPtr,
+        &inSize,
+        m_Dict.get(),
+        m_Dict.get() + m_DictOffset,
+        &outSize,
+        m_InputOffset < m_Stat.m_comp_size ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+      m_InputPtr += inSize;
+      m_InputAvail -= inSize;
+      m_DictAvail = outSize;
+      if (m_Status < TINFL_STATUS_DONE) {
+        m_Failed = true;
+        break;
+      }
+    }
+
+    auto n = std::min(size - copied, m_DictAvail);
+    memcpy(buffer + copied, m_Dict.get() + m_DictOffset, n);
+    m_DictOffset += n;
+    m_DictAvail -= n;
+    m_OutputOffset += n;
+    copied += n;
+  }
+  return copied;
+}
+
 BundleResourceContainer::BundleResourceContainer(
   const std::string& location,
   const ManifestT& bundleManifest)
   : m_Location(location)
   , m_ZipArchive()
   , m_ObjFile()
+  , m_RawBundleResources()
+  , m_ZipFileReaderCount(0)
   , m_ZipFileMutex()
   , m_IsContainerOpen(false)
 {
@@ -136,35 +358,104 @@ std::unique_ptr<void, void (*)(void*)> BundleResourceContainer::GetData(
   int index)
 {
   OpenAndInitializeContainer();
-  std::unique_lock<std::mutex> l(m_ZipFileStreamMutex);
-  void* data = mz_zip_reader_extract_to_heap(
-    const_cast<mz_zip_archive*>(&m_ZipArchive), index, nullptr, 0);
+  // Reading from memory does not change the state of the archive, so
+  // in-memory archives can be extracted from concurrently.
+  if (mz_zip_get_type(&m_ZipArchive) == MZ_ZIP_TYPE_MEMORY) {
+    void* data =
+      mz_zip_reader_extract_to_heap(&m_ZipArchive, index, nullptr, 0);
+    return { data, ::free };
+  }
+
+  auto reader = AcquireZipFileReader();
+  void* data = mz_zip_reader_extract_to_heap(reader, index, nullptr, 0);
+  ReleaseZipFileReader(reader);
   return { data, ::free };
 }
 
+std::shared_ptr<const char> BundleResourceContainer::GetDataView(int index)
+{
+  OpenAndInitializeContainer();
+
+  std::shared_ptr<RawBundleResources> rawData;
+  {
+    std::lock_guard<std::mutex> lock(m_ZipFileMutex);
+    rawData = m_RawBundleResources;
+  }
+
+  mz_zip_archive_file_stat zipStat;
+  mz_uint64 dataOffset = 0;
+  if (rawData && mz_zip_reader_file_stat(&m_ZipArchive, index, &zipStat) &&
+      zipStat.m_method == 0 && !zipStat.m_is_encrypted &&
+      zipStat.m_comp_size == zipStat.m_uncomp_size &&
+      ReadEntryDataOffset(&m_ZipArchive, zipStat, dataOffset)) {
+    return std::shared_ptr<const char>(
+      rawData, static_cast<const char*>(rawData->GetData()) + dataOffset);
+  }
+
+  auto data = GetData(index);
+  return std::shared_ptr<const char>(
+    static_cast<const char*>(data.release()),
+    [](const char* p) { ::free(const_cast<char*>(p)); });
+}
+
+std::unique_ptr<detail::BundleResourceReader>
+BundleResourceContainer::GetDataReader(int index)
+{
+  OpenAndInitializeContainer();
+
+  std::shared_ptr<RawBundleResources> rawData;
+  {
+    std::lock_guard<std::mutex> lock(m_ZipFileMutex);
+    rawData = m_RawBundleResources;
+  }
+
+  mz_zip_archive_file_stat zipStat;
+  if (!mz_zip_reader_file_stat(&m_ZipArchive, index, &zipStat) ||
+      zipStat.m_is_encrypted ||
+      (zipStat.m_method != 0 && zipStat.m_method != MZ_DEFLATED)) {
+    return nullptr;
+  }
+
+  mz_uint64 dataOffset = 0;
+  bool found = false;
+  if (rawData) {
+    found = ReadEntryDataOffset(&m_ZipArchive, zipStat, dataOffset);
+  } else {
+    auto reader = AcquireZipFileReader();
+    found = ReadEntryDataOffset(reader, zipStat, dataOffset);
+    ReleaseZipFileReader(reader);
+  }
+  if (!found) {
+    return nullptr;
+  }
+  return std::make_unique<EntryReader>(
+    shared_from_this(), std::move(rawData), zipStat, dataOffset);
+}
+
 void BundleResourceContainer::GetChildren(const std::string& resourcePath,
                                           bool relativePaths,
                                           std::vector<std::string>& names,
                                           std::vector<uint32_t>& indices) const
 {
-  auto iter = m_SortedEntries.find(std::make_pair(resourcePath, 0));
-  if (iter == m_SortedEntries.end()) {
+  auto cursor = m_SortedEntries.Find(resourcePath);
+  if (!cursor.Valid()) {
     return;
   }
 
-  for (++iter; iter != m_SortedEntries.end(); ++iter) {
-    if (resourcePath.size() > iter->first.size())
+  // All names starting with resourcePath directly follow it
+  for (cursor.Next(); cursor.Valid(); cursor.Next()) {
+    const auto& name = cursor.Name();
+    if (name.compare(0, resourcePath.size(), resourcePath) != 0) {
       break;
-    if (iter->first.compare(0, resourcePath.size(), resourcePath) == 0) {
-      std::size_t pos = iter->first.find_first_of('/', resourcePath.size());
-      if (pos == std::string::npos || pos == iter->first.size() - 1) {
-        if (relativePaths) {
-          names.push_back(iter->first.substr(resourcePath.size()));
-        } else {
-          names.push_back(iter->first);
-        }
-        indices.push_back(iter->second);
+    }
+    std::size_t pos = name.find_first_of('/', resourcePath.size());
+    if (pos == std::string::npos || pos == name.size() - 1) {
+      if (relativePaths) {
+        names.push_back(name.substr(resourcePath.size()));
+      } else {
+        names.push_back(name);
       }
+      indices.push_back(cursor.Index());
     }
   }
 }
@@ -218,27 +509,210 @@ void BundleResourceContainer::InitMiniz() const
       throw std::runtime_error("Could not init zip archive for bundle at " +
                                m_Location);
     }
+  } else {
+    m_RawBundleResources = std::move(rawBundleResourceData);
   }
 }
 
+void BundleResourceContainer::ZipReaderDeleter::operator()(
+  mz_zip_archive* reader) const
+{
+  mz_zip_reader_end(reader);
+  delete reader;
+}
+
+mz_zip_archive* BundleResourceContainer::AcquireZipFileReader() const
+{
+  std::unique_lock<std::mutex> lock(m_ZipFileStreamMutex);
+  if (m_IdleZipFileReaders.empty() &&
+      m_ZipFileReaderCount < MaxZipFileReaders) {
+    // Open another reader for this thread. This reads the central
+    // directory again, so do it without holding the lock.
+    ++m_ZipFileReaderCount;
+    lock.unlock();
+    ZipReaderPtr reader(new mz_zip_archive());
+    if (!mz_zip_reader_init_file(reader.get(), m_Location.c_str(), 0)) {
+      // e.g. out of file handles; wait for a busy reader instead
+      reader.reset();
+    }
+    lock.lock();
+    if (reader) {
+      m_ZipFileReaders.push_back(std::move(reader));
+      return m_ZipFileReaders.back().get();
+    }
+    --m_ZipFileReaderCount;
+  }
+  m_ZipFileReaderReleased.wait(lock,
+                               [this] { return !m_IdleZipFileReaders.empty(); });
+  auto reader = m_IdleZipFileReaders.back();
+  m_IdleZipFileReaders.pop_back();
+  return reader;
+}
+
+void BundleResourceContainer::ReleaseZipFileReader(
+  mz_zip_archive* reader) const
+{
+  {
+    std::lock_guard<std::mutex> lock(m_ZipFileStreamMutex);
+    m_IdleZipFileReaders.push_back(reader);
+  }
+  m_ZipFileReaderReleased.notify_all();
+}
+
 void BundleResourceContainer::InitSortedEntries() const
 {
+  // The entries do not change when the container is re-opened
+  if (!m_SortedEntries.Empty()) {
+    return;
+  }
+
   mz_uint numFiles =
     mz_zip_reader_get_num_files(const_cast<mz_zip_archive*>(&m_ZipArchive));
+  m_SortedEntries.Reserve(numFiles);
+  std::string_view lastToplevelDir;
   for (mz_uint fileIndex = 0; fileIndex < numFiles; ++fileIndex) {
     char fileName[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
     if (mz_zip_reader_get_filename(&m_ZipArchive,
                                    fileIndex,
                                    fileName,
                                    MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE)) {
-      std::string strFileName = fileName;
-      m_SortedEntries.insert(std::make_pair(strFileName, fileIndex));
+      std::string_view strFileName(fileName);
       std::size_t pos = strFileName.find_first_of('/');
-      if (pos != std::string::npos) {
-        m_SortedToplevelDirs.insert(strFileName.substr(0, pos));
+      // entries are usually grouped by directory in the archive
+      if (pos != std::string_view::npos &&
+          strFileName.substr(0, pos) != lastToplevelDir) {
+        lastToplevelDir =
+          *m_SortedToplevelDirs.emplace(strFileName.substr(0, pos)).first;
       }
+      m_SortedEntries.Add(strFileName, fileIndex);
     }
   }
+  m_SortedEntries.Seal();
+}
+
+void BundleResourceContainer::SortedEntries::Reserve(std::size_t count)
+{
+  m_Entries.reserve(count);
+  // names within a bundle tend to be short paths
+  m_Pool.reserve(count * 32);
+}
+
+void BundleResourceContainer::SortedEntries::Add(std::string_view name,
+                                                 int index)
+{
+  // zip entry names are limited to MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE
+  assert(name.size() <= UINT16_MAX);
+  m_Entries.push_back({ static_cast<uint32_t>(m_Pool.size()),
+                        0,
+                        static_cast<uint16_t>(name.size()),
+                        index });
+  m_Pool.append(name);
+}
+
+void BundleResourceContainer::SortedEntries::Seal()
+{
+  auto nameOf = [this](const Entry& e) {
+    return std::string_view(m_Pool.data() + e.offset, e.length);
+  };
+  std::stable_sort(m_Entries.begin(),
+                   m_Entries.end(),
+                   [&nameOf](const Entry& e1, const Entry& e2) {
+                     return nameOf(e1) < nameOf(e2);
+                   });
+  m_Entries.erase(std::unique(m_Entries.begin(),
+                              m_Entries.end(),
+                              [&nameOf](const Entry& e1, const Entry& e2) {
+                                return nameOf(e1) == nameOf(e2);
+                              }),
+                  m_Entries.end());
+
+  std::string pool;
+  pool.reserve(m_Pool.size());
+  std::string_view prev;
+  for (std::size_t i = 0; i < m_Entries.size(); ++i) {
+    auto& entry = m_Entries[i];
+    auto name = nameOf(entry);
+    std::size_t shared = 0;
+    if (i % RestartInterval != 0) {
+      auto limit = std::min(prev.size(), name.size());
+      while (shared < limit && prev[shared] == name[shared]) {
+        ++shared;
+      }
+    }
+    prev = name;
+    entry.offset = static_cast<uint32_t>(pool.size());
+    entry.shared = static_cast<uint16_t>(shared);
+    entry.length = static_cast<uint16_t>(name.size() - shared);
+    pool.append(name.substr(shared));
+  }
+  m_Pool.swap(pool);
+  m_Pool.shrink_to_fit();
+  m_Entries.shrink_to_fit();
+}
+
+int BundleResourceContainer::SortedEntries::CompareRestart(
+  std::size_t pos,
+  const std::string& name) const
+{
+  const auto& entry = m_Entries[pos];
+  return m_Pool.compare(entry.offset, entry.length, name);
+}
+
+BundleResourceContainer::SortedEntries::Cursor
+BundleResourceContainer::SortedEntries::Find(const std::string& name) const
+{
+  // Find the last restart entry which is not greater than name
+  std::size_t first = 0;
+  std::size_t count =
+    (m_Entries.size() + RestartInterval - 1) / RestartInterval;
+  while (count > 0) {
+    auto step = count / 2;
+    auto mid = first + step;
+    if (CompareRestart(mid * RestartInterval, name) <= 0) {
+      first = mid + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  if (first == 0) {
+    return Cursor(this, m_Entries.size());
+  }
+
+  // and decode the names following it
+  Cursor cursor(this, (first - 1) * RestartInterval);
+  auto end = std::min(first * RestartInterval, m_Entries.size());
+  for (; cursor.m_Pos < end; cursor.Next()) {
+    auto result = cursor.Name().compare(name);
+    if (result == 0) {
+      return cursor;
+    }
+    if (result > 0) {
+      break;
+    }
+  }
+  return Cursor(this, m_Entries.size());
+}
+
+BundleResourceContainer::SortedEntries::Cursor::Cursor(
+  const SortedEntries* entries,
+  std::size_t pos)
+  : m_Entries(entries)
+  , m_Pos(pos)
+{
+  if (Valid()) {
+    const auto& entry = m_Entries->m_Entries[m_Pos];
+    m_Name.assign(m_Entries->m_Pool, entry.offset, entry.length);
+  }
+}
+
+void BundleResourceContainer::SortedEntries::Cursor::Next()
+{
+  if (++m_Pos < m_Entries->m_Entries.size()) {
+    const auto& entry = m_Entries->m_Entries[m_Pos];
+    m_Name.resize(entry.shared);
+    m_Name.append(m_Entries->m_Pool, entry.offset, entry.length);
+  }
 }
 
 bool BundleResourceContainer::Matches(const std::string& name,
@@ -274,9 +748,16 @@ void BundleResourceContainer::OpenAndInitializeContainer() const
       // so make sure we clean up and close the file handle.
       mz_zip_reader_end(&m_ZipArchive);
       m_ObjFile.reset();
+      m_RawBundleResources.reset();
       throw std::runtime_error("Invalid zip archive layout for bundle at " +
                                m_Location);
     }
+    if (mz_zip_get_type(&m_ZipArchive) != MZ_ZIP_TYPE_MEMORY) {
+      std::lock_guard<std::mutex> streamLock(m_ZipFileStreamMutex);
+      // readers opened by pending reads may still be in use
+      m_IdleZipFileReaders.push_back(&m_ZipArchive);
+      ++m_ZipFileReaderCount;
+    }
     m_IsContainerOpen = true;
   }
 }
@@ -285,8 +766,19 @@ void BundleResourceContainer::CloseContainer()
 {
   std::lock_guard<std::mutex> lock(m_ZipFileMutex);
   if (m_IsContainerOpen) {
+    if (mz_zip_get_type(&m_ZipArchive) != MZ_ZIP_TYPE_MEMORY) {
+      // Wait for pending reads before closing the file handles
+      std::unique_lock<std::mutex> streamLock(m_ZipFileStreamMutex);
+      m_ZipFileReaderReleased.wait(streamLock, [this] {
+        return m_IdleZipFileReaders.size() == m_ZipFileReaderCount;
+      });
+      m_IdleZipFileReaders.clear();
+      m_ZipFileReaders.clear();
+      m_ZipFileReaderCount = 0;
+    }
     mz_zip_reader_end(&m_ZipArchive);
     m_ObjFile.reset();
+    m_RawBundleResources.reset();
     m_IsContainerOpen = false;
   }
 }
@@ -28,11 +28,13 @@
 
 #include "miniz.h"
 
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cppmicroservices {
@@ -40,6 +42,10 @@ namespace cppmicroservices {
 struct BundleArchive;
 class BundleResource;
 
+namespace detail {
+class BundleResourceReader;
+}
+
 class BundleResourceContainer
   : public std::enable_shared_from_this<BundleResourceContainer>
 {
@@ -78,6 +84,15 @@ public:
 
   std::unique_ptr<void, void (*)(void*)> GetData(int index);
 
+  /// Returns the data of the entry with the given index. Entries which
+  /// are stored uncompressed in an in-memory archive are not copied: the
+  /// returned pointer aliases the archive and keeps it alive.
+  std::shared_ptr<const char> GetDataView(int index);
+
+  /// Returns a reader which uncompresses the data of the entry with the
+  /// given index incrementally, or nullptr if the entry cannot be read.
+  std::unique_ptr<detail::BundleResourceReader> GetDataReader(int index);
+
   void GetChildren(const std::string& resourcePath,
                    bool relativePaths,
                    std::vector<std::string>& names,
@@ -96,15 +111,66 @@ public:
   void CloseContainer();
 
 private:
-  using NameIndexPair = std::pair<std::string, int>;
-
-  struct PairComp
+  /// The names of the zip entries in sorted order, with their zip file
+  /// indices.
+  ///
+  /// The names are front coded in a single string pool: each name is stored
+  /// as the length of the prefix it shares with the preceding name plus the
+  /// remaining suffix. Every RestartInterval-th name is stored in full, so
+  /// that a name can be found by a binary search over these names followed
+  /// by decoding at most RestartInterval names.
+  class SortedEntries
   {
-    inline bool operator()(const NameIndexPair& p1,
-                           const NameIndexPair& p2) const
+  public:
+    /// Iterates over the entries in sorted order, decoding the names.
+    class Cursor
+    {
+    public:
+      bool Valid() const { return m_Pos < m_Entries->m_Entries.size(); }
+      const std::string& Name() const { return m_Name; }
+      int Index() const { return m_Entries->m_Entries[m_Pos].index; }
+      void Next();
+
+    private:
+      friend class SortedEntries;
+      Cursor(const SortedEntries* entries, std::size_t pos);
+
+      const SortedEntries* m_Entries;
+      std::size_t m_Pos;
+      std::string m_Name;
+    };
+
+    void Reserve(std::size_t count);
+
+    /// Adds an entry. Entries can be added in any order, but cannot be
+    /// looked up before Seal() is called.
+    void Add(std::string_view name, int index);
+
+    /// Sorts and front codes the added entries. Of several entries with the
+    /// same name, the one which was added first is kept.
+    void Seal();
+
+    bool Empty() const { return m_Entries.empty(); }
+
+    /// Returns a cursor at the entry with the given name, or an invalid
+    /// cursor if there is no such entry.
+    Cursor Find(const std::string& name) const;
+
+  private:
+    static constexpr std::size_t RestartInterval = 16;
+
+    struct Entry
     {
-      return p1.first < p2.first;
-    }
+      uint32_t offset; // of the suffix in m_Pool
+      uint16_t shared; // length of the prefix shared with the previous name
+      uint16_t length; // length of the suffix
+      int index;       // zip file index
+    };
+
+    int CompareRestart(std::size_t pos, const std::string& name) const;
+
+    std::vector<Entry> m_Entries;
+    std::string m_Pool;
   };
 
   void InitSortedEntries() const;
@@ -123,14 +189,42 @@ private:
   const std::string m_Location;
   mutable mz_zip_archive m_ZipArchive;
   mutable std::unique_ptr<BundleObjFile> m_ObjFile;
+  // The archive data, if the archive is read from memory
+  mutable std::shared_ptr<RawBundleResources> m_RawBundleResources;
 
-  mutable std::set<NameIndexPair, PairComp> m_SortedEntries;
+  mutable SortedEntries m_SortedEntries;
   mutable std::set<std::string> m_SortedToplevelDirs;
 
-  // This is used to synchronize miniz file stream API calls.
+  class EntryReader;
+
+  struct ZipReaderDeleter
+  {
+    void operator()(mz_zip_archive* reader) const;
+  };
+  using ZipReaderPtr = std::unique_ptr<mz_zip_archive, ZipReaderDeleter>;
+
+  /// The maximum number of file backed zip readers, including m_ZipArchive,
+  /// per container. This bounds the number of open file handles.
+  static constexpr std::size_t MaxZipFileReaders = 8;
+
+  /// Takes an idle zip reader for extracting data from a file backed
+  /// archive, opening a new one if all readers are busy.
+  /// This function is thread-safe.
+  mz_zip_archive* AcquireZipFileReader() const;
+
+  /// Returns a reader taken with AcquireZipFileReader().
+  /// This function is thread-safe.
+  void ReleaseZipFileReader(mz_zip_archive* reader) const;
+
+  // This is used to synchronize access to the file backed zip readers.
   // Working with file streams is stateful (e.g. current read position)
-  // and hence not thread-safe.
+  // and hence not thread-safe, so each reader is used by one thread at
+  // a time. In-memory archives are read without locking.
   mutable std::mutex m_ZipFileStreamMutex;
+  mutable std::condition_variable m_ZipFileReaderReleased;
+  mutable std::vector<ZipReaderPtr> m_ZipFileReaders;
+  mutable std::vector<mz_zip_archive*> m_IdleZipFileReaders;
+  mutable std::size_t m_ZipFileReaderCount;
 
   // Synchronize opening/closing the underlying zip file. Only one thread
   // should open the underlying zip file.
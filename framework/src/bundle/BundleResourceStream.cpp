@@ -31,11 +31,21 @@ namespace cppmicroservices {
 
 BundleResourceStream::BundleResourceStream(const BundleResource& resource,
                                            std::ios_base::openmode mode)
-  : BundleResourceBuffer(resource.GetData(),
+  : BundleResourceBuffer(resource.GetDataView(),
                          resource.GetSize(),
                          mode | std::ios_base::in)
   , std::istream(this)
 {}
+
+BundleResourceStream::BundleResourceStream(const BundleResource& resource,
+                                           Window window,
+                                           std::ios_base::openmode mode)
+  : BundleResourceBuffer(resource.GetDataReader(),
+                         resource.GetSize(),
+                         window.size,
+                         mode | std::ios_base::in)
+  , std::istream(this)
+{}
 }
 
 US_MSVC_POP_WARNING
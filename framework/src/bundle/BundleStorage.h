@@ -73,6 +73,16 @@ struct BundleStorage
    */
   virtual std::vector<long> GetStartOnLaunchBundles() const = 0;
 
+  /**
+   * Record the manifest parsed from the resource container of a bundle
+   * archive which was inserted without a manifest.
+   *
+   * @param ba The bundle archive the manifest was parsed for.
+   * @param manifest The parsed manifest headers.
+   */
+  virtual void SetParsedManifest(const BundleArchive& ba,
+                                 const ManifestT& manifest) = 0;
+
   /**
    * Close this bundle storage and all bundles in it.
    */
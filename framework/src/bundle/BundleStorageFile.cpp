@@ -22,46 +22,547 @@
 
 #include "BundleStorageFile.h"
 
+#include "cppmicroservices/util/FileSystem.h"
+#ifdef US_PLATFORM_POSIX
+#  include "cppmicroservices/util/MappedFile.h"
+#endif
+
 #include "BundleArchive.h"
+#include "BundleResourceContainer.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 namespace cppmicroservices {
 
-BundleStorageFile::BundleStorageFile()
+namespace {
+
+using AnyOrderedMap = std::map<std::string, Any>;
+
+const char CacheMagic[4] = { 'U', 'S', 'B', 'C' };
+const uint32_t CacheVersion = 1;
+const char* const CacheFileName = "bundles.cache";
+
+// Bounds the recursion when reading nested manifest values
+const unsigned MaxValueDepth = 64;
+
+enum class ValueTag : uint8_t
+{
+  BOOL,
+  INT,
+  DOUBLE,
+  STRING,
+  VECTOR,
+  ANY_MAP,
+  ORDERED_MAP
+};
+
+/**
+ * Serializes cache records in native byte order. The cache file belongs to
+ * the framework storage area of one machine and is not meant to be shared.
+ */
+class CacheWriter
+{
+public:
+  template<class T>
+  void Write(const T& t)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be written");
+    buffer.append(reinterpret_cast<const char*>(&t), sizeof(T));
+  }
+
+  void WriteString(const std::string& str)
+  {
+    Write(static_cast<uint32_t>(str.size()));
+    buffer.append(str);
+  }
+
+  /**
+   * Throws std::invalid_argument if the map contains a value of a type
+   * the bundle manifest parser does not produce.
+   */
+  void WriteAnyMap(const AnyMap& map)
+  {
+    Write(ValueTag::ANY_MAP);
+    Write(static_cast<uint8_t>(map.GetType()));
+    Write(static_cast<uint32_t>(map.size()));
+    for (auto const& entry : map) {
+      WriteString(entry.first);
+      WriteValue(entry.second);
+    }
+  }
+
+  void WriteValue(const Any& any)
+  {
+    const std::type_info& type = any.Type();
+    if (type == typeid(bool)) {
+      Write(ValueTag::BOOL);
+      Write(static_cast<uint8_t>(ref_any_cast<bool>(any) ? 1 : 0));
+    } else if (type == typeid(int)) {
+      Write(ValueTag::INT);
+      Write(static_cast<int32_t>(ref_any_cast<int>(any)));
+    } else if (type == typeid(double)) {
+      Write(ValueTag::DOUBLE);
+      Write(ref_any_cast<double>(any));
+    } else if (type == typeid(std::string)) {
+      Write(ValueTag::STRING);
+      WriteString(ref_any_cast<std::string>(any));
+    } else if (type == typeid(std::vector<Any>)) {
+      const auto& vector = ref_any_cast<std::vector<Any>>(any);
+      Write(ValueTag::VECTOR);
+      Write(static_cast<uint32_t>(vector.size()));
+      for (auto const& value : vector) {
+        WriteValue(value);
+      }
+    } else if (type == typeid(AnyMap)) {
+      WriteAnyMap(ref_any_cast<AnyMap>(any));
+    } else if (type == typeid(AnyOrderedMap)) {
+      const auto& map = ref_any_cast<AnyOrderedMap>(any);
+      Write(ValueTag::ORDERED_MAP);
+      Write(static_cast<uint32_t>(map.size()));
+      for (auto const& entry : map) {
+        WriteString(entry.first);
+        WriteValue(entry.second);
+      }
+    } else {
+      throw std::invalid_argument(
+        std::string("Cannot cache manifest value of type ") + type.name());
+    }
+  }
+
+  std::string buffer;
+};
+
+/**
+ * Reads cache records written by CacheWriter. Throws std::runtime_error if
+ * the data is truncated or malformed.
+ */
+class CacheReader
+{
+public:
+  CacheReader(const char* data, std::size_t size)
+    : pos(data)
+    , end(data + size)
+  {}
+
+  template<class T>
+  T Read()
+  {
+    T t;
+    ReadBytes(&t, sizeof(T));
+    return t;
+  }
+
+  void ReadBytes(void* dst, std::size_t size)
+  {
+    Check(size);
+    std::memcpy(dst, pos, size);
+    pos += size;
+  }
+
+  std::string ReadString()
+  {
+    auto size = Read<uint32_t>();
+    Check(size);
+    std::string str(pos, size);
+    pos += size;
+    return str;
+  }
+
+  // Reads the number of elements of a collection, every element
+  // takes at least one byte
+  uint32_t ReadCount()
+  {
+    auto count = Read<uint32_t>();
+    Check(count);
+    return count;
+  }
+
+  Any ReadValue(unsigned depth = 0)
+  {
+    if (depth > MaxValueDepth) {
+      throw std::runtime_error("Bundle cache values are nested too deeply");
+    }
+    switch (Read<ValueTag>()) {
+      case ValueTag::BOOL:
+        return Any(Read<uint8_t>() != 0);
+      case ValueTag::INT:
+        return Any(static_cast<int>(Read<int32_t>()));
+      case ValueTag::DOUBLE:
+        return Any(Read<double>());
+      case ValueTag::STRING:
+        return Any(ReadString());
+      case ValueTag::VECTOR: {
+        Any any = std::vector<Any>();
+        auto& vector = ref_any_cast<std::vector<Any>>(any);
+        auto count = ReadCount();
+        vector.reserve(count);
+        for (; count > 0; --count) {
+          vector.push_back(ReadValue(depth + 1));
+        }
+        return any;
+      }
+      case ValueTag::ANY_MAP: {
+        auto type = Read<uint8_t>();
+        if (type > AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS) {
+          throw std::runtime_error("Invalid map type in bundle cache");
+        }
+        Any any = AnyMap(static_cast<AnyMap::map_type>(type));
+        auto& map = ref_any_cast<AnyMap>(any);
+        for (auto count = ReadCount(); count > 0; --count) {
+          auto key = ReadString();
+          map.emplace(std::move(key), ReadValue(depth + 1));
+        }
+        return any;
+      }
+      case ValueTag::ORDERED_MAP: {
+        Any any = AnyOrderedMap();
+        auto& map = ref_any_cast<AnyOrderedMap>(any);
+        for (auto count = ReadCount(); count > 0; --count) {
+          auto key = ReadString();
+          map.emplace(std::move(key), ReadValue(depth + 1));
+        }
+        return any;
+      }
+    }
+    throw std::runtime_error("Invalid value tag in bundle cache");
+  }
+
+  bool AtEnd() const { return pos == end; }
+
+private:
+  void Check(std::size_t size) const
+  {
+    if (static_cast<std::size_t>(end - pos) < size) {
+      throw std::runtime_error("Bundle cache is truncated");
+    }
+  }
+
+  const char* pos;
+  const char* const end;
+};
+
+/**
+ * A bundle archive read from the cache, before its file has been checked
+ */
+struct ArchiveRecord
+{
+  long id;
+  std::string prefix;
+  int32_t autostartSetting;
+  AnyMap manifest{ AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS };
+};
+
+}
+
+BundleStorageFile::BundleStorageFile(const std::string& dir, bool clean)
   : BundleStorage()
+  , cacheFile(dir + util::DIR_SEP + CacheFileName)
+  , nextFreeId(1)
+{
+  if (clean) {
+    std::remove(cacheFile.c_str());
+    return;
+  }
+
+  try {
+    Load();
+  } catch (const std::exception&) {
+    // A corrupt cache only costs installing the bundles from scratch
+    archives.v.clear();
+    archives.stamps.clear();
+    nextFreeId = 1;
+  }
+}
+
+void BundleStorageFile::Load()
+{
+  uint64_t size = 0;
+  int64_t modified = 0;
+  if (!util::GetFileInfo(cacheFile, size, modified) || size == 0) {
+    return;
+  }
+
+#ifdef US_PLATFORM_POSIX
+  MappedFile file(cacheFile, static_cast<std::size_t>(size), 0);
+  if (!file.GetData()) {
+    return;
+  }
+  CacheReader reader(static_cast<const char*>(file.GetData()),
+                     file.GetSize());
+#else
+  std::ifstream file(cacheFile, std::ios::binary);
+  const std::string data{ std::istreambuf_iterator<char>(file),
+                          std::istreambuf_iterator<char>() };
+  CacheReader reader(data.data(), data.size());
+#endif
+
+  char magic[sizeof(CacheMagic)];
+  reader.ReadBytes(magic, sizeof(magic));
+  if (std::memcmp(magic, CacheMagic, sizeof(magic)) != 0 ||
+      reader.Read<uint32_t>() != CacheVersion) {
+    // Written by an incompatible framework version, start from scratch
+    return;
+  }
+  const auto nextId = static_cast<long>(reader.Read<int64_t>());
+
+  std::map<long, std::shared_ptr<BundleArchive>> loaded;
+  std::map<std::string, FileStamp> loadedStamps;
+  for (auto locations = reader.ReadCount(); locations > 0; --locations) {
+    const std::string location = reader.ReadString();
+    FileStamp stamp;
+    stamp.size = reader.Read<uint64_t>();
+    stamp.modified = reader.Read<int64_t>();
+
+    // The resource container takes the top level entries from the keys of
+    // the manifests passed to it, without opening the file
+    AnyMap topLevelDirs(AnyMap::ORDERED_MAP);
+    for (auto dirs = reader.ReadCount(); dirs > 0; --dirs) {
+      topLevelDirs.emplace(reader.ReadString(), Any());
+    }
+
+    std::vector<ArchiveRecord> records;
+    for (auto count = reader.ReadCount(); count > 0; --count) {
+      ArchiveRecord record;
+      record.id = static_cast<long>(reader.Read<int64_t>());
+      record.prefix = reader.ReadString();
+      record.autostartSetting = reader.Read<int32_t>();
+      Any manifest = reader.ReadValue();
+      if (manifest.Type() != typeid(AnyMap)) {
+        throw std::runtime_error("Invalid bundle manifest in bundle cache");
+      }
+      record.manifest = std::move(ref_any_cast<AnyMap>(manifest));
+      records.push_back(std::move(record));
+    }
+
+    std::shared_ptr<BundleResourceContainer> resCont;
+    try {
+      FileStamp current;
+      if (topLevelDirs.empty() ||
+          !util::GetFileInfo(location, current.size, current.modified) ||
+          current.size != stamp.size || current.modified != stamp.modified) {
+        continue;
+      }
+      resCont =
+        std::make_shared<BundleResourceContainer>(location, topLevelDirs);
+    } catch (const std::exception&) {
+      continue;
+    }
+
+    for (auto& record : records) {
+      auto archive =
+        std::make_shared<BundleArchive>(this,
+                                        resCont,
+                                        std::move(record.prefix),
+                                        location,
+                                        record.id,
+                                        std::move(record.manifest));
+      archive->SetAutostartSetting(record.autostartSetting);
+      loaded.insert(std::make_pair(record.id, std::move(archive)));
+    }
+    loadedStamps.insert(std::make_pair(location, stamp));
+  }
+
+  if (!reader.AtEnd()) {
+    throw std::runtime_error("Bundle cache has trailing data");
+  }
+
+  archives.v = std::move(loaded);
+  archives.stamps = std::move(loadedStamps);
+  nextFreeId = nextId;
+}
+
+void BundleStorageFile::Save() const
 {
-  throw std::logic_error("not implemented");
+  auto l = archives.Lock();
+  US_UNUSED(l);
+
+  std::map<std::string, std::vector<std::shared_ptr<BundleArchive>>>
+    locations;
+  for (auto const& v : archives.v) {
+    locations[v.second->GetBundleLocation()].push_back(v.second);
+  }
+
+  CacheWriter writer;
+  writer.buffer.append(CacheMagic, sizeof(CacheMagic));
+  writer.Write(CacheVersion);
+  writer.Write(static_cast<int64_t>(nextFreeId));
+
+  std::vector<std::string> locationRecords;
+  for (auto const& location : locations) {
+    auto stamp = archives.stamps.find(location.first);
+    if (stamp == archives.stamps.end()) {
+      continue;
+    }
+
+    CacheWriter locationWriter;
+    locationWriter.WriteString(location.first);
+    locationWriter.Write(stamp->second.size);
+    locationWriter.Write(stamp->second.modified);
+    auto dirs =
+      location.second.front()->GetResourceContainer()->GetTopLevelDirs();
+    locationWriter.Write(static_cast<uint32_t>(dirs.size()));
+    for (auto const& dir : dirs) {
+      locationWriter.WriteString(dir);
+    }
+
+    std::vector<std::string> archiveRecords;
+    for (auto const& ba : location.second) {
+      const ManifestT* manifest = &ba->GetInjectedManifest();
+      if (manifest->empty()) {
+        auto parsed = archives.parsedManifests.find(ba->GetBundleId());
+        if (parsed != archives.parsedManifests.end()) {
+          manifest = &parsed->second;
+        }
+      }
+
+      CacheWriter archiveWriter;
+      archiveWriter.Write(static_cast<int64_t>(ba->GetBundleId()));
+      archiveWriter.WriteString(ba->GetResourcePrefix());
+      archiveWriter.Write(static_cast<int32_t>(ba->GetAutostartSetting()));
+      try {
+        archiveWriter.WriteAnyMap(*manifest);
+      } catch (const std::invalid_argument&) {
+        // The bundle will be installed from scratch on the next launch
+        continue;
+      }
+      archiveRecords.push_back(std::move(archiveWriter.buffer));
+    }
+
+    locationWriter.Write(static_cast<uint32_t>(archiveRecords.size()));
+    for (auto const& record : archiveRecords) {
+      locationWriter.buffer.append(record);
+    }
+    locationRecords.push_back(std::move(locationWriter.buffer));
+  }
+
+  writer.Write(static_cast<uint32_t>(locationRecords.size()));
+  for (auto const& record : locationRecords) {
+    writer.buffer.append(record);
+  }
+
+  // Replace the cache file in one step, so that a crash while writing
+  // cannot leave a truncated cache behind
+  const std::string tmpFile = cacheFile + ".tmp";
+  {
+    std::ofstream file(tmpFile, std::ios::binary | std::ios::trunc);
+    file.write(writer.buffer.data(),
+               static_cast<std::streamsize>(writer.buffer.size()));
+    if (!file) {
+      throw std::runtime_error("Could not write bundle cache " + tmpFile);
+    }
+  }
+  std::remove(cacheFile.c_str());
+  if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+    std::remove(tmpFile.c_str());
+    throw std::runtime_error("Could not write bundle cache " + cacheFile);
+  }
 }
 
 std::shared_ptr<BundleArchive> BundleStorageFile::CreateAndInsertArchive(
-  const std::shared_ptr<BundleResourceContainer>& /*resCont*/
-  ,
-  const std::string& /*topLevelEntries*/
-  ,
-  const ManifestT&)
+  const std::shared_ptr<BundleResourceContainer>& resCont,
+  const std::string& prefix,
+  const ManifestT& bundleManifest)
 {
-  throw std::logic_error("not implemented");
+  const std::string location = resCont->GetLocation();
+  FileStamp stamp{ 0, 0 };
+  bool stamped = false;
+  try {
+    stamped = util::GetFileInfo(location, stamp.size, stamp.modified);
+  } catch (const std::exception&) {
+  }
+
+  auto l = archives.Lock();
+  US_UNUSED(l);
+  auto id = nextFreeId++;
+  auto p = archives.v.insert(std::make_pair(
+    id,
+    std::make_shared<BundleArchive>(
+      this, resCont, prefix, location, id, bundleManifest)));
+  // the stamp of the file as installed last, the file may have changed
+  // since other archives were installed from it
+  if (stamped) {
+    archives.stamps.insert_or_assign(location, stamp);
+  } else {
+    archives.stamps.erase(location);
+  }
+  return p.first->second;
 }
 
-bool BundleStorageFile::RemoveArchive(const BundleArchive* /*ba*/)
+bool BundleStorageFile::RemoveArchive(const BundleArchive* ba)
 {
-  throw std::logic_error("not implemented");
+  auto l = archives.Lock();
+  US_UNUSED(l);
+  auto iter = archives.v.find(ba->GetBundleId());
+  if (iter != archives.v.end()) {
+    const auto location = iter->second->GetBundleLocation();
+    archives.parsedManifests.erase(iter->first);
+    archives.v.erase(iter);
+    // drop the stamp with the last archive of its location
+    if (std::none_of(archives.v.begin(), archives.v.end(), [&](auto& v) {
+          return v.second->GetBundleLocation() == location;
+        })) {
+      archives.stamps.erase(location);
+    }
+    return true;
+  }
+  return false;
 }
 
 std::vector<std::shared_ptr<BundleArchive>>
 BundleStorageFile::GetAllBundleArchives() const
 {
-  throw std::logic_error("not implemented");
+  std::vector<std::shared_ptr<BundleArchive>> res;
+  auto l = archives.Lock();
+  US_UNUSED(l);
+  for (auto const& v : archives.v) {
+    res.emplace_back(v.second);
+  }
+  return res;
 }
 
 std::vector<long> BundleStorageFile::GetStartOnLaunchBundles() const
 {
-  throw std::logic_error("not implemented");
+  std::vector<long> res;
+  auto l = archives.Lock();
+  US_UNUSED(l);
+  for (auto& v : archives.v) {
+    if (v.second->GetAutostartSetting() != -1) {
+      res.emplace_back(v.second->GetBundleId());
+    }
+  }
+  return res;
+}
+
+void BundleStorageFile::SetParsedManifest(const BundleArchive& ba,
+                                          const ManifestT& manifest)
+{
+  auto l = archives.Lock();
+  US_UNUSED(l);
+  if (archives.v.count(ba.GetBundleId())) {
+    archives.parsedManifests.insert_or_assign(ba.GetBundleId(), manifest);
+  }
 }
 
 void BundleStorageFile::Close()
 {
-  throw std::logic_error("not implemented");
+  try {
+    Save();
+  } catch (const std::exception&) {
+    // The cache is an optimization, the next launch installs the bundles
+    // from scratch
+  }
+  archives.v.clear();
+  archives.parsedManifests.clear();
+  archives.stamps.clear();
 }
 }
@@ -23,20 +23,44 @@
 #ifndef CPPMICROSERVICES_BUNDLESTORAGEFILE_H
 #define CPPMICROSERVICES_BUNDLESTORAGEFILE_H
 
+#include "cppmicroservices/detail/Threads.h"
+
 #include "BundleStorage.h"
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
 namespace cppmicroservices {
 
+/**
+ * Bundle storage which persists the installed bundle archives in a cache
+ * file when it is closed.
+ *
+ * For each bundle location, the cache records the size and modification
+ * time of the file, its top level entries and, for each archive, the bundle
+ * id, the autostart setting and the manifest. When the storage is created
+ * again, archives of unchanged files are restored from the cache without
+ * opening the file or parsing its manifest. Archives of changed or missing
+ * files are dropped.
+ */
 class BundleStorageFile : public BundleStorage
 {
 
 public:
-  BundleStorageFile();
+  /**
+   * Open the bundle cache in a directory.
+   *
+   * @param dir The directory containing the cache file.
+   * @param clean If true, the existing cache file is deleted.
+   */
+  BundleStorageFile(const std::string& dir, bool clean);
 
   std::shared_ptr<BundleArchive> CreateAndInsertArchive(
     const std::shared_ptr<BundleResourceContainer>& resCont,
     const std::string& topLevelEntry,
-    const ManifestT&) override;
+    const ManifestT& bundleManifest) override;
 
   bool RemoveArchive(const BundleArchive* ba) override;
 
@@ -45,7 +69,44 @@ public:
 
   std::vector<long> GetStartOnLaunchBundles() const override;
 
+  void SetParsedManifest(const BundleArchive& ba,
+                         const ManifestT& manifest) override;
+
   void Close() override;
+
+private:
+  struct FileStamp
+  {
+    uint64_t size;
+    int64_t modified;
+  };
+
+  /**
+   * Restore the archives recorded in the cache file.
+   * Throws std::runtime_error if the cache file is corrupt.
+   */
+  void Load();
+
+  /**
+   * Write all archives to the cache file.
+   */
+  void Save() const;
+
+  const std::string cacheFile;
+
+  long nextFreeId;
+
+  /**
+   * Bundle id sorted list of all active bundle archives, together with the
+   * manifests parsed for them and the stamps of their files at the time
+   * they were installed.
+   */
+  struct : detail::MultiThreaded<>
+  {
+    std::map<long, std::shared_ptr<BundleArchive>> v;
+    std::map<long, ManifestT> parsedManifests;
+    std::map<std::string, FileStamp> stamps;
+  } archives;
 };
 }
 
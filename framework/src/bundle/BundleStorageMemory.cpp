@@ -89,6 +89,12 @@ std::vector<long> BundleStorageMemory::GetStartOnLaunchBundles() const
   return res;
 }
 
+void BundleStorageMemory::SetParsedManifest(const BundleArchive&,
+                                            const ManifestT&)
+{
+  // Nothing to do, the manifest is not needed once the bundle is installed
+}
+
 void BundleStorageMemory::Close()
 {
   // Not need to lock "archives" here: at this point, the framework
@@ -50,6 +50,9 @@ public:
 
   std::vector<long> GetStartOnLaunchBundles() const override;
 
+  void SetParsedManifest(const BundleArchive& ba,
+                         const ManifestT& manifest) override;
+
   void Close() override;
 
 private:
@@ -42,6 +42,7 @@ const std::string BUNDLE_SYMBOLICNAME = "bundle.symbolic_name";
 const std::string BUNDLE_MANIFESTVERSION = "bundle.manifest_version";
 const std::string BUNDLE_ACTIVATIONPOLICY = "bundle.activation_policy";
 const std::string ACTIVATION_LAZY = "lazy";
+const std::string BUNDLE_STARTLEVEL = "bundle.start_level";
 const std::string FRAMEWORK_VERSION = "org.cppmicroservices.framework.version";
 const std::string FRAMEWORK_VENDOR = "org.cppmicroservices.framework.vendor";
 const std::string FRAMEWORK_STORAGE = "org.cppmicroservices.framework.storage";
@@ -58,6 +59,16 @@ const std::string FRAMEWORK_WORKING_DIR =
   "org.cppmicroservices.framework.working.dir";
 const std::string FRAMEWORK_BUNDLE_VALIDATION_FUNC = 
     "org.cppmicroservices.framework.bundle.validation.function";
+const std::string FRAMEWORK_SERVICE_INDEX_PROPERTIES =
+  "org.cppmicroservices.framework.service.index.properties";
+const std::string FRAMEWORK_SERVICE_SNAPSHOTS =
+  "org.cppmicroservices.framework.service.snapshots";
+const std::string FRAMEWORK_BUNDLE_CACHE =
+  "org.cppmicroservices.framework.bundle.cache";
+const std::string FRAMEWORK_BUNDLE_START_THREADS =
+  "org.cppmicroservices.framework.bundle.start.threads";
+const std::string FRAMEWORK_SERVICE_EVENT_THREADS =
+  "org.cppmicroservices.framework.service.event.threads";
 const std::string OBJECTCLASS = "objectclass";
 const std::string SERVICE_ID = "service.id";
 const std::string SERVICE_PID = "service.pid";
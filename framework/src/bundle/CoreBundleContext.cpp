@@ -34,10 +34,13 @@ US_MSVC_DISABLE_WARNING(4355)
 #include "cppmicroservices/util/String.h"
 
 #include "BundleContextPrivate.h"
+#include "BundleStorageFile.h"
 #include "BundleStorageMemory.h"
 #include "BundleUtils.h"
 #include "FrameworkPrivate.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <memory>
 
@@ -101,6 +104,7 @@ CoreBundleContext::CoreBundleContext(
   , firstInit(true)
   , initCount(0)
   , libraryLoadOptions(0)
+  , bundleStartThreads(1)
 {
   auto enableDiagLog =
     any_cast<bool>(frameworkProperties.at(Constants::FRAMEWORK_LOG));
@@ -127,12 +131,14 @@ void CoreBundleContext::Init()
   DIAG_LOG(*sink) << "initializing";
   initCount++;
 
+  bool cleanStorage = false;
   auto storageCleanProp =
     frameworkProperties.find(Constants::FRAMEWORK_STORAGE_CLEAN);
   if (firstInit && storageCleanProp != frameworkProperties.end() &&
       storageCleanProp->second ==
         Constants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT) {
     // DeleteFWDir();
+    cleanStorage = true;
     firstInit = false;
   }
 
@@ -144,8 +150,20 @@ void CoreBundleContext::Init()
 
   frameworkProperties[Constants::FRAMEWORK_UUID] = ss.str();
 
-  // $TODO we only support non-persistent (main memory) storage yet
-  storage = std::make_unique<BundleStorageMemory>();
+  // Bundles are only kept across launches if asked for
+  std::string bundleCacheDir;
+  auto bundleCacheProp =
+    frameworkProperties.find(Constants::FRAMEWORK_BUNDLE_CACHE);
+  if (bundleCacheProp != frameworkProperties.end() &&
+      any_cast<bool>(bundleCacheProp->second)) {
+    bundleCacheDir =
+      GetPersistentStoragePath(this, "bundles", /*create=*/true);
+  }
+  if (!bundleCacheDir.empty()) {
+    storage = std::make_unique<BundleStorageFile>(bundleCacheDir, cleanStorage);
+  } else {
+    storage = std::make_unique<BundleStorageMemory>();
+  }
   //  if (frameworkProperties[FWProps::READ_ONLY_PROP] == true)
   //  {
   //    dataStorage.clear();
@@ -219,13 +237,62 @@ void CoreBundleContext::Init()
   }
   DIAG_LOG(*sink) << "Library Load Options = " << libraryLoadOptions;
 #endif
+
+  bundleStartThreads = 1;
+#ifdef US_ENABLE_THREADING_SUPPORT
+  auto bundleStartThreadsProp =
+    frameworkProperties.find(Constants::FRAMEWORK_BUNDLE_START_THREADS);
+  if (bundleStartThreadsProp != frameworkProperties.end()) {
+    try {
+      bundleStartThreads =
+        std::max(1, any_cast<int>(bundleStartThreadsProp->second));
+    } catch (...) {
+      DIAG_LOG(*sink) << "Unable to read the number of bundle start threads "
+                         "from config.";
+    }
+  }
+#endif
+  DIAG_LOG(*sink) << "Bundle Start Threads = " << bundleStartThreads;
+
+  int serviceEventThreads = 0;
+#ifdef US_ENABLE_THREADING_SUPPORT
+  auto serviceEventThreadsProp =
+    frameworkProperties.find(Constants::FRAMEWORK_SERVICE_EVENT_THREADS);
+  if (serviceEventThreadsProp != frameworkProperties.end()) {
+    try {
+      serviceEventThreads =
+        std::max(0, any_cast<int>(serviceEventThreadsProp->second));
+    } catch (...) {
+      DIAG_LOG(*sink) << "Unable to read the number of service event threads "
+                         "from config.";
+    }
+  }
+#endif
+  DIAG_LOG(*sink) << "Service Event Threads = " << serviceEventThreads;
+  listeners.StartServiceEventDelivery(
+    static_cast<std::size_t>(serviceEventThreads));
 }
 
 void CoreBundleContext::Uninit0()
 {
   DIAG_LOG(*sink) << "uninit";
+  const auto bundleEvents = listeners.GetBundleEventStatistics();
+  const auto frameworkEvents = listeners.GetFrameworkEventStatistics();
+  DIAG_LOG(*sink) << "Dispatched " << bundleEvents.count
+                  << " bundle events in "
+                  << std::chrono::duration<double, std::milli>(
+                       bundleEvents.dispatchTime)
+                       .count()
+                  << " ms and " << frameworkEvents.count
+                  << " framework events in "
+                  << std::chrono::duration<double, std::milli>(
+                       frameworkEvents.dispatchTime)
+                       .count()
+                  << " ms";
   serviceHooks.Close();
   systemBundle->UninitSystemBundle();
+  // deliver the pending service events while the framework is still usable
+  listeners.StopServiceEventDelivery();
 }
 
 void CoreBundleContext::Uninit1()
@@ -159,6 +159,11 @@ public:
    */
   int libraryLoadOptions;
 
+  /**
+   * Number of threads starting bundles on framework launch.
+   */
+  int bundleStartThreads;
+
   std::function<bool(const cppmicroservices::Bundle&)> validationFunc;
 
   ~CoreBundleContext();
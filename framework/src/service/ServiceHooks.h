@@ -67,6 +67,11 @@ public:
                                const std::string& filter,
                                std::vector<ServiceReferenceBase>& refs);
 
+  /**
+   * Returns true if a ServiceEventListenerHook is registered.
+   */
+  bool HasServiceEventListenerHooks() const;
+
   void FilterServiceEventReceivers(
     const ServiceEvent& evt,
     ServiceListeners::ServiceListenerEntries& receivers);
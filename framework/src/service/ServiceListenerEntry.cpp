@@ -163,6 +163,12 @@ bool ServiceListenerEntry::Contains(
          ServiceListenerCompare()(d->listener, listener);
 }
 
+const std::shared_ptr<BundleContextPrivate>&
+ServiceListenerEntry::GetBundleContextPrivate() const
+{
+  return d->context;
+}
+
 ListenerTokenId ServiceListenerEntry::Id() const
 {
   return d->tokenId;
@@ -72,6 +72,8 @@ public:
                 const ServiceListener& listener,
                 void* data) const;
 
+  const std::shared_ptr<BundleContextPrivate>& GetBundleContextPrivate() const;
+
   ListenerTokenId Id() const;
 
   std::size_t Hash() const;
@@ -40,15 +40,88 @@ US_MSVC_PUSH_DISABLE_WARNING(
 #include "BundlePrivate.h"
 #include "CoreBundleContext.h"
 #include "Properties.h"
+#include "SerialExecutor.h"
 #include "ServiceReferenceBasePrivate.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <utility>
 
 namespace cppmicroservices {
 
+namespace {
+
+/**
+ * Choose the property a listener filter is cached under in the equality
+ * cache, and the values the property must equal for the filter to match.
+ * Properties other than objectclass, which many listeners test for the
+ * same interface, are preferred, and then the property with the fewest
+ * values. service.id values are compared as numbers and not cached here.
+ * The choice only depends on the filter, so that the listener can be
+ * found again for removal.
+ */
+bool GetEqualityTerm(const LDAPExpr& ldapExpr,
+                     std::string& key,
+                     LDAPExpr::StringList& values)
+{
+  LDAPExpr::ObjectClassSet attrNames;
+  ldapExpr.GetAttributeNames(attrNames);
+  std::vector<std::string> sortedNames(attrNames.begin(), attrNames.end());
+  std::sort(sortedNames.begin(), sortedNames.end());
+
+  bool found = false;
+  for (auto& attrName : sortedNames) {
+    if (attrName == Constants::SERVICE_ID) {
+      continue;
+    }
+    LDAPExpr::StringList attrValues;
+    if (!ldapExpr.GetMatchedValues(attrName, attrValues)) {
+      continue;
+    }
+    const bool isClass = attrName == Constants::OBJECTCLASS;
+    const bool keyIsClass = found && key == Constants::OBJECTCLASS;
+    if (!found || (keyIsClass && !isClass) ||
+        (keyIsClass == isClass && attrValues.size() < values.size())) {
+      key = attrName;
+      values = std::move(attrValues);
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**
+ * Returns an immutable copy of the listeners for dispatching an event
+ * without holding the lock. The copy is shared by all events until the
+ * listeners change.
+ */
+template<typename T>
+auto GetSnapshot(T& listenerMap)
+{
+  auto l = listenerMap.Lock();
+  US_UNUSED(l);
+  if (!listenerMap.snapshot) {
+    listenerMap.snapshot =
+      std::make_shared<const decltype(listenerMap.value)>(listenerMap.value);
+  }
+  return listenerMap.snapshot;
+}
+
+int64_t ElapsedNanos(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now() - start)
+    .count();
+}
+}
+
 ServiceListeners::ServiceListeners(CoreBundleContext* coreCtx)
   : listenerId(0)
+  , bundleEventCount(0)
+  , bundleEventDispatchTime(0)
+  , frameworkEventCount(0)
+  , frameworkEventDispatchTime(0)
   , coreCtx(coreCtx)
 {
   hashedServiceKeys.push_back(Constants::OBJECTCLASS);
@@ -57,18 +130,62 @@ ServiceListeners::ServiceListeners(CoreBundleContext* coreCtx)
 
 void ServiceListeners::Clear()
 {
-  bundleListenerMap.Lock(), bundleListenerMap.value.clear();
+  StopServiceEventDelivery();
+  {
+    auto l = bundleListenerMap.Lock();
+    US_UNUSED(l);
+    bundleListenerMap.value.clear();
+    bundleListenerMap.snapshot.reset();
+  }
+  {
+    auto l = bundleEventsListenerMap.Lock();
+    US_UNUSED(l);
+    bundleEventsListenerMap.value.clear();
+    bundleEventsListenerMap.snapshot.reset();
+  }
+  {
+    auto l = bundleEventBatches.Lock();
+    US_UNUSED(l);
+    for (auto& batch : bundleEventBatches.threads) {
+      batch.second->events.clear();
+    }
+  }
   {
     auto l = this->Lock();
     US_UNUSED(l);
     serviceSet.clear();
     hashedServiceKeys.clear();
     complicatedListeners.clear();
+    attributeListeners.clear();
+    equalityCache.clear();
     cache[0].clear();
     cache[1].clear();
   }
 
-  frameworkListenerMap.Lock(), frameworkListenerMap.value.clear();
+  {
+    auto l = frameworkListenerMap.Lock();
+    US_UNUSED(l);
+    frameworkListenerMap.value.clear();
+    frameworkListenerMap.snapshot.reset();
+  }
+}
+
+void ServiceListeners::StartServiceEventDelivery(std::size_t threads)
+{
+  StopServiceEventDelivery();
+  if (threads > 0) {
+    auto executor = std::make_shared<SerialExecutor>(threads);
+    serviceEventExecutor.Lock(), serviceEventExecutor.value = executor;
+  }
+}
+
+void ServiceListeners::StopServiceEventDelivery()
+{
+  std::shared_ptr<SerialExecutor> executor;
+  serviceEventExecutor.Lock(), executor.swap(serviceEventExecutor.value);
+  if (executor) {
+    executor->Shutdown();
+  }
 }
 
 ListenerToken ServiceListeners::MakeListenerToken()
@@ -166,6 +283,20 @@ ListenerToken ServiceListeners::AddBundleListener(
   US_UNUSED(l);
   auto& listeners = bundleListenerMap.value[context];
   listeners[token.Id()] = std::make_tuple(listener, data);
+  bundleListenerMap.snapshot.reset();
+  return token;
+}
+
+ListenerToken ServiceListeners::AddBundleEventsListener(
+  const std::shared_ptr<BundleContextPrivate>& context,
+  const BundleEventsListener& listener)
+{
+  auto token = MakeListenerToken();
+
+  auto l = bundleEventsListenerMap.Lock();
+  US_UNUSED(l);
+  bundleEventsListenerMap.value[context][token.Id()] = listener;
+  bundleEventsListenerMap.snapshot.reset();
   return token;
 }
 
@@ -200,6 +331,7 @@ void ServiceListeners::RemoveBundleListener(
                                    std::placeholders::_1));
   if (it != listeners.end()) {
     listeners.erase(it);
+    bundleListenerMap.snapshot.reset();
   }
 }
 
@@ -214,6 +346,7 @@ ListenerToken ServiceListeners::AddFrameworkListener(
   US_UNUSED(l);
   auto& listeners = frameworkListenerMap.value[context];
   listeners[token.Id()] = std::make_tuple(listener, data);
+  frameworkListenerMap.snapshot.reset();
   return token;
 }
 
@@ -248,6 +381,7 @@ void ServiceListeners::RemoveFrameworkListener(
                                    std::placeholders::_1));
   if (it != listeners.end()) {
     listeners.erase(it);
+    frameworkListenerMap.snapshot.reset();
   }
 }
 
@@ -260,7 +394,11 @@ static bool RemoveListenerEntry(
   auto l = listenerMap.Lock();
   US_UNUSED(l);
   auto& listeners = listenerMap.value[context];
-  return (listeners.erase(tokenId) != 0);
+  if (listeners.erase(tokenId) == 0) {
+    return false;
+  }
+  listenerMap.snapshot.reset();
+  return true;
 }
 
 void ServiceListeners::RemoveListener(
@@ -272,26 +410,24 @@ void ServiceListeners::RemoveListener(
   }
 
   auto tokenId = token.Id();
-  // invoke RemoveServiceListener only if the other two RemoveListener functions return false.
+  // invoke RemoveServiceListener only if the other RemoveListener functions return false.
   if (!(RemoveListenerEntry(context, tokenId, frameworkListenerMap) ||
-        RemoveListenerEntry(context, tokenId, bundleListenerMap))) {
+        RemoveListenerEntry(context, tokenId, bundleListenerMap) ||
+        RemoveListenerEntry(context, tokenId, bundleEventsListenerMap))) {
     RemoveServiceListener(context, tokenId, {}, nullptr);
   }
 }
 
 void ServiceListeners::SendFrameworkEvent(const FrameworkEvent& evt)
 {
+  const auto start = std::chrono::steady_clock::now();
+
   // avoid deadlocks, race conditions and other undefined behavior
   // by using a local snapshot of all listeners.
   // A lock shouldn't be held while calling into user code (e.g. callbacks).
-  FrameworkListenerMap listener_snapshot;
-  {
-    auto l = frameworkListenerMap.Lock();
-    US_UNUSED(l);
-    listener_snapshot = frameworkListenerMap.value;
-  }
+  auto listener_snapshot = GetSnapshot(frameworkListenerMap);
 
-  for (auto& listeners : listener_snapshot) {
+  for (auto& listeners : *listener_snapshot) {
     for (auto& listener : listeners.second) {
       try {
         std::get<0>(listener.second)(evt);
@@ -304,14 +440,39 @@ void ServiceListeners::SendFrameworkEvent(const FrameworkEvent& evt)
       }
     }
   }
+
+  ++frameworkEventCount;
+  frameworkEventDispatchTime += ElapsedNanos(start);
 }
 
 void ServiceListeners::BundleChanged(const BundleEvent& evt)
 {
-  BundleListenerMap filteredBundleListeners;
-  coreCtx->bundleHooks.FilterBundleEventReceivers(evt, filteredBundleListeners);
+  const auto start = std::chrono::steady_clock::now();
+
+  auto filteredBundleListeners = GetSnapshot(bundleListenerMap);
+  auto filteredEventsListeners = GetSnapshot(bundleEventsListenerMap);
+  coreCtx->bundleHooks.FilterBundleEventReceivers(
+    evt, filteredBundleListeners, filteredEventsListeners);
 
-  for (auto& bundleListeners : filteredBundleListeners) {
+  // The bundle events listeners get the event in a batch of its own
+  // after the bundle listeners, unless a BundleEventBatch holds it back
+  bool deferred = false;
+  if (!filteredEventsListeners->empty()) {
+    auto l = bundleEventBatches.Lock();
+    US_UNUSED(l);
+    auto iter = bundleEventBatches.threads.find(std::this_thread::get_id());
+    if (iter != bundleEventBatches.threads.end()) {
+      deferred = true;
+      auto& events = iter->second->events;
+      for (auto& eventsListeners : *filteredEventsListeners) {
+        for (auto& eventsListener : eventsListeners.second) {
+          events[eventsListener.first].push_back(evt);
+        }
+      }
+    }
+  }
+
+  for (auto& bundleListeners : *filteredBundleListeners) {
     for (auto& bundleListener : bundleListeners.second) {
       auto bundle_ = bundleListeners.first->bundle.lock();
       try {
@@ -339,6 +500,119 @@ void ServiceListeners::BundleChanged(const BundleEvent& evt)
       }
     }
   }
+
+  if (!deferred && !filteredEventsListeners->empty()) {
+    const std::vector<BundleEvent> batch{ evt };
+    for (auto& eventsListeners : *filteredEventsListeners) {
+      for (auto& eventsListener : eventsListeners.second) {
+        CallBundleEventsListener(
+          eventsListeners.first, eventsListener.second, batch);
+      }
+    }
+  }
+
+  ++bundleEventCount;
+  bundleEventDispatchTime += ElapsedNanos(start);
+}
+
+void ServiceListeners::DeliverBundleEvents(
+  std::unordered_map<ListenerTokenId, std::vector<BundleEvent>>& batches)
+{
+  // Listeners removed since the events occurred are skipped
+  auto listener_snapshot = GetSnapshot(bundleEventsListenerMap);
+  for (auto& eventsListeners : *listener_snapshot) {
+    for (auto& eventsListener : eventsListeners.second) {
+      auto batch = batches.find(eventsListener.first);
+      if (batch != batches.end()) {
+        CallBundleEventsListener(
+          eventsListeners.first, eventsListener.second, batch->second);
+      }
+    }
+  }
+}
+
+void ServiceListeners::CallBundleEventsListener(
+  const std::shared_ptr<BundleContextPrivate>& context,
+  const BundleEventsListener& listener,
+  const std::vector<BundleEvent>& events)
+{
+  try {
+    listener(events);
+  } catch (...) {
+    SendFrameworkEvent(FrameworkEvent(
+      FrameworkEvent::Type::FRAMEWORK_ERROR,
+      MakeBundle(context->bundle.lock()),
+      std::string("Bundle events listener threw an exception"),
+      std::current_exception()));
+  }
+}
+
+ServiceListeners::BundleEventBatch::BundleEventBatch(
+  ServiceListeners& listeners)
+  : listeners(listeners)
+{
+  Attach(this);
+}
+
+ServiceListeners::BundleEventBatch::BundleEventBatch(
+  ServiceListeners& listeners,
+  BundleEventBatch& other)
+  : listeners(listeners)
+{
+  Attach(other.owner);
+}
+
+void ServiceListeners::BundleEventBatch::Attach(BundleEventBatch* batch)
+{
+  auto l = listeners.bundleEventBatches.Lock();
+  US_UNUSED(l);
+  auto& current =
+    listeners.bundleEventBatches.threads[std::this_thread::get_id()];
+  attached = !current;
+  if (attached) {
+    current = batch;
+  }
+  owner = current;
+}
+
+ServiceListeners::BundleEventBatch::~BundleEventBatch()
+{
+  std::unordered_map<ListenerTokenId, std::vector<BundleEvent>> batches;
+  {
+    auto l = listeners.bundleEventBatches.Lock();
+    US_UNUSED(l);
+    auto& threads = listeners.bundleEventBatches.threads;
+    if (attached) {
+      threads.erase(std::this_thread::get_id());
+    }
+    if (owner == this) {
+      // threads which joined this batch and are still around let their
+      // events through from now on
+      for (auto iter = threads.begin(); iter != threads.end();) {
+        iter = iter->second == this ? threads.erase(iter) : std::next(iter);
+      }
+      batches.swap(events);
+    }
+  }
+  if (!batches.empty()) {
+    const auto start = std::chrono::steady_clock::now();
+    listeners.DeliverBundleEvents(batches);
+    listeners.bundleEventDispatchTime += ElapsedNanos(start);
+  }
+}
+
+ServiceListeners::EventStatistics ServiceListeners::GetBundleEventStatistics()
+  const
+{
+  return { bundleEventCount.load(),
+           std::chrono::nanoseconds(bundleEventDispatchTime.load()) };
+}
+
+ServiceListeners::EventStatistics
+ServiceListeners::GetFrameworkEventStatistics() const
+{
+  return { frameworkEventCount.load(),
+           std::chrono::nanoseconds(frameworkEventDispatchTime.load()) };
 }
 
 void ServiceListeners::RemoveAllListeners(
@@ -348,7 +622,8 @@ void ServiceListeners::RemoveAllListeners(
     auto l = this->Lock();
     US_UNUSED(l);
     for (auto it = serviceSet.begin(); it != serviceSet.end();) {
-      if (GetPrivate(it->GetBundleContext()) == context) {
+      if (it->GetBundleContextPrivate() == context) {
+        it->SetRemoved(true);
         RemoveFromCache_unlocked(*it);
         serviceSet.erase(it++);
       } else {
@@ -361,12 +636,28 @@ void ServiceListeners::RemoveAllListeners(
     auto l = bundleListenerMap.Lock();
     US_UNUSED(l);
     bundleListenerMap.value.erase(context);
+    bundleListenerMap.snapshot.reset();
+  }
+
+  {
+    auto l = bundleEventsListenerMap.Lock();
+    US_UNUSED(l);
+    bundleEventsListenerMap.value.erase(context);
+    bundleEventsListenerMap.snapshot.reset();
   }
 
   {
     auto l = frameworkListenerMap.Lock();
     US_UNUSED(l);
     frameworkListenerMap.value.erase(context);
+    frameworkListenerMap.snapshot.reset();
+  }
+
+  // Wait for the service listeners of the bundle which are being called
+  // asynchronously, the bundle's code may be unloaded next
+  auto executor = (serviceEventExecutor.Lock(), serviceEventExecutor.value);
+  if (executor) {
+    executor->Flush(context.get());
   }
 }
 
@@ -397,28 +688,50 @@ void ServiceListeners::ServiceChanged(ServiceListenerEntries& receivers,
                                       const ServiceEvent& evt,
                                       ServiceListenerEntries& matchBefore)
 {
-  int n = 0;
-
   if (!matchBefore.empty()) {
     for (auto& l : receivers) {
       matchBefore.erase(l);
     }
   }
 
+  auto executor = (serviceEventExecutor.Lock(), serviceEventExecutor.value);
+  if (!executor) {
+    for (auto const& l : receivers) {
+      DeliverServiceEvent(l, evt);
+    }
+    return;
+  }
+
+  // One task per bundle, queued after the bundle's earlier events, keeps
+  // the events of every listener in order
+  std::unordered_map<const void*, std::vector<ServiceListenerEntry>> byBundle;
   for (auto const& l : receivers) {
-    if (!l.IsRemoved()) {
-      try {
-        ++n;
-        l.CallDelegate(evt);
-      } catch (...) {
-        std::string message("Service listener in " +
-                            l.GetBundleContext().GetBundle().GetSymbolicName() +
-                            " threw an exception!");
-        SendFrameworkEvent(FrameworkEvent(FrameworkEvent::Type::FRAMEWORK_ERROR,
-                                          l.GetBundleContext().GetBundle(),
-                                          message,
-                                          std::current_exception()));
-      }
+    byBundle[l.GetBundleContextPrivate().get()].push_back(l);
+  }
+  for (auto& entries : byBundle) {
+    executor->Post(entries.first,
+                   [this, evt, receivers = std::move(entries.second)] {
+                     for (auto const& l : receivers) {
+                       DeliverServiceEvent(l, evt);
+                     }
+                   });
+  }
+}
+
+void ServiceListeners::DeliverServiceEvent(const ServiceListenerEntry& l,
+                                           const ServiceEvent& evt)
+{
+  if (!l.IsRemoved()) {
+    try {
+      l.CallDelegate(evt);
+    } catch (...) {
+      std::string message("Service listener in " +
+                          l.GetBundleContext().GetBundle().GetSymbolicName() +
+                          " threw an exception!");
+      SendFrameworkEvent(FrameworkEvent(FrameworkEvent::Type::FRAMEWORK_ERROR,
+                                        l.GetBundleContext().GetBundle(),
+                                        message,
+                                        std::current_exception()));
     }
   }
 }
@@ -426,43 +739,178 @@ void ServiceListeners::ServiceChanged(ServiceListenerEntries& receivers,
 void ServiceListeners::GetMatchingServiceListeners(const ServiceEvent& evt,
                                                    ServiceListenerEntries& set)
 {
-  // Filter the original set of listeners
-  ServiceListenerEntries receivers = (this->Lock(), serviceSet);
-  // This must not be called with any locks held
-  coreCtx->serviceHooks.FilterServiceEventReceivers(evt, receivers);
+  // Only event listener hooks need a copy of the listeners to filter,
+  // otherwise all listeners are matched in place.
+  ServiceListenerEntries receivers;
+  const bool filter = coreCtx->serviceHooks.HasServiceEventListenerHooks();
+  if (filter) {
+    receivers = (this->Lock(), serviceSet);
+    // This must not be called with any locks held
+    coreCtx->serviceHooks.FilterServiceEventReceivers(evt, receivers);
+  }
 
   // Get a copy of the service reference and keep it until we are
   // done with its properties.
   auto ref = evt.GetServiceReference();
   auto props = ref.d.load()->GetProperties();
 
-  {
+  auto l = this->Lock();
+  US_UNUSED(l);
+  AddMatching_unlocked(props, filter ? &receivers : nullptr, set);
+}
+
+void ServiceListeners::GetMatchingServiceListeners(
+  const std::vector<ServiceEvent>& evts,
+  std::vector<ServiceListenerEntries>& sets)
+{
+  sets.resize(evts.size());
+
+  // Event listener hooks may filter each event differently, so only
+  // then does every event need its own copy of the listeners.
+  const bool filter = coreCtx->serviceHooks.HasServiceEventListenerHooks();
+  ServiceListenerEntries all;
+  ServiceListenerEntries filtered;
+  if (filter) {
+    all = (this->Lock(), serviceSet);
+  }
+  for (std::size_t i = 0; i < evts.size(); ++i) {
+    const ServiceListenerEntries* receivers = nullptr;
+    if (filter) {
+      filtered = all;
+      // This must not be called with any locks held
+      coreCtx->serviceHooks.FilterServiceEventReceivers(evts[i], filtered);
+      receivers = &filtered;
+    }
+
+    auto ref = evts[i].GetServiceReference();
+    auto props = ref.d.load()->GetProperties();
+
     auto l = this->Lock();
     US_UNUSED(l);
-    // Check complicated or empty listener filters
-    for (auto& sse : complicatedListeners) {
-      if (receivers.count(sse) == 0)
-        continue;
-      const LDAPExpr& ldapExpr = sse.GetLDAPExpr();
-      if (ldapExpr.IsNull() || ldapExpr.Evaluate(props, false)) {
-        set.insert(sse);
-      }
+    AddMatching_unlocked(props, receivers, sets[i]);
+  }
+}
+
+bool ServiceListeners::GetMatchingServiceListeners(
+  const ServiceEvent& evt,
+  const LDAPExpr::StringList& keys,
+  ServiceListenerEntries& set,
+  std::vector<ServiceListenerEntry>& dependents)
+{
+  // Hooks may filter the receivers of each event differently, so the
+  // receivers of one event cannot be derived from those of another.
+  if (coreCtx->serviceHooks.HasServiceEventListenerHooks()) {
+    GetMatchingServiceListeners(evt, set);
+    return false;
+  }
+
+  auto ref = evt.GetServiceReference();
+  auto props = ref.d.load()->GetProperties();
+
+  auto l = this->Lock();
+  US_UNUSED(l);
+  AddMatching_unlocked(props, nullptr, set);
+  for (auto key : keys) {
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) {
+      return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    auto it = attributeListeners.find(key);
+    if (it != attributeListeners.end()) {
+      dependents.insert(
+        dependents.end(), it->second.begin(), it->second.end());
     }
+  }
+  return true;
+}
+
+void ServiceListeners::GetMatchingServiceListeners(
+  const ServiceEvent& evt,
+  const ServiceListenerEntries& matchBefore,
+  const std::vector<ServiceListenerEntry>& dependents,
+  ServiceListenerEntries& set)
+{
+  // Hooks registered since matchBefore was computed must see the event
+  if (coreCtx->serviceHooks.HasServiceEventListenerHooks()) {
+    GetMatchingServiceListeners(evt, set);
+    return;
+  }
 
-    // Check the cache
-    const auto c = any_cast<std::vector<std::string>>(
-      props->Value_unlocked(Constants::OBJECTCLASS));
-    for (auto& objClass : c) {
-      AddToSet_unlocked(set, receivers, OBJECTCLASS_IX, objClass);
+  set = matchBefore;
+  if (dependents.empty()) {
+    return;
+  }
+
+  auto ref = evt.GetServiceReference();
+  auto props = ref.d.load()->GetProperties();
+
+  // Filters which do not test a changed key evaluate as before, also if
+  // the listener is cached under a changed key. A listener testing
+  // several changed keys is evaluated repeatedly.
+  for (auto& sse : dependents) {
+    if (sse.GetLDAPExpr().Evaluate(props, false)) {
+      set.insert(sse);
+    } else {
+      set.erase(sse);
+    }
+  }
+}
+
+void ServiceListeners::AddMatching_unlocked(
+  const PropertiesHandle& props,
+  const ServiceListenerEntries* receivers,
+  ServiceListenerEntries& set)
+{
+  // Check complicated or empty listener filters
+  for (auto& sse : complicatedListeners) {
+    if (receivers && receivers->count(sse) == 0)
+      continue;
+    const LDAPExpr& ldapExpr = sse.GetLDAPExpr();
+    if (ldapExpr.IsNull() || ldapExpr.Evaluate(props, false)) {
+      set.insert(sse);
+    }
+  }
+
+  // Check the listeners cached under the values of a property
+  for (auto& keyed : equalityCache) {
+    const Any& value = props->ValueRef_unlocked(keyed.first);
+    if (value.Empty()) {
+      continue;
+    }
+    const auto& type = value.Type();
+    if (type == typeid(std::string)) {
+      auto it = keyed.second.find(ref_any_cast<std::string>(value));
+      if (it != keyed.second.end()) {
+        AddMatchingCandidates_unlocked(props, receivers, it->second, set);
+      }
+    } else if (type == typeid(std::vector<std::string>)) {
+      for (auto& v : ref_any_cast<std::vector<std::string>>(value)) {
+        auto it = keyed.second.find(v);
+        if (it != keyed.second.end()) {
+          AddMatchingCandidates_unlocked(props, receivers, it->second, set);
+        }
+      }
+    } else {
+      // other types may compare equal to differently spelled values
+      for (auto& candidates : keyed.second) {
+        AddMatchingCandidates_unlocked(
+          props, receivers, candidates.second, set);
+      }
     }
+  }
 
-    auto service_id =
-      any_cast<long>(props->Value_unlocked(Constants::SERVICE_ID));
-    AddToSet_unlocked(set,
-                      receivers,
-                      SERVICE_ID_IX,
-                      cppmicroservices::util::ToString((service_id)));
+  // Check the cache
+  const auto& c = ref_any_cast<std::vector<std::string>>(
+    props->ValueRef_unlocked(Constants::OBJECTCLASS));
+  for (auto& objClass : c) {
+    AddToSet_unlocked(set, receivers, OBJECTCLASS_IX, objClass);
   }
+
+  auto service_id =
+    any_cast<long>(props->ValueRef_unlocked(Constants::SERVICE_ID));
+  AddToSet_unlocked(set,
+                    receivers,
+                    SERVICE_ID_IX,
+                    cppmicroservices::util::ToString((service_id)));
 }
 
 std::vector<ServiceListenerHook::ListenerInfo>
@@ -480,6 +928,7 @@ ServiceListeners::GetListenerInfoCollection() const
 
 void ServiceListeners::RemoveFromCache_unlocked(const ServiceListenerEntry& sle)
 {
+  RemoveFromAttributeIndex_unlocked(sle);
   if (!sle.GetLocalCache().empty()) {
     for (std::size_t i = 0; i < hashedServiceKeys.size(); ++i) {
       CacheType& keymap = cache[i];
@@ -492,13 +941,14 @@ void ServiceListeners::RemoveFromCache_unlocked(const ServiceListenerEntry& sle)
         }
       }
     }
-  } else {
+  } else if (!RemoveFromEqualityCache_unlocked(sle)) {
     complicatedListeners.remove(sle);
   }
 }
 
 void ServiceListeners::CheckSimple_unlocked(const ServiceListenerEntry& sle)
 {
+  AddToAttributeIndex_unlocked(sle);
   if (sle.GetLDAPExpr().IsNull()) {
     complicatedListeners.push_back(sle);
   } else {
@@ -514,24 +964,114 @@ void ServiceListeners::CheckSimple_unlocked(const ServiceListenerEntry& sle)
           sles.insert(sle);
         }
       }
-    } else {
+    } else if (!AddToEqualityCache_unlocked(sle)) {
       complicatedListeners.push_back(sle);
     }
   }
 }
 
+void ServiceListeners::AddToAttributeIndex_unlocked(
+  const ServiceListenerEntry& sle)
+{
+  if (sle.GetLDAPExpr().IsNull()) {
+    return;
+  }
+  LDAPExpr::ObjectClassSet attrNames;
+  sle.GetLDAPExpr().GetAttributeNames(attrNames);
+  for (const auto& attrName : attrNames) {
+    attributeListeners[attrName].insert(sle);
+  }
+}
+
+void ServiceListeners::RemoveFromAttributeIndex_unlocked(
+  const ServiceListenerEntry& sle)
+{
+  if (sle.GetLDAPExpr().IsNull()) {
+    return;
+  }
+  LDAPExpr::ObjectClassSet attrNames;
+  sle.GetLDAPExpr().GetAttributeNames(attrNames);
+  for (const auto& attrName : attrNames) {
+    auto it = attributeListeners.find(attrName);
+    if (it != attributeListeners.end()) {
+      it->second.erase(sle);
+      if (it->second.empty()) {
+        attributeListeners.erase(it);
+      }
+    }
+  }
+}
+
+bool ServiceListeners::AddToEqualityCache_unlocked(
+  const ServiceListenerEntry& sle)
+{
+  std::string key;
+  LDAPExpr::StringList values;
+  if (!GetEqualityTerm(sle.GetLDAPExpr(), key, values)) {
+    return false;
+  }
+  CacheType& keymap = equalityCache[key];
+  for (auto& value : values) {
+    keymap[value].insert(sle);
+  }
+  return true;
+}
+
+bool ServiceListeners::RemoveFromEqualityCache_unlocked(
+  const ServiceListenerEntry& sle)
+{
+  std::string key;
+  LDAPExpr::StringList values;
+  if (sle.GetLDAPExpr().IsNull() ||
+      !GetEqualityTerm(sle.GetLDAPExpr(), key, values)) {
+    return false;
+  }
+  auto keymap = equalityCache.find(key);
+  if (keymap == equalityCache.end()) {
+    return true;
+  }
+  for (auto& value : values) {
+    auto sles = keymap->second.find(value);
+    if (sles != keymap->second.end()) {
+      sles->second.erase(sle);
+      if (sles->second.empty()) {
+        keymap->second.erase(sles);
+      }
+    }
+  }
+  if (keymap->second.empty()) {
+    equalityCache.erase(keymap);
+  }
+  return true;
+}
+
+void ServiceListeners::AddMatchingCandidates_unlocked(
+  const PropertiesHandle& props,
+  const ServiceListenerEntries* receivers,
+  const std::set<ServiceListenerEntry>& candidates,
+  ServiceListenerEntries& set)
+{
+  for (auto& sse : candidates) {
+    if (receivers && receivers->count(sse) == 0)
+      continue;
+    if (sse.GetLDAPExpr().Evaluate(props, false)) {
+      set.insert(sse);
+    }
+  }
+}
+
 void ServiceListeners::AddToSet_unlocked(
   ServiceListenerEntries& set,
-  const ServiceListenerEntries& receivers,
+  const ServiceListenerEntries* receivers,
   int cache_ix,
   const std::string& val)
 {
   const auto cacheItr = cache[cache_ix].find(val);
   if (cacheItr != cache[cache_ix].end()) {
-    std::set<ServiceListenerEntry>& l = cache[cache_ix][val];
+    const std::set<ServiceListenerEntry>& l = cacheItr->second;
     if (!l.empty()) {
       for (const ServiceListenerEntry& entry : l) {
-        if (receivers.count(entry)) {
+        if (!receivers || receivers->count(entry)) {
           set.insert(entry);
         }
       }
@@ -23,23 +23,31 @@
 #ifndef CPPMICROSERVICES_SERVICELISTENERS_H
 #define CPPMICROSERVICES_SERVICELISTENERS_H
 
+#include "cppmicroservices/BundleEvent.h"
 #include "cppmicroservices/GlobalConfig.h"
 #include "cppmicroservices/detail/Threads.h"
 
 #include "ServiceListenerEntry.h"
 
+#include <atomic>
+#include <chrono>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace cppmicroservices {
 
 class CoreBundleContext;
 class BundleContextPrivate;
+class PropertiesHandle;
+class SerialExecutor;
 
 /**
  * Here we handle all listeners that bundles have registered.
@@ -57,8 +65,26 @@ public:
   struct : public MultiThreaded<>
   {
     BundleListenerMap value;
+    /* A copy of value for dispatching, until value changes */
+    std::shared_ptr<const BundleListenerMap> snapshot;
   } bundleListenerMap;
 
+  using BundleEventsListenerMap = std::unordered_map<
+    std::shared_ptr<BundleContextPrivate>,
+    std::unordered_map<ListenerTokenId, BundleEventsListener>>;
+
+  /**
+   * The number of events dispatched to listeners and the total time
+   * the dispatching took, including the time spent in the listeners.
+   */
+  struct EventStatistics
+  {
+    uint64_t count;
+    std::chrono::nanoseconds dispatchTime;
+  };
+
+  class BundleEventBatch;
+
   using CacheType =
     std::unordered_map<std::string, std::set<ServiceListenerEntry>>;
   using ServiceListenerEntries = std::unordered_set<ServiceListenerEntry>;
@@ -74,8 +100,29 @@ private:
   struct : public MultiThreaded<>
   {
     FrameworkListenerMap value;
+    std::shared_ptr<const FrameworkListenerMap> snapshot;
   } frameworkListenerMap;
 
+  struct : public MultiThreaded<>
+  {
+    BundleEventsListenerMap value;
+    std::shared_ptr<const BundleEventsListenerMap> snapshot;
+  } bundleEventsListenerMap;
+
+  /*
+   * The outermost BundleEventBatch of each thread, which holds back the
+   * bundle events the thread causes.
+   */
+  struct : public MultiThreaded<>
+  {
+    std::unordered_map<std::thread::id, BundleEventBatch*> threads;
+  } bundleEventBatches;
+
+  std::atomic<uint64_t> bundleEventCount;
+  std::atomic<int64_t> bundleEventDispatchTime;
+  std::atomic<uint64_t> frameworkEventCount;
+  std::atomic<int64_t> frameworkEventDispatchTime;
+
   std::vector<std::string> hashedServiceKeys;
   static const int OBJECTCLASS_IX = 0;
   static const int SERVICE_ID_IX = 1;
@@ -83,11 +130,28 @@ private:
   /* Service listeners with complicated or empty filters */
   std::list<ServiceListenerEntry> complicatedListeners;
 
+  /* Listeners with a filter by the lower-cased attributes the filter tests */
+  CacheType attributeListeners;
+
   /* Service listeners with "simple" filters are cached. */
   CacheType cache[2];
 
+  /*
+   * Service listeners whose filter is not simple but requires a property
+   * to equal one of a few values, e.g. (&(objectclass=IFoo)(tenant=abc)).
+   * They are filed under the lower-cased property key and each value, and
+   * only the listeners filed under a value of the service are evaluated.
+   */
+  std::unordered_map<std::string, CacheType> equalityCache;
+
   ServiceListenerEntries serviceSet;
 
+  /* Delivers service events asynchronously, if enabled */
+  struct : public MultiThreaded<>
+  {
+    std::shared_ptr<SerialExecutor> value;
+  } serviceEventExecutor;
+
   CoreBundleContext* coreCtx;
 
 public:
@@ -95,6 +159,20 @@ public:
 
   void Clear();
 
+  /**
+   * Deliver service events on the given number of threads from now on.
+   * Each bundle receives its service events one at a time and in order.
+   *
+   * @param threads The number of threads, 0 for synchronous delivery.
+   */
+  void StartServiceEventDelivery(std::size_t threads);
+
+  /**
+   * Deliver the pending service events and deliver service events
+   * synchronously from now on.
+   */
+  void StopServiceEventDelivery();
+
   /**
    * Add a new service listener. If an old one exists, and it has the
    * same owning bundle, the old listener is removed first.
@@ -141,6 +219,17 @@ public:
     const BundleListener& listener,
     void* data);
 
+  /**
+   * Add a new bundle events listener.
+   *
+   * @param context The bundle context adding this listener.
+   * @param listener The bundle events listener to add.
+   * @returns a ListenerToken object that corresponds to the listener.
+   */
+  ListenerToken AddBundleEventsListener(
+    const std::shared_ptr<BundleContextPrivate>& context,
+    const BundleEventsListener& listener);
+
   /**
    * Remove bundle listener from current framework. If listener doesn't
    * exist, this method does nothing.
@@ -194,6 +283,47 @@ public:
 
   void BundleChanged(const BundleEvent& evt);
 
+  /**
+   * Holds back the bundle events caused by the calling thread for the
+   * bundle events listeners while an instance exists, and delivers them
+   * in one batch per listener when the thread's outermost instance is
+   * destroyed. Bundle listeners still receive each event when it occurs.
+   * Events caused by other threads are not held back.
+   */
+  class BundleEventBatch
+  {
+  public:
+    explicit BundleEventBatch(ServiceListeners& listeners);
+
+    /**
+     * Holds back the bundle events caused by the calling thread in the
+     * batch of another thread, which must outlive this instance.
+     */
+    BundleEventBatch(ServiceListeners& listeners, BundleEventBatch& other);
+
+    ~BundleEventBatch();
+
+    BundleEventBatch(const BundleEventBatch&) = delete;
+    BundleEventBatch& operator=(const BundleEventBatch&) = delete;
+
+  private:
+    friend class ServiceListeners;
+
+    void Attach(BundleEventBatch* batch);
+
+    ServiceListeners& listeners;
+
+    // The batch this thread's events go to, this one if outermost
+    BundleEventBatch* owner;
+    bool attached;
+
+    // The held back events per listener, in the order they occurred
+    std::unordered_map<ListenerTokenId, std::vector<BundleEvent>> events;
+  };
+
+  EventStatistics GetBundleEventStatistics() const;
+  EventStatistics GetFrameworkEventStatistics() const;
+
   /**
    * Remove all listener registered by a bundle in the current framework.
    *
@@ -227,6 +357,44 @@ public:
   void GetMatchingServiceListeners(const ServiceEvent& evt,
                                    ServiceListenerEntries& listeners);
 
+  /**
+   * Get the matching service listeners for a batch of events. The
+   * current listeners are read once for the whole batch, and
+   * <code>listeners[i]</code> receives the listeners matching
+   * <code>evts[i]</code>.
+   */
+  void GetMatchingServiceListeners(
+    const std::vector<ServiceEvent>& evts,
+    std::vector<ServiceListenerEntries>& listeners);
+
+  /**
+   * Get the matching service listeners for an event whose service is
+   * about to have only the property <code>keys</code> changed. The
+   * listeners whose filter tests one of the keys are additionally added
+   * to <code>dependents</code>.
+   *
+   * @return <code>false</code> if event listener hooks are registered,
+   *         in which case <code>dependents</code> is not filled and the
+   *         listeners must be matched again after the change.
+   */
+  bool GetMatchingServiceListeners(
+    const ServiceEvent& evt,
+    const LDAPExpr::StringList& keys,
+    ServiceListenerEntries& listeners,
+    std::vector<ServiceListenerEntry>& dependents);
+
+  /**
+   * Get the matching service listeners for an event after only the keys
+   * given to the overload above changed. Instead of matching all
+   * listeners, the listeners of <code>matchBefore</code> are taken over
+   * and only the <code>dependents</code> are evaluated again.
+   */
+  void GetMatchingServiceListeners(
+    const ServiceEvent& evt,
+    const ServiceListenerEntries& matchBefore,
+    const std::vector<ServiceListenerEntry>& dependents,
+    ServiceListenerEntries& listeners);
+
   std::vector<ServiceListenerHook::ListenerInfo> GetListenerInfoCollection()
     const;
 
@@ -237,6 +405,29 @@ private:
    */
   ListenerToken MakeListenerToken();
 
+  /**
+   * Calls the bundle events listeners which are still registered with
+   * their batches.
+   */
+  void DeliverBundleEvents(
+    std::unordered_map<ListenerTokenId, std::vector<BundleEvent>>& batches);
+
+  /**
+   * Calls a bundle events listener, reporting an exception thrown by it
+   * as a framework error.
+   */
+  void CallBundleEventsListener(
+    const std::shared_ptr<BundleContextPrivate>& context,
+    const BundleEventsListener& listener,
+    const std::vector<BundleEvent>& events);
+
+  /**
+   * Calls a service listener unless it was removed, and reports an
+   * exception thrown by it as a framework error.
+   */
+  void DeliverServiceEvent(const ServiceListenerEntry& sle,
+                           const ServiceEvent& evt);
+
   /**
    * Remove all references to a service listener from the service listener
    * cache.
@@ -249,8 +440,42 @@ private:
    */
   void CheckSimple_unlocked(const ServiceListenerEntry& sle);
 
+  /**
+   * Adds or removes a listener with a filter in attributeListeners.
+   */
+  void AddToAttributeIndex_unlocked(const ServiceListenerEntry& sle);
+  void RemoveFromAttributeIndex_unlocked(const ServiceListenerEntry& sle);
+
+  /**
+   * Adds or removes a listener in equalityCache.
+   *
+   * @return <code>false</code> if the listener's filter does not require
+   *         a property to equal one of a set of values.
+   */
+  bool AddToEqualityCache_unlocked(const ServiceListenerEntry& sle);
+  bool RemoveFromEqualityCache_unlocked(const ServiceListenerEntry& sle);
+
+  /**
+   * Adds the candidates whose filter matches the given service properties
+   * to set, see AddMatching_unlocked.
+   */
+  void AddMatchingCandidates_unlocked(
+    const PropertiesHandle& props,
+    const ServiceListenerEntries* receivers,
+    const std::set<ServiceListenerEntry>& candidates,
+    ServiceListenerEntries& set);
+
+  /**
+   * Adds the listeners whose filter matches the given service properties
+   * to set. Only listeners in receivers are considered, or all listeners
+   * if receivers is null.
+   */
+  void AddMatching_unlocked(const PropertiesHandle& props,
+                            const ServiceListenerEntries* receivers,
+                            ServiceListenerEntries& set);
+
   void AddToSet_unlocked(ServiceListenerEntries& set,
-                         const ServiceListenerEntries& receivers,
+                         const ServiceListenerEntries* receivers,
                          int cache_ix,
                          const std::string& val);
 
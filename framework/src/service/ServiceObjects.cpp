@@ -23,7 +23,6 @@
 #include "cppmicroservices/ServiceObjects.h"
 
 #include "cppmicroservices/Bundle.h"
-#include "cppmicroservices/Constants.h"
 #include "cppmicroservices/detail/Log.h"
 #include "cppmicroservices/util/Error.h"
 
@@ -53,9 +52,7 @@ public:
   {
     InterfaceMapConstPtr result;
 
-    bool isPrototypeScope =
-      m_reference.GetProperty(Constants::SERVICE_SCOPE).ToString() ==
-      Constants::SCOPE_PROTOTYPE;
+    bool isPrototypeScope = m_reference.d.load()->IsPrototypeScope();
 
     if (isPrototypeScope) {
       result = m_reference.d.load()->GetPrototypeService(
@@ -106,9 +103,7 @@ struct UngetHelper
     try {
       auto bundle = b.lock();
       if (sref) {
-        bool isPrototypeScope =
-          sref.GetProperty(Constants::SERVICE_SCOPE).ToString() ==
-          Constants::SCOPE_PROTOTYPE;
+        bool isPrototypeScope = sref.d.load()->IsPrototypeScope();
 
         if (isPrototypeScope) {
           sref.d.load()->UngetPrototypeService(bundle, interfaceMap);
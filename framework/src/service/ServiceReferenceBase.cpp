@@ -54,7 +54,13 @@ void ServiceReferenceBase::SetInterfaceId(const std::string& interfaceId)
     --d.load()->ref;
     d = new ServiceReferenceBasePrivate(d.load()->registration);
   }
-  d.load()->interfaceId = interfaceId;
+  d.load()->interfaceId = &detail::InternInterfaceId(interfaceId);
+}
+
+bool ServiceReferenceBase::HasInterfaceId(const std::string& interfaceId) const
+{
+  const std::string* id = d.load()->interfaceId;
+  return id == &interfaceId || *id == interfaceId;
 }
 
 ServiceReferenceBase::operator bool() const
@@ -139,41 +145,42 @@ bool ServiceReferenceBase::operator<(
     return false;
   }
 
-  Any anyR1;
-  Any anyId1;
+  int r1 = 0;
+  long int id1 = 0;
   {
     auto l = d.load()->registration->properties.Lock();
     US_UNUSED(l);
-    anyR1 = d.load()->registration->properties.Value_unlocked(
+    const Any& anyR1 = d.load()->registration->properties.ValueRef_unlocked(
       Constants::SERVICE_RANKING);
     assert(anyR1.Empty() || anyR1.Type() == typeid(int));
-    anyId1 =
-      d.load()->registration->properties.Value_unlocked(Constants::SERVICE_ID);
+    const Any& anyId1 = d.load()->registration->properties.ValueRef_unlocked(
+      Constants::SERVICE_ID);
     assert(anyId1.Type() == typeid(long int));
+    r1 = anyR1.Empty() ? 0 : *any_cast<int>(&anyR1);
+    id1 = *any_cast<long int>(&anyId1);
   }
 
-  Any anyR2;
-  Any anyId2;
+  int r2 = 0;
+  long int id2 = 0;
   {
     auto l = reference.d.load()->registration->properties.Lock();
     US_UNUSED(l);
-    anyR2 = reference.d.load()->registration->properties.Value_unlocked(
-      Constants::SERVICE_RANKING);
+    const Any& anyR2 =
+      reference.d.load()->registration->properties.ValueRef_unlocked(
+        Constants::SERVICE_RANKING);
     assert(anyR2.Empty() || anyR2.Type() == typeid(int));
-    anyId2 = reference.d.load()->registration->properties.Value_unlocked(
-      Constants::SERVICE_ID);
+    const Any& anyId2 =
+      reference.d.load()->registration->properties.ValueRef_unlocked(
+        Constants::SERVICE_ID);
     assert(anyId2.Type() == typeid(long int));
+    r2 = anyR2.Empty() ? 0 : *any_cast<int>(&anyR2);
+    id2 = *any_cast<long int>(&anyId2);
   }
 
-  const int r1 = anyR1.Empty() ? 0 : *any_cast<int>(&anyR1);
-  const int r2 = anyR2.Empty() ? 0 : *any_cast<int>(&anyR2);
-
   if (r1 != r2) {
     // use ranking if ranking differs
     return r1 < r2;
   } else {
-    const long int id1 = *any_cast<long int>(&anyId1);
-    const long int id2 = *any_cast<long int>(&anyId2);
 
     // otherwise compare using IDs,
     // is less than if it has a higher ID.
@@ -211,7 +218,7 @@ bool ServiceReferenceBase::IsConvertibleTo(const std::string& interfaceId) const
 
 std::string ServiceReferenceBase::GetInterfaceId() const
 {
-  return d.load()->interfaceId;
+  return *d.load()->interfaceId;
 }
 
 std::size_t ServiceReferenceBase::Hash() const
@@ -49,6 +49,7 @@ ServiceReferenceBasePrivate::ServiceReferenceBasePrivate(
   ServiceRegistrationBasePrivate* reg)
   : ref(1)
   , registration(reg)
+  , interfaceId(&us_service_interface_iid<void>())
 {
   if (registration)
     ++registration->ref;
@@ -86,8 +87,8 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceFromFactory(
     }
     std::vector<std::string> classes =
       (registration->properties.Lock(),
-       any_cast<std::vector<std::string>>(
-         registration->properties.Value_unlocked(Constants::OBJECTCLASS)));
+       ref_any_cast<std::vector<std::string>>(
+         registration->properties.ValueRef_unlocked(Constants::OBJECTCLASS)));
     for (auto clazz : classes) {
       if (smap->find(clazz) == smap->end() &&
           clazz != "org.cppmicroservices.factory") {
@@ -159,7 +160,15 @@ InterfaceMapConstPtr ServiceReferenceBasePrivate::GetPrototypeService(
 std::shared_ptr<void> ServiceReferenceBasePrivate::GetService(
   BundlePrivate* bundle)
 {
-  return ExtractInterface(GetServiceInterfaceMap(bundle), interfaceId);
+  auto s = GetServiceInterfaceMap(bundle);
+  if (s) {
+    // If this is not a service factory, s is the registered map and the
+    // interned id can be looked up without hashing it
+    if (auto service = registration->GetInterface(interfaceId)) {
+      return *service;
+    }
+  }
+  return ExtractInterface(s, *interfaceId);
 }
 
 InterfaceMapConstPtr ServiceReferenceBasePrivate::GetServiceInterfaceMap(
@@ -412,6 +421,14 @@ PropertiesHandle ServiceReferenceBasePrivate::GetProperties() const
   return PropertiesHandle(registration->properties, true);
 }
 
+bool ServiceReferenceBasePrivate::IsPrototypeScope() const
+{
+  auto props = GetProperties();
+  const Any& scope = props->ValueRef_unlocked(Constants::SERVICE_SCOPE);
+  return scope.Type() == typeid(std::string) &&
+         ref_any_cast<std::string>(scope) == Constants::SCOPE_PROTOTYPE;
+}
+
 bool ServiceReferenceBasePrivate::IsConvertibleTo(
   const std::string& interfaceId) const
 {
@@ -99,6 +99,13 @@ public:
    */
   PropertiesHandle GetProperties() const;
 
+  /**
+   * Checks the service scope property in place, without copying it.
+   *
+   * @return \c true if the service has prototype scope.
+   */
+  bool IsPrototypeScope() const;
+
   bool IsConvertibleTo(const std::string& interfaceId) const;
 
   /**
@@ -112,9 +119,10 @@ public:
   ServiceRegistrationBasePrivate* const registration;
 
   /**
-   * The service interface id for this reference.
+   * The service interface id for this reference, interned with
+   * detail::InternInterfaceId.
    */
-  std::string interfaceId;
+  const std::string* interfaceId;
 
 private:
   InterfaceMapConstPtr GetServiceFromFactory(
@@ -32,6 +32,8 @@
 #include "ServiceRegistrationBasePrivate.h"
 #include "ServiceRegistry.h"
 
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 
 US_MSVC_DISABLE_WARNING(
@@ -150,11 +152,11 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
     US_UNUSED(l2);
     auto propsCopy(props);
     propsCopy[Constants::SERVICE_ID] =
-      d->properties.Value_unlocked(Constants::SERVICE_ID);
-    objectClasses = d->properties.Value_unlocked(Constants::OBJECTCLASS);
+      d->properties.ValueRef_unlocked(Constants::SERVICE_ID);
+    objectClasses = d->properties.ValueRef_unlocked(Constants::OBJECTCLASS);
     propsCopy[Constants::OBJECTCLASS] = objectClasses;
     propsCopy[Constants::SERVICE_SCOPE] =
-      d->properties.Value_unlocked(Constants::SERVICE_SCOPE);
+      d->properties.ValueRef_unlocked(Constants::SERVICE_SCOPE);
 
     auto itr = propsCopy.find(Constants::SERVICE_RANKING);
     if (itr != propsCopy.end()) {
@@ -168,7 +170,8 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
       }
     }
 
-    auto oldRankAny = d->properties.Value_unlocked(Constants::SERVICE_RANKING);
+    const auto& oldRankAny =
+      d->properties.ValueRef_unlocked(Constants::SERVICE_RANKING);
     if (!oldRankAny.Empty()) {
       // since the old ranking is extracted from existing service properties
       // stored in the service registry, no need to type check before casting
@@ -177,11 +180,13 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
     d->properties = Properties(std::move(propsCopy));
   }
   if (old_rank != new_rank) {
-    auto classes = any_cast<std::vector<std::string>>(objectClasses);
     if (auto bundle = d->bundle.lock()) {
-      bundle->coreCtx->services.UpdateServiceRegistrationOrder(classes);
+      bundle->coreCtx->services.UpdateServiceRegistrationOrder(*this);
     }
   }
+  if (auto bundle = d->bundle.lock()) {
+    bundle->coreCtx->services.UpdatePropertyIndexes(*this);
+  }
 
   // Notify listeners, we must not hold any locks here
   ServiceListeners::ServiceListenerEntries matchingListeners;
@@ -194,6 +199,132 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
   }
 }
 
+void ServiceRegistrationBase::UpdateProperties(const ServiceProperties& patch)
+{
+  if (!d) {
+    throw std::logic_error("ServiceRegistrationBase object invalid");
+  }
+
+  const auto isKey = [](const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+             return std::tolower(static_cast<unsigned char>(x)) ==
+                    std::tolower(static_cast<unsigned char>(y));
+           });
+  };
+
+  // The keys to change, without the ones managed by the framework
+  LDAPExpr::StringList keys;
+  keys.reserve(patch.size());
+  int new_rank = 0;
+  bool rankChanged = false;
+  for (const auto& entry : patch) {
+    if (isKey(entry.first, Constants::SERVICE_ID) ||
+        isKey(entry.first, Constants::OBJECTCLASS) ||
+        isKey(entry.first, Constants::SERVICE_SCOPE)) {
+      continue;
+    }
+    for (const auto& key : keys) {
+      if (isKey(key, entry.first)) {
+        throw std::invalid_argument(
+          "Properties contain case variants of the key: " + entry.first);
+      }
+    }
+    if (isKey(entry.first, Constants::SERVICE_RANKING)) {
+      rankChanged = true;
+      if (!entry.second.Empty()) {
+        try {
+          new_rank = any_cast<int>(entry.second);
+        } catch (const BadAnyCastException& ex) {
+          std::string exMsg(
+            "SERVICE_RANKING property has unexpected value type. ");
+          exMsg.append(ex.what());
+          throw std::invalid_argument(exMsg);
+        }
+      }
+    }
+    keys.push_back(entry.first);
+  }
+
+  if (keys.empty()) {
+    return;
+  }
+
+  if (!d->available) {
+    throw std::logic_error("Service is unregistered");
+  }
+
+  ServiceEvent modifiedEndMatchEvent;
+  ServiceEvent modifiedEvent;
+  {
+    auto l = d->Lock();
+    US_UNUSED(l);
+    if (!d->available)
+      throw std::logic_error("Service is unregistered");
+    modifiedEndMatchEvent =
+      ServiceEvent(ServiceEvent::SERVICE_MODIFIED_ENDMATCH, d->reference);
+    modifiedEvent = ServiceEvent(ServiceEvent::SERVICE_MODIFIED, d->reference);
+  }
+
+  // This calls into service event listener hooks. We must not hold any locks here
+  ServiceListeners::ServiceListenerEntries before;
+  std::vector<ServiceListenerEntry> dependents;
+  bool incremental = false;
+  if (auto bundle = d->bundle.lock()) {
+    incremental = bundle->coreCtx->listeners.GetMatchingServiceListeners(
+      modifiedEndMatchEvent, keys, before, dependents);
+  }
+
+  int old_rank = 0;
+  {
+    auto l = d->Lock();
+    US_UNUSED(l);
+    if (!d->available) {
+      throw std::logic_error("Service is unregistered");
+    }
+
+    auto l2 = d->properties.Lock();
+    US_UNUSED(l2);
+    const auto& oldRankAny =
+      d->properties.ValueRef_unlocked(Constants::SERVICE_RANKING);
+    if (!oldRankAny.Empty()) {
+      old_rank = any_cast<int>(oldRankAny);
+    }
+
+    for (const auto& key : keys) {
+      const auto& value = patch.find(key)->second;
+      if (value.Empty()) {
+        d->properties.Remove_unlocked(key);
+      } else {
+        d->properties.Set_unlocked(key, value);
+      }
+    }
+  }
+  if (rankChanged && old_rank != new_rank) {
+    if (auto bundle = d->bundle.lock()) {
+      bundle->coreCtx->services.UpdateServiceRegistrationOrder(*this);
+    }
+  }
+  if (auto bundle = d->bundle.lock()) {
+    bundle->coreCtx->services.UpdatePropertyIndexes(*this);
+  }
+
+  // Notify listeners, we must not hold any locks here
+  ServiceListeners::ServiceListenerEntries matchingListeners;
+  if (auto bundle = d->bundle.lock()) {
+    if (incremental) {
+      bundle->coreCtx->listeners.GetMatchingServiceListeners(
+        modifiedEvent, before, dependents, matchingListeners);
+    } else {
+      bundle->coreCtx->listeners.GetMatchingServiceListeners(
+        modifiedEvent, matchingListeners);
+    }
+    bundle->coreCtx->listeners.ServiceChanged(
+      matchingListeners, modifiedEvent, before);
+    bundle->coreCtx->listeners.ServiceChanged(before, modifiedEndMatchEvent);
+  }
+}
+
 void ServiceRegistrationBase::Unregister()
 {
   if (!d) {
@@ -46,6 +46,12 @@ ServiceRegistrationBasePrivate::ServiceRegistrationBasePrivate(
 {
   // The reference counter is initialized to 0 because it will be
   // incremented by the "reference" member.
+  if (this->service &&
+      this->service->count("org.cppmicroservices.factory") == 0) {
+    for (auto& i : *this->service) {
+      interfaces.emplace_back(&detail::InternInterfaceId(i.first), &i.second);
+    }
+  }
 }
 
 ServiceRegistrationBasePrivate::~ServiceRegistrationBasePrivate()
@@ -78,6 +84,17 @@ std::shared_ptr<void> ServiceRegistrationBasePrivate::GetService_unlocked(
 {
   return ExtractInterface(service, interfaceId);
 }
+
+const std::shared_ptr<void>* ServiceRegistrationBasePrivate::GetInterface(
+  const std::string* interfaceId) const
+{
+  for (auto& i : interfaces) {
+    if (i.first == interfaceId) {
+      return i.second;
+    }
+  }
+  return nullptr;
+}
 }
 
 #ifdef _MSC_VER
@@ -30,6 +30,9 @@
 #include "Properties.h"
 
 #include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace cppmicroservices {
 
@@ -62,6 +65,15 @@ protected:
    */
   InterfaceMapConstPtr service;
 
+  /**
+   * The interfaces of a service which is not a ServiceFactory, keyed by
+   * interned interface id. Points into the map initially held by
+   * <code>service</code>, so it is only valid while holding that map.
+   * Never changes after construction.
+   */
+  std::vector<std::pair<const std::string*, const std::shared_ptr<void>*>>
+    interfaces;
+
 public:
   using BundleToRefsMap = std::unordered_map<BundlePrivate*, int>;
   using BundleToServiceMap =
@@ -138,6 +150,16 @@ public:
 
   std::shared_ptr<void> GetService_unlocked(
     const std::string& interfaceId) const;
+
+  /**
+   * Get the interface registered under an interned interface id, if
+   * this is not a ServiceFactory.
+   *
+   * @return The interface in the map initially held by
+   *         <code>service</code>, or <code>nullptr</code>.
+   */
+  const std::shared_ptr<void>* GetInterface(
+    const std::string* interfaceId) const;
 };
 }
 
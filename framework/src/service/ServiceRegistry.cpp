@@ -28,13 +28,64 @@
 #include "BundlePrivate.h"
 #include "CoreBundleContext.h"
 #include "ServiceRegistrationBasePrivate.h"
+#include "Utils.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <iterator>
 #include <stdexcept>
 
 namespace cppmicroservices {
 
+namespace {
+
+template<class F>
+void ForEachService(const std::vector<ServiceRegistrationBase>& services, F f)
+{
+  for (auto& sr : services) {
+    f(sr);
+  }
+}
+
+template<class Key, class F>
+void ForEachService(const std::map<Key, ServiceRegistrationBase>& services,
+                    F f)
+{
+  for (auto& entry : services) {
+    f(entry.second);
+  }
+}
+
+/**
+ * Get the string values a service property is indexed under. Returns
+ * false if the property value is not a string or a list of strings.
+ */
+bool GetIndexValues(const Any& value, std::vector<std::string>& values)
+{
+  const std::type_info& type = value.Type();
+  if (type == typeid(std::string)) {
+    values.push_back(ref_any_cast<std::string>(value));
+  } else if (type == typeid(std::vector<std::string>)) {
+    const auto& list = ref_any_cast<std::vector<std::string>>(value);
+    values.insert(values.end(), list.begin(), list.end());
+  } else if (type == typeid(std::list<std::string>)) {
+    const auto& list = ref_any_cast<std::list<std::string>>(value);
+    values.insert(values.end(), list.begin(), list.end());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool IsEnabled(const std::unordered_map<std::string, Any>& props,
+               const std::string& key)
+{
+  auto prop = props.find(key);
+  return prop != props.end() && any_cast<bool>(prop->second);
+}
+}
+
 void ServiceRegistry::Clear()
 {
   auto l = this->Lock();
@@ -42,6 +93,13 @@ void ServiceRegistry::Clear()
   services.clear();
   classServices.clear();
   serviceRegistrations.clear();
+  for (auto& index : propertyIndexes) {
+    index.second = PropertyIndex();
+  }
+  if (useSnapshots) {
+    nextSnapshot.reset();
+    snapshot.Store(std::make_shared<const Snapshot>());
+  }
 }
 
 Properties ServiceRegistry::CreateServiceProperties(
@@ -77,12 +135,28 @@ Properties ServiceRegistry::CreateServiceProperties(
 
 ServiceRegistry::ServiceRegistry(CoreBundleContext* coreCtx)
   : core(coreCtx)
-{}
+  , useSnapshots(IsEnabled(coreCtx->frameworkProperties,
+                           Constants::FRAMEWORK_SERVICE_SNAPSHOTS))
+{
+  auto indexProp = core->frameworkProperties.find(
+    Constants::FRAMEWORK_SERVICE_INDEX_PROPERTIES);
+  if (indexProp != core->frameworkProperties.end()) {
+    for (auto key :
+         ref_any_cast<std::vector<std::string>>(indexProp->second)) {
+      std::transform(key.begin(), key.end(), key.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      });
+      propertyIndexes[key];
+    }
+  }
+  Clear();
+}
 
-ServiceRegistrationBase ServiceRegistry::RegisterService(
+ServiceRegistrationBase ServiceRegistry::CreateRegistration(
   BundlePrivate* bundle,
   const InterfaceMapConstPtr& service,
-  const ServiceProperties& properties)
+  const ServiceProperties& properties,
+  ClassIds& classIds)
 {
   if (!service || service->empty()) {
     throw std::invalid_argument(
@@ -106,22 +180,50 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(
     }
     classes.push_back(i.first);
   }
+  for (auto& clazz : classes) {
+    classIds.push_back(&detail::InternInterfaceId(clazz));
+  }
 
-  ServiceRegistrationBase res(
+  return ServiceRegistrationBase(
     bundle,
     service,
     CreateServiceProperties(
       properties, classes, isFactory, isPrototypeFactory));
+}
+
+void ServiceRegistry::AddServiceRegistration_unlocked(
+  const ServiceRegistrationBase& sr,
+  const ClassIds& classes)
+{
+  auto key = GetRankKey(sr);
+  services.insert(std::make_pair(sr, ServiceEntry{ classes, key }));
+  serviceRegistrations.insert(std::make_pair(key.id, sr));
+  for (auto& clazz : classes) {
+    classServices[clazz].insert(std::make_pair(key, sr));
+  }
+  AddToPropertyIndexes_unlocked(sr, key);
+
+  if (useSnapshots) {
+    NextSnapshot_unlocked().serviceRegistrations.Insert(key.id, sr);
+    for (auto& clazz : classes) {
+      NextClassShard_unlocked(clazz)[clazz].Insert(key, sr);
+    }
+  }
+}
+
+ServiceRegistrationBase ServiceRegistry::RegisterService(
+  BundlePrivate* bundle,
+  const InterfaceMapConstPtr& service,
+  const ServiceProperties& properties)
+{
+  ClassIds classes;
+  ServiceRegistrationBase res =
+    CreateRegistration(bundle, service, properties, classes);
   {
     auto l = this->Lock();
     US_UNUSED(l);
-    services.insert(std::make_pair(res, classes));
-    serviceRegistrations.push_back(res);
-    for (auto& clazz : classes) {
-      auto& s = classServices[clazz];
-      auto ip = std::lower_bound(s.rbegin(), s.rend(), res);
-      s.insert(ip.base(), res);
-    }
+    AddServiceRegistration_unlocked(res, classes);
+    PublishSnapshot_unlocked();
   }
 
   ServiceReferenceBase r = res.GetReference(std::string());
@@ -133,38 +235,151 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(
   return res;
 }
 
+std::vector<ServiceRegistrationBase> ServiceRegistry::RegisterServices(
+  BundlePrivate* bundle,
+  const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+    services)
+{
+  std::vector<ServiceRegistrationBase> res;
+  std::vector<ClassIds> classes(services.size());
+  res.reserve(services.size());
+  for (std::size_t i = 0; i < services.size(); ++i) {
+    res.push_back(CreateRegistration(
+      bundle, services[i].first, services[i].second, classes[i]));
+  }
+
+  {
+    auto l = this->Lock();
+    US_UNUSED(l);
+    for (std::size_t i = 0; i < res.size(); ++i) {
+      AddServiceRegistration_unlocked(res[i], classes[i]);
+    }
+    PublishSnapshot_unlocked();
+  }
+
+  std::vector<ServiceEvent> registeredEvents;
+  registeredEvents.reserve(res.size());
+  for (auto& sr : res) {
+    registeredEvents.emplace_back(ServiceEvent::SERVICE_REGISTERED,
+                                  sr.GetReference(std::string()));
+  }
+  std::vector<ServiceListeners::ServiceListenerEntries> listeners;
+  bundle->coreCtx->listeners.GetMatchingServiceListeners(registeredEvents,
+                                                         listeners);
+  for (std::size_t i = 0; i < registeredEvents.size(); ++i) {
+    bundle->coreCtx->listeners.ServiceChanged(listeners[i],
+                                              registeredEvents[i]);
+  }
+  return res;
+}
+
 void ServiceRegistry::UpdateServiceRegistrationOrder(
-  const std::vector<std::string>& classes)
+  const ServiceRegistrationBase& sr)
 {
   auto l = this->Lock();
   US_UNUSED(l);
-  for (auto& clazz : classes) {
-    auto& s = classServices[clazz];
-    std::sort(s.rbegin(), s.rend());
+  auto entry = services.find(sr);
+  if (entry == services.end()) {
+    return;
   }
+  auto oldKey = entry->second.key;
+  auto key = GetRankKey(sr);
+  if (!(oldKey < key) && !(key < oldKey)) {
+    return;
+  }
+
+  // Move the map node itself, so that repositioning the service does
+  // not allocate or copy its registration
+  auto reorder = [&oldKey, &key](RankedServices& s) {
+    auto node = s.extract(oldKey);
+    if (!node.empty()) {
+      node.key() = key;
+      s.insert(std::move(node));
+    }
+  };
+  for (auto& clazz : entry->second.classes) {
+    reorder(classServices[clazz]);
+    if (useSnapshots) {
+      auto& services = NextClassShard_unlocked(clazz)[clazz];
+      services.Erase(oldKey);
+      services.Insert(key, sr);
+    }
+  }
+  for (auto& index : propertyIndexes) {
+    auto filed = index.second.filed.find(sr);
+    if (filed == index.second.filed.end()) {
+      reorder(index.second.unindexed);
+      continue;
+    }
+    for (auto& value : filed->second) {
+      auto byValue = index.second.byValue.find(value);
+      if (byValue != index.second.byValue.end()) {
+        reorder(byValue->second);
+      }
+    }
+  }
+  entry->second.key = key;
+  PublishSnapshot_unlocked();
+}
+
+void ServiceRegistry::UpdatePropertyIndexes(const ServiceRegistrationBase& sr)
+{
+  auto l = this->Lock();
+  US_UNUSED(l);
+  auto entry = services.find(sr);
+  if (propertyIndexes.empty() || entry == services.end()) {
+    return;
+  }
+  RemoveFromPropertyIndexes_unlocked(sr, entry->second.key);
+  AddToPropertyIndexes_unlocked(sr, entry->second.key);
 }
 
 void ServiceRegistry::Get(
   const std::string& clazz,
   std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
-  this->Lock(), Get_unlocked(clazz, serviceRegs);
+  if (useSnapshots) {
+    Get_unlocked(clazz, serviceRegs);
+  } else {
+    this->Lock(), Get_unlocked(clazz, serviceRegs);
+  }
 }
 
 void ServiceRegistry::Get_unlocked(
   const std::string& clazz,
   std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
-  auto i = classServices.find(clazz);
+  const std::string* id = detail::FindInterfaceId(clazz);
+  if (!id) {
+    return;
+  }
+
+  if (useSnapshots) {
+    auto snap = snapshot.Load();
+    if (auto services = snap->Find(id)) {
+      serviceRegs.clear();
+      services->ForEach(
+        [&serviceRegs](const ServiceRegistrationBase& sr) {
+          serviceRegs.push_back(sr);
+        });
+    }
+    return;
+  }
+
+  auto i = classServices.find(id);
   if (i != classServices.end()) {
-    serviceRegs = i->second;
+    serviceRegs.clear();
+    serviceRegs.reserve(i->second.size());
+    for (auto& entry : i->second) {
+      serviceRegs.push_back(entry.second);
+    }
   }
 }
 
 ServiceReferenceBase ServiceRegistry::Get(BundlePrivate* bundle,
                                           const std::string& clazz) const
 {
-  auto l = this->Lock();
+  auto l = useSnapshots ? UniqueLock() : this->Lock();
   US_UNUSED(l);
   try {
     std::vector<ServiceReferenceBase> srs;
@@ -187,7 +402,11 @@ void ServiceRegistry::Get(const std::string& clazz,
                           BundlePrivate* bundle,
                           std::vector<ServiceReferenceBase>& res) const
 {
-  this->Lock(), Get_unlocked(clazz, filter, bundle, res);
+  if (useSnapshots) {
+    Get_unlocked(clazz, filter, bundle, res);
+  } else {
+    this->Lock(), Get_unlocked(clazz, filter, bundle, res);
+  }
 }
 
 void ServiceRegistry::Get_unlocked(const std::string& clazz,
@@ -195,57 +414,75 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz,
                                    BundlePrivate* bundle,
                                    std::vector<ServiceReferenceBase>& res) const
 {
-  std::vector<ServiceRegistrationBase>::const_iterator s;
-  std::vector<ServiceRegistrationBase>::const_iterator send;
-  std::vector<ServiceRegistrationBase> v;
-  LDAPExpr ldap;
-  if (clazz.empty()) {
-    if (!filter.empty()) {
-      ldap = LDAPExpr(filter);
-      LDAPExpr::ObjectClassSet matched;
-      if (ldap.GetMatchedObjectClasses(matched)) {
-        v.clear();
-        for (auto& className : matched) {
-          auto i = classServices.find(className);
-          if (i != classServices.end()) {
-            std::copy(
-              i->second.begin(), i->second.end(), std::back_inserter(v));
-          }
-        }
-        if (!v.empty()) {
-          s = v.begin();
-          send = v.end();
-        } else {
-          return;
-        }
-      } else {
-        s = serviceRegistrations.begin();
-        send = serviceRegistrations.end();
-      }
-    } else {
-      s = serviceRegistrations.begin();
-      send = serviceRegistrations.end();
-    }
-  } else {
-    auto it = classServices.find(clazz);
-    if (it != classServices.end()) {
-      s = it->second.begin();
-      send = it->second.end();
-    } else {
+  // In snapshot mode the registry is not locked
+  std::shared_ptr<const Snapshot> snap;
+  if (useSnapshots) {
+    snap = snapshot.Load();
+  }
+
+  // Services are filed under interned class names, so a class name
+  // that was never interned has no services. A class without services
+  // returns before the filter is parsed.
+  const std::string* clazzId = nullptr;
+  if (!clazz.empty()) {
+    clazzId = detail::FindInterfaceId(clazz);
+    if (!clazzId || (snap ? !snap->Find(clazzId)
+                          : classServices.count(clazzId) == 0)) {
       return;
     }
-    if (!filter.empty()) {
-      ldap = LDAPExpr(filter);
+  }
+
+  // The property indexes are not part of the snapshot, a snapshot
+  // lookup evaluates the filter on all services of the class instead
+  std::vector<ServiceRegistrationBase> v;
+  LDAPExpr ldap;
+  bool useIndex = false;
+  if (!filter.empty()) {
+    ldap = LDAPExpr(filter);
+    if (!snap && !propertyIndexes.empty()) {
+      useIndex = GetIndexed_unlocked(clazz, ldap, v);
     }
   }
 
-  for (; s != send; ++s) {
-    ServiceReferenceBase sri = s->GetReference(clazz);
+  const std::string& interfaceId = clazzId ? *clazzId : clazz;
+  auto evaluate = [&interfaceId, &filter, &ldap, &res](
+                    const ServiceRegistrationBase& sr) {
+    ServiceReferenceBase sri = sr.GetReference(interfaceId);
 
     if (filter.empty() ||
-        ldap.Evaluate(PropertiesHandle(s->d->properties, true), false)) {
+        ldap.Evaluate(PropertiesHandle(sr.d->properties, true), false)) {
       res.push_back(sri);
     }
+  };
+  auto evaluateClass = [this, &snap, &evaluate](const std::string* className) {
+    if (!className) {
+      return;
+    }
+    if (snap) {
+      if (auto services = snap->Find(className)) {
+        services->ForEach(evaluate);
+      }
+    } else {
+      auto i = classServices.find(className);
+      if (i != classServices.end()) {
+        ForEachService(i->second, evaluate);
+      }
+    }
+  };
+
+  LDAPExpr::ObjectClassSet matched;
+  if (useIndex) {
+    ForEachService(v, evaluate);
+  } else if (clazzId) {
+    evaluateClass(clazzId);
+  } else if (!filter.empty() && ldap.GetMatchedObjectClasses(matched)) {
+    for (auto& className : matched) {
+      evaluateClass(detail::FindInterfaceId(className));
+    }
+  } else if (snap) {
+    snap->serviceRegistrations.ForEach(evaluate);
+  } else {
+    ForEachService(serviceRegistrations, evaluate);
   }
 
   if (!res.empty()) {
@@ -258,6 +495,187 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz,
   }
 }
 
+bool ServiceRegistry::GetIndexed_unlocked(
+  const std::string& clazz,
+  const LDAPExpr& ldap,
+  std::vector<ServiceRegistrationBase>& res) const
+{
+  // Pick the index with the fewest candidates if several keys are
+  // constrained, the lists it chose are read in place
+  std::vector<const RankedServices*> candidates;
+  std::size_t candidateCount = 0;
+  bool found = false;
+  for (auto& index : propertyIndexes) {
+    LDAPExpr::StringList values;
+    if (!ldap.GetMatchedValues(index.first, values)) {
+      continue;
+    }
+
+    std::vector<const RankedServices*> lists;
+    std::size_t count = 0;
+    auto addList = [&lists, &count](const RankedServices& list) {
+      if (!list.empty()) {
+        lists.push_back(&list);
+        count += list.size();
+      }
+    };
+    addList(index.second.unindexed);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    for (auto& value : values) {
+      auto it = index.second.byValue.find(value);
+      if (it != index.second.byValue.end()) {
+        addList(it->second);
+      }
+    }
+    if (!found || count < candidateCount) {
+      candidates.swap(lists);
+      candidateCount = count;
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  // Visit the candidates in ranking order, once each, although a service
+  // with a list of values is filed in several lists
+  auto forEachCandidate = [&candidates](auto f) {
+    using Iter = RankedServices::const_iterator;
+    std::vector<std::pair<Iter, Iter>> ranges;
+    for (auto list : candidates) {
+      ranges.emplace_back(list->begin(), list->end());
+    }
+    for (;;) {
+      const RankKey* next = nullptr;
+      for (auto& range : ranges) {
+        if (range.first != range.second &&
+            (!next || range.first->first < *next)) {
+          next = &range.first->first;
+        }
+      }
+      if (!next) {
+        return;
+      }
+      const auto key = *next;
+      bool visited = false;
+      for (auto& range : ranges) {
+        if (range.first != range.second && !(key < range.first->first)) {
+          if (!visited) {
+            f(*range.first);
+            visited = true;
+          }
+          ++range.first;
+        }
+      }
+    }
+  };
+
+  // Keep the candidates registered under className, in the order of
+  // classServices[className]. If that list is not longer than the
+  // candidates, it is cheaper to evaluate all of it.
+  auto copyIndexed = [this, &forEachCandidate, candidateCount, &res](
+                       const std::string* className) {
+    if (!className) {
+      return;
+    }
+    auto cls = classServices.find(className);
+    if (cls == classServices.end()) {
+      return;
+    }
+    const auto& classList = cls->second;
+    if (classList.size() <= candidateCount) {
+      for (auto& entry : classList) {
+        res.push_back(entry.second);
+      }
+      return;
+    }
+    forEachCandidate([&classList, &res](const RankedServices::value_type& e) {
+      if (classList.count(e.first) != 0) {
+        res.push_back(e.second);
+      }
+    });
+  };
+  LDAPExpr::ObjectClassSet matched;
+  if (!clazz.empty()) {
+    copyIndexed(detail::FindInterfaceId(clazz));
+  } else if (ldap.GetMatchedObjectClasses(matched)) {
+    for (auto& className : matched) {
+      copyIndexed(detail::FindInterfaceId(className));
+    }
+  } else {
+    res.reserve(candidateCount);
+    forEachCandidate([&res](const RankedServices::value_type& e) {
+      res.push_back(e.second);
+    });
+  }
+  return true;
+}
+
+void ServiceRegistry::AddToPropertyIndexes_unlocked(
+  const ServiceRegistrationBase& sr,
+  const RankKey& key)
+{
+  if (propertyIndexes.empty()) {
+    return;
+  }
+
+  auto l = sr.d->properties.Lock();
+  US_UNUSED(l);
+  for (auto& index : propertyIndexes) {
+    const Any& value = sr.d->properties.ValueRef_unlocked(index.first);
+    if (value.Empty()) {
+      continue;
+    }
+    std::vector<std::string> values;
+    if (!GetIndexValues(value, values)) {
+      index.second.unindexed.insert(std::make_pair(key, sr));
+      continue;
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    for (auto& v : values) {
+      index.second.byValue[v].insert(std::make_pair(key, sr));
+    }
+    index.second.filed.insert(std::make_pair(sr, std::move(values)));
+  }
+}
+
+void ServiceRegistry::RemoveFromPropertyIndexes_unlocked(
+  const ServiceRegistrationBase& sr,
+  const RankKey& key)
+{
+  for (auto& index : propertyIndexes) {
+    auto filed = index.second.filed.find(sr);
+    if (filed == index.second.filed.end()) {
+      index.second.unindexed.erase(key);
+      continue;
+    }
+    for (auto& value : filed->second) {
+      auto it = index.second.byValue.find(value);
+      if (it->second.size() > 1) {
+        it->second.erase(key);
+      } else {
+        index.second.byValue.erase(it);
+      }
+    }
+    index.second.filed.erase(filed);
+  }
+}
+
+ServiceRegistry::RankKey ServiceRegistry::GetRankKey(
+  const ServiceRegistrationBase& sr)
+{
+  auto l = sr.d->properties.Lock();
+  US_UNUSED(l);
+  const Any& ranking =
+    sr.d->properties.ValueRef_unlocked(Constants::SERVICE_RANKING);
+  const Any& id = sr.d->properties.ValueRef_unlocked(Constants::SERVICE_ID);
+  assert(id.Type() == typeid(long int));
+  const int* r = any_cast<int>(&ranking);
+  return RankKey{ r ? *r : 0, *any_cast<long int>(&id) };
+}
+
 void ServiceRegistry::RemoveServiceRegistration(
   const ServiceRegistrationBase& sr)
 {
@@ -269,27 +687,143 @@ void ServiceRegistry::RemoveServiceRegistration(
 void ServiceRegistry::RemoveServiceRegistration_unlocked(
   const ServiceRegistrationBase& sr)
 {
-  std::vector<std::string> classes;
-  {
-    auto l2 = sr.d->properties.Lock();
-    US_UNUSED(l2);
-    assert(sr.d->properties.Value_unlocked(Constants::OBJECTCLASS).Type() ==
-           typeid(std::vector<std::string>));
-    classes = ref_any_cast<std::vector<std::string>>(
-      sr.d->properties.Value_unlocked(Constants::OBJECTCLASS));
-  }
-  services.erase(sr);
-  serviceRegistrations.erase(
-    std::remove(serviceRegistrations.begin(), serviceRegistrations.end(), sr),
-    serviceRegistrations.end());
+  auto entry = services.find(sr);
+  if (entry == services.end()) {
+    return;
+  }
+  const auto key = entry->second.key;
+  const auto classes = std::move(entry->second.classes);
+  services.erase(entry);
+  serviceRegistrations.erase(key.id);
   for (auto& clazz : classes) {
-    auto& s = classServices[clazz];
-    if (s.size() > 1) {
-      s.erase(std::remove(s.begin(), s.end(), sr), s.end());
+    auto s = classServices.find(clazz);
+    if (s->second.size() > 1) {
+      s->second.erase(key);
     } else {
-      classServices.erase(clazz);
+      classServices.erase(s);
     }
   }
+  RemoveFromPropertyIndexes_unlocked(sr, key);
+
+  if (useSnapshots) {
+    NextSnapshot_unlocked().serviceRegistrations.Erase(key.id);
+    for (auto& clazz : classes) {
+      auto& shard = NextClassShard_unlocked(clazz);
+      auto s = shard.find(clazz);
+      s->second.Erase(key);
+      if (s->second.Empty()) {
+        shard.erase(s);
+      }
+    }
+  }
+  PublishSnapshot_unlocked();
+}
+
+ServiceRegistry::Snapshot& ServiceRegistry::NextSnapshot_unlocked()
+{
+  if (!nextSnapshot) {
+    nextSnapshot = std::make_shared<Snapshot>(*snapshot.Load());
+    ownedShards.fill(false);
+  }
+  return *nextSnapshot;
+}
+
+ServiceRegistry::Snapshot::ClassServices&
+ServiceRegistry::NextClassShard_unlocked(const std::string* clazz)
+{
+  auto& next = NextSnapshot_unlocked();
+  const auto i = Snapshot::Shard(clazz);
+  auto& shard = next.classServices[i];
+  if (!ownedShards[i]) {
+    shard = shard ? std::make_shared<Snapshot::ClassServices>(*shard)
+                  : std::make_shared<Snapshot::ClassServices>();
+    ownedShards[i] = true;
+  }
+  return *shard;
+}
+
+void ServiceRegistry::PublishSnapshot_unlocked()
+{
+  if (nextSnapshot) {
+    snapshot.Store(std::move(nextSnapshot));
+  }
+}
+
+std::size_t ServiceRegistry::Snapshot::Shard(const std::string* clazz)
+{
+  return std::hash<const std::string*>()(clazz) % ClassShards;
+}
+
+const ServiceRegistry::ServiceChunks<ServiceRegistry::RankKey>*
+ServiceRegistry::Snapshot::Find(const std::string* clazz) const
+{
+  auto& shard = classServices[Shard(clazz)];
+  if (!shard) {
+    return nullptr;
+  }
+  auto i = shard->find(clazz);
+  return i != shard->end() ? &i->second : nullptr;
+}
+
+template<class Key>
+void ServiceRegistry::ServiceChunks<Key>::Insert(
+  const Key& key,
+  const ServiceRegistrationBase& sr)
+{
+  auto byKey = [](const auto& entry, const Key& k) { return entry.first < k; };
+  // the first chunk whose last key is not less than the key, or the last
+  auto c = std::lower_bound(
+    chunks.begin(),
+    chunks.end(),
+    key,
+    [](const auto& chunk, const Key& k) { return chunk->back().first < k; });
+  if (c == chunks.end()) {
+    if (chunks.empty()) {
+      chunks.push_back(
+        std::make_shared<const Chunk>(1, std::make_pair(key, sr)));
+      return;
+    }
+    --c;
+  }
+  auto chunk = std::make_shared<Chunk>(**c);
+  chunk->insert(std::lower_bound(chunk->begin(), chunk->end(), key, byKey),
+                std::make_pair(key, sr));
+  if (chunk->size() <= MaxChunkSize) {
+    *c = std::move(chunk);
+    return;
+  }
+  // split a full chunk in halves
+  const auto half =
+    chunk->begin() + static_cast<std::ptrdiff_t>(chunk->size() / 2);
+  auto second = std::make_shared<const Chunk>(half, chunk->end());
+  chunk->erase(half, chunk->end());
+  *c = std::move(chunk);
+  chunks.insert(c + 1, std::move(second));
+}
+
+template<class Key>
+void ServiceRegistry::ServiceChunks<Key>::Erase(const Key& key)
+{
+  auto byKey = [](const auto& entry, const Key& k) { return entry.first < k; };
+  auto c = std::lower_bound(
+    chunks.begin(),
+    chunks.end(),
+    key,
+    [](const auto& chunk, const Key& k) { return chunk->back().first < k; });
+  if (c == chunks.end()) {
+    return;
+  }
+  auto e = std::lower_bound((*c)->begin(), (*c)->end(), key, byKey);
+  if (e == (*c)->end() || key < e->first) {
+    return;
+  }
+  if ((*c)->size() == 1) {
+    chunks.erase(c);
+    return;
+  }
+  auto chunk = std::make_shared<Chunk>(**c);
+  chunk->erase(chunk->begin() + std::distance((*c)->begin(), e));
+  *c = std::move(chunk);
 }
 
 void ServiceRegistry::GetRegisteredByBundle(
@@ -299,10 +833,10 @@ void ServiceRegistry::GetRegisteredByBundle(
   auto l = this->Lock();
   US_UNUSED(l);
 
-  for (auto& sr : serviceRegistrations) {
-    if (auto bundle_ = sr.d->bundle.lock()) {
+  for (auto& entry : serviceRegistrations) {
+    if (auto bundle_ = entry.second.d->bundle.lock()) {
       if (bundle_.get() == p) {
-        res.push_back(sr);
+        res.push_back(entry.second);
       }
     }
   }
@@ -315,9 +849,9 @@ void ServiceRegistry::GetUsedByBundle(
   auto l = this->Lock();
   US_UNUSED(l);
 
-  for (const auto& serviceRegistration : serviceRegistrations) {
-    if (serviceRegistration.d->IsUsedByBundle(bundle)) {
-      res.push_back(serviceRegistration);
+  for (const auto& entry : serviceRegistrations) {
+    if (entry.second.d->IsUsedByBundle(bundle)) {
+      res.push_back(entry.second);
     }
   }
 }
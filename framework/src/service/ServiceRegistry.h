@@ -27,10 +27,17 @@
 #include "cppmicroservices/ServiceRegistration.h"
 #include "cppmicroservices/detail/Threads.h"
 
+#include <array>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace cppmicroservices {
 
 class CoreBundleContext;
 class BundlePrivate;
+class LDAPExpr;
 class Properties;
 
 /**
@@ -58,22 +65,60 @@ public:
     bool isPrototypeFactory = false,
     long sid = -1);
 
+  /**
+   * The ranking and service id of a registered service, as of the last
+   * time it was (re)ordered. Orders the highest ranked service first,
+   * and services with equal ranking by ascending service id.
+   */
+  struct RankKey
+  {
+    int ranking;
+    long id;
+
+    bool operator<(const RankKey& o) const
+    {
+      return ranking != o.ranking ? ranking > o.ranking : id < o.id;
+    }
+  };
+
+  /**
+   * Registered services, ordered with the highest ranked service first.
+   */
+  using RankedServices = std::map<RankKey, ServiceRegistrationBase>;
+
+  /**
+   * Class names interned with detail::InternInterfaceId, which are
+   * compared and hashed by address.
+   */
+  using ClassIds = std::vector<const std::string*>;
+
+  struct ServiceEntry
+  {
+    ClassIds classes;
+    RankKey key;
+  };
+
   using MapServiceClasses =
     std::unordered_map<ServiceRegistrationBase, std::vector<std::string>>;
+  using MapServiceEntries =
+    std::unordered_map<ServiceRegistrationBase, ServiceEntry>;
   using MapClassServices =
-    std::unordered_map<std::string, std::vector<ServiceRegistrationBase>>;
+    std::unordered_map<const std::string*, RankedServices>;
 
   /**
    * All registered services in the current framework.
    * Mapping of registered service to class names under which
-   * the service is registerd.
+   * the service is registerd, and to its key in the ranked lists.
    */
-  MapServiceClasses services;
+  MapServiceEntries services;
 
-  std::vector<ServiceRegistrationBase> serviceRegistrations;
+  /**
+   * All registered services, ordered by service id.
+   */
+  std::map<long, ServiceRegistrationBase> serviceRegistrations;
 
   /**
-   * Mapping of classname to registered service.
+   * Mapping of interned classname to registered service.
    * The List of registered services are ordered with the highest
    * ranked service first.
    */
@@ -106,12 +151,39 @@ public:
                                           const ServiceProperties& properties);
 
   /**
-   * Reorder registered services. Call this method if the ranking for
+   * Register several services in the framework wide register.
+   *
+   * All services are added to the register while holding its lock once,
+   * and SERVICE_REGISTERED events are then delivered for them in the
+   * given order. Listeners therefore see every service of the batch as
+   * registered when receiving the first event. If one of the services is
+   * invalid, none of them is registered.
+   *
+   * @param bundle The bundle registering the services.
+   * @param services The service objects and their properties.
+   * @return The ServiceRegistration objects, in the given order.
+   * @exception std::invalid_argument See RegisterService.
+   */
+  std::vector<ServiceRegistrationBase> RegisterServices(
+    BundlePrivate* bundle,
+    const std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>>&
+      services);
+
+  /**
+   * Reorder a registered service. Call this method if the ranking for
    * a service registration has changed
    *
-   * @param classes is the list of classes whose entries need to be reordered
+   * @param sr The ServiceRegistration object whose ranking changed.
+   */
+  void UpdateServiceRegistrationOrder(const ServiceRegistrationBase& sr);
+
+  /**
+   * Re-file a service registration in the property indexes. Call this
+   * method if the properties of a service registration have changed.
+   *
+   * @param sr The ServiceRegistration object whose properties changed.
    */
-  void UpdateServiceRegistrationOrder(const std::vector<std::string>& classes);
+  void UpdatePropertyIndexes(const ServiceRegistrationBase& sr);
 
   /**
    * Get all services implementing a certain class.
@@ -177,8 +249,154 @@ private:
   friend class ServiceHooks;
   friend class ServiceRegistrationBase;
 
+  /**
+   * Secondary index over the values of one service property key.
+   * Every list is ordered with the highest ranked service first.
+   */
+  struct PropertyIndex
+  {
+    /**
+     * Mapping of string property value to registered services. Services
+     * with a list of strings are filed under each element.
+     */
+    std::unordered_map<std::string, RankedServices> byValue;
+
+    /**
+     * Services with a non-string value for the key, which can only
+     * be matched by evaluating the filter.
+     */
+    RankedServices unindexed;
+
+    /**
+     * Mapping of registered service to the values it is filed under,
+     * needed to remove it after its properties changed.
+     */
+    MapServiceClasses filed;
+  };
+
+  /**
+   * Mapping of lower-cased property key to its index, for the keys
+   * given by Constants::FRAMEWORK_SERVICE_INDEX_PROPERTIES.
+   */
+  std::unordered_map<std::string, PropertyIndex> propertyIndexes;
+
+  /**
+   * Services ordered by Key. The services are kept in chunks of bounded
+   * size which are never changed once shared, so that a changed copy
+   * shares all chunks but one with the original.
+   */
+  template<class Key>
+  class ServiceChunks
+  {
+  public:
+    void Insert(const Key& key, const ServiceRegistrationBase& sr);
+    void Erase(const Key& key);
+
+    bool Empty() const { return chunks.empty(); }
+
+    template<class F>
+    void ForEach(F f) const
+    {
+      for (auto& chunk : chunks) {
+        for (auto& entry : *chunk) {
+          f(entry.second);
+        }
+      }
+    }
+
+  private:
+    using Chunk = std::vector<std::pair<Key, ServiceRegistrationBase>>;
+
+    static constexpr std::size_t MaxChunkSize = 64;
+
+    std::vector<std::shared_ptr<const Chunk>> chunks;
+  };
+
+  /**
+   * Immutable copy of the lookup structures, published after every change
+   * if Constants::FRAMEWORK_SERVICE_SNAPSHOTS is set. Lookups read the
+   * current snapshot without locking the registry.
+   */
+  struct Snapshot
+  {
+    using ClassServices =
+      std::unordered_map<const std::string*, ServiceChunks<RankKey>>;
+
+    static constexpr std::size_t ClassShards = 64;
+
+    /* The services per class, split by class into shards, null if empty */
+    std::array<std::shared_ptr<ClassServices>, ClassShards> classServices;
+    ServiceChunks<long> serviceRegistrations;
+
+    static std::size_t Shard(const std::string* clazz);
+
+    const ServiceChunks<RankKey>* Find(const std::string* clazz) const;
+  };
+
+  const bool useSnapshots;
+  detail::Atomic<std::shared_ptr<const Snapshot>> snapshot;
+
+  /**
+   * The next snapshot, changed along with the registry until it is
+   * published, and which of its class shards are not shared with the
+   * current snapshot.
+   */
+  std::shared_ptr<Snapshot> nextSnapshot;
+  std::array<bool, Snapshot::ClassShards> ownedShards;
+
+  /**
+   * Get the next snapshot, a copy of the current one if there is none yet.
+   */
+  Snapshot& NextSnapshot_unlocked();
+
+  /**
+   * Get the class shard of the next snapshot the given class belongs to,
+   * copied first if it is shared with the current snapshot.
+   */
+  Snapshot::ClassServices& NextClassShard_unlocked(const std::string* clazz);
+
+  /**
+   * Publish the next snapshot, if the registry has changed since the
+   * current one was published.
+   */
+  void PublishSnapshot_unlocked();
+
+  static RankKey GetRankKey(const ServiceRegistrationBase& sr);
+
+  /**
+   * Validate a service and create its registration, without adding it
+   * to the register.
+   */
+  static ServiceRegistrationBase CreateRegistration(
+    BundlePrivate* bundle,
+    const InterfaceMapConstPtr& service,
+    const ServiceProperties& properties,
+    ClassIds& classes);
+
+  void AddServiceRegistration_unlocked(const ServiceRegistrationBase& sr,
+                                       const ClassIds& classes);
+
   void RemoveServiceRegistration_unlocked(const ServiceRegistrationBase& sr);
 
+  void AddToPropertyIndexes_unlocked(const ServiceRegistrationBase& sr,
+                                     const RankKey& key);
+
+  void RemoveFromPropertyIndexes_unlocked(const ServiceRegistrationBase& sr,
+                                          const RankKey& key);
+
+  /**
+   * Get the services of class <code>clazz</code>, or of the object classes
+   * matched by <code>ldap</code> if <code>clazz</code> is empty, which can
+   * match <code>ldap</code> according to the property indexes.
+   *
+   * @return <code>false</code> if no indexed property is constrained by
+   *         the filter and all services have to be evaluated.
+   */
+  bool GetIndexed_unlocked(
+    const std::string& clazz,
+    const LDAPExpr& ldap,
+    std::vector<ServiceRegistrationBase>& serviceRegs) const;
+
   void Get_unlocked(const std::string& clazz,
                     std::vector<ServiceRegistrationBase>& serviceRegs) const;
 
@@ -137,7 +137,9 @@ std::ostream& any_value_to_json(std::ostream& os,
 // header in order to avoid this error:
 // "default initialization of an object of const type 'const cppmicroservices::Any' without
 // a user-provided default constructor"
-Any::Any() = default;
+Any::Any()
+  : _content(nullptr)
+{}
 
 std::string Any::ToString() const
 {
@@ -26,13 +26,47 @@ limitations under the License.
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 
+#include "cppmicroservices/util/String.h"
+
 #include "BundleContextPrivate.h"
 #include "BundleStorage.h"
+#include "SerialExecutor.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 
 namespace cppmicroservices {
 
+namespace {
+
+// Returns the start level declared in the manifest of the bundle, see
+// Constants::BUNDLE_STARTLEVEL. An invalid value is reported as a framework
+// warning if warn is true and the default start level is used instead.
+int GetStartLevel(const std::shared_ptr<BundlePrivate>& b, bool warn)
+{
+  const auto& headers = b->GetHeaders();
+  auto iter = headers.find(Constants::BUNDLE_STARTLEVEL);
+  if (iter == headers.end()) {
+    return 1;
+  }
+  try {
+    return any_cast<int>(iter->second);
+  } catch (const BadAnyCastException& ex) {
+    if (warn) {
+      b->coreCtx->listeners.SendFrameworkEvent(FrameworkEvent(
+        FrameworkEvent::Type::FRAMEWORK_WARNING,
+        MakeBundle(b),
+        "Failed to read '" + Constants::BUNDLE_STARTLEVEL +
+          "' property. Expected type : int, Found type : " +
+          iter->second.Type().name(),
+        std::make_exception_ptr(ex)));
+    }
+    return 1;
+  }
+}
+}
+
 FrameworkPrivate::FrameworkPrivate(CoreBundleContext* fwCtx)
   : BundlePrivate(fwCtx)
   , headers(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS)
@@ -189,8 +223,7 @@ void FrameworkPrivate::Start(uint32_t)
   }
 
   // Start bundles according to their autostart setting.
-  for (auto i : bundlesToStart) {
-    auto b = coreCtx->bundleRegistry.GetBundle(i);
+  auto startBundle = [this](const std::shared_ptr<BundlePrivate>& b) {
     try {
       const int32_t autostartSetting = b->barchive->GetAutostartSetting();
       // Launch must not change the autostart setting of a bundle
@@ -207,6 +240,77 @@ void FrameworkPrivate::Start(uint32_t)
                        std::string(),
                        std::current_exception()));
     }
+  };
+
+  const auto launchStart = std::chrono::steady_clock::now();
+  const auto eventsBefore = coreCtx->listeners.GetBundleEventStatistics();
+  std::vector<std::pair<int, std::shared_ptr<BundlePrivate>>> bundles;
+  for (auto i : bundlesToStart) {
+    auto b = coreCtx->bundleRegistry.GetBundle(i);
+    bundles.emplace_back(GetStartLevel(b, true), b);
+  }
+  std::stable_sort(
+    bundles.begin(), bundles.end(), [](const auto& b1, const auto& b2) {
+      return b1.first < b2.first;
+    });
+
+  // The bundle events of the launch reach bundle events listeners at once
+  std::unique_ptr<ServiceListeners::BundleEventBatch> eventBatch;
+  if (!bundles.empty()) {
+    eventBatch =
+      std::make_unique<ServiceListeners::BundleEventBatch>(coreCtx->listeners);
+  }
+
+  // Bundles of the same start level are started concurrently, if allowed
+  for (auto first = bundles.begin(); first != bundles.end();) {
+    auto last = std::find_if(first, bundles.end(), [first](const auto& b) {
+      return b.first != first->first;
+    });
+    auto count = static_cast<std::size_t>(std::distance(first, last));
+    auto numThreads = std::min(
+      static_cast<std::size_t>(coreCtx->bundleStartThreads), count);
+    if (numThreads <= 1) {
+      for (auto iter = first; iter != last; ++iter) {
+        startBundle(iter->second);
+      }
+    } else {
+      std::atomic<std::size_t> next(0);
+      auto startNext = [&startBundle, &next, first, count]() {
+        for (auto i = next++; i < count; i = next++) {
+          startBundle((first + i)->second);
+        }
+      };
+      auto threads =
+        StartThreads(numThreads - 1, [this, &eventBatch, &startNext] {
+          // hold back the bundle events of this thread in the launch batch
+          ServiceListeners::BundleEventBatch threadBatch(coreCtx->listeners,
+                                                         *eventBatch);
+          startNext();
+        });
+      startNext();
+      for (auto& th : threads) {
+        th.join();
+      }
+    }
+    first = last;
+  }
+  eventBatch.reset();
+
+  if (!bundles.empty()) {
+    std::chrono::duration<double, std::milli> launchTime =
+      std::chrono::steady_clock::now() - launchStart;
+    const auto events = coreCtx->listeners.GetBundleEventStatistics();
+    std::chrono::duration<double, std::milli> eventsTime =
+      events.dispatchTime - eventsBefore.dispatchTime;
+    coreCtx->logger->Log(
+      logservice::SeverityLevel::LOG_DEBUG,
+      "Started " + util::ToString(bundles.size()) +
+        " bundles on framework launch in " +
+        util::ToString(launchTime.count()) + " ms using " +
+        util::ToString(coreCtx->bundleStartThreads) + " thread(s), " +
+        util::ToString(events.count - eventsBefore.count) +
+        " bundle events were dispatched in " +
+        util::ToString(eventsTime.count()) + " ms");
   }
 
   {
@@ -298,8 +402,15 @@ void FrameworkPrivate::ShutdownDone_unlocked(bool restart)
 
 void FrameworkPrivate::StopAllBundles()
 {
-  // Stop all active bundles, in reverse bundle ID order
+  // Stop all active bundles, in reverse start level order. Bundles of the
+  // same start level keep the reverse registry order.
   auto activeBundles = coreCtx->bundleRegistry.GetActiveBundles();
+  std::stable_sort(activeBundles.begin(),
+                   activeBundles.end(),
+                   [](const auto& b1, const auto& b2) {
+                     return GetStartLevel(b1, false) <
+                            GetStartLevel(b2, false);
+                   });
   for (auto iter = activeBundles.rbegin(); iter != activeBundles.rend();
        ++iter) {
     auto b = *iter;
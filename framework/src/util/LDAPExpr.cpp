@@ -144,7 +144,9 @@ public:
     , m_args()
     , m_attrName(std::move(attrName))
     , m_attrValue(std::move(attrValue))
-  {}
+  {
+    CompileOperand();
+  }
 
   LDAPExprData(const LDAPExprData& other)
 
@@ -154,8 +156,69 @@ public:
   std::vector<LDAPExpr> m_args;
   std::string m_attrName;
   std::string m_attrValue;
+
+  // The operand of a simple expression, resolved once when parsing
+  // so that evaluating the expression does not need to re-parse or
+  // allocate.
+  std::size_t m_attrNameHash = 0;
+  bool m_isWildcard = false;
+  bool m_hasLong = false;
+  long m_longValue = 0;
+  bool m_hasDouble = false;
+  double m_doubleValue = 0;
+  bool m_matchesTrue = false;
+  bool m_matchesFalse = false;
+  std::string m_approxValue;
+
+private:
+  void CompileOperand();
 };
 
+void LDAPExprData::CompileOperand()
+{
+  m_attrNameHash = Properties::HashKey(m_attrName);
+  m_isWildcard = m_attrValue == LDAPExprConstants::WILDCARD_STRING();
+
+  const char* s = m_attrValue.c_str();
+  char* endptr = nullptr;
+
+  errno = 0;
+  const long longInt = strtol(s, &endptr, 10);
+  m_hasLong =
+    !((errno == ERANGE && (longInt == std::numeric_limits<long>::max() ||
+                           longInt == std::numeric_limits<long>::min())) ||
+      (errno != 0 && longInt == 0) || endptr == s);
+  m_longValue = longInt;
+
+  errno = 0;
+  const double sDouble = strtod(s, &endptr);
+  m_hasDouble =
+    !((errno == ERANGE &&
+       (sDouble == 0 || sDouble == HUGE_VAL || sDouble == -HUGE_VAL)) ||
+      (errno != 0 && sDouble == 0) || endptr == s);
+  m_doubleValue = sDouble;
+  errno = 0;
+
+  // a bool property matches if the operand is a case-insensitive
+  // prefix of "true" or "false"
+  const std::string_view trueStr("true");
+  const std::string_view falseStr("false");
+  m_matchesTrue = m_attrValue.size() <= trueStr.size() &&
+                  std::equal(m_attrValue.begin(),
+                             m_attrValue.end(),
+                             trueStr.begin(),
+                             stricomp);
+  m_matchesFalse = m_attrValue.size() <= falseStr.size() &&
+                   std::equal(m_attrValue.begin(),
+                              m_attrValue.end(),
+                              falseStr.begin(),
+                              stricomp);
+
+  if (m_operator == LDAPExpr::APPROX) {
+    m_approxValue = LDAPExpr::FixupString(m_attrValue);
+  }
+}
+
 LDAPExpr::LDAPExpr()
   : d()
 {}
@@ -268,6 +331,55 @@ std::string LDAPExpr::ToLower(const std::string& str)
   return lowerStr;
 }
 
+bool LDAPExpr::GetMatchedValues(const std::string& attrName,
+                                StringList& values) const
+{
+  if (d->m_operator == EQ) {
+    if (d->m_attrName.length() == attrName.length() &&
+        std::equal(d->m_attrName.begin(),
+                   d->m_attrName.end(),
+                   attrName.begin(),
+                   stricomp) &&
+        d->m_attrValue.find(LDAPExprConstants::WILDCARD()) ==
+          std::string::npos) {
+      values.push_back(d->m_attrValue);
+      return true;
+    }
+    return false;
+  } else if (d->m_operator == AND) {
+    // any constrained operand narrows the whole conjunction
+    for (const auto& m_arg : d->m_args) {
+      if (m_arg.GetMatchedValues(attrName, values)) {
+        return true;
+      }
+    }
+    return false;
+  } else if (d->m_operator == OR) {
+    // drop only the values of this disjunction, not the caller's
+    const auto size = values.size();
+    for (const auto& m_arg : d->m_args) {
+      if (!m_arg.GetMatchedValues(attrName, values)) {
+        values.resize(size);
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+void LDAPExpr::GetAttributeNames(ObjectClassSet& attrNames) const
+{
+  if ((d->m_operator & SIMPLE) != 0) {
+    attrNames.insert(ToLower(d->m_attrName));
+    return;
+  }
+
+  for (const auto& m_arg : d->m_args) {
+    m_arg.GetAttributeNames(attrNames);
+  }
+}
+
 bool LDAPExpr::IsSimple(const StringList& keywords,
                         LocalCache& cache,
                         bool matchCase) const
@@ -306,13 +418,13 @@ bool LDAPExpr::IsNull() const
 bool LDAPExpr::Evaluate(const PropertiesHandle& p, bool matchCase) const
 {
   if ((d->m_operator & SIMPLE) != 0) {
-    // try case sensitive match first
-    int index = p->FindCaseSensitive_unlocked(d->m_attrName);
-    if (index < 0 && !matchCase)
-      index = p->Find_unlocked(d->m_attrName);
-    return index < 0
-             ? false
-             : Compare(p->Value_unlocked(index), d->m_operator, d->m_attrValue);
+    // Properties never contain case variants of a key, so a case
+    // insensitive lookup also finds an exact match if there is one.
+    const int index =
+      matchCase
+        ? p->FindCaseSensitive_unlocked(d->m_attrName, d->m_attrNameHash)
+        : p->Find_unlocked(d->m_attrName, d->m_attrNameHash);
+    return index < 0 ? false : Compare(p->ValueRef_unlocked(index));
   } else { // (d->m_operator & COMPLEX) != 0
     switch (d->m_operator) {
       case AND:
@@ -335,64 +447,61 @@ bool LDAPExpr::Evaluate(const PropertiesHandle& p, bool matchCase) const
   }
 }
 
-bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
+bool LDAPExpr::Compare(const Any& obj) const
 {
   if (obj.Empty())
     return false;
-  if (op == EQ && s == LDAPExprConstants::WILDCARD_STRING())
+  const int op = d->m_operator;
+  if (op == EQ && d->m_isWildcard)
     return true;
 
   try {
     const std::type_info& objType = obj.Type();
     if (objType == typeid(std::string)) {
-      return CompareString(ref_any_cast<std::string>(obj), op, s);
+      return CompareString(ref_any_cast<std::string>(obj));
     } else if (objType == typeid(std::vector<std::string>)) {
       const auto& list = ref_any_cast<std::vector<std::string>>(obj);
       for (std::size_t it = 0; it != list.size(); it++) {
-        if (CompareString(list[it], op, s))
+        if (CompareString(list[it]))
           return true;
       }
     } else if (objType == typeid(std::list<std::string>)) {
       const auto& list = ref_any_cast<std::list<std::string>>(obj);
       for (const auto& it : list) {
-        if (CompareString(it, op, s))
+        if (CompareString(it))
           return true;
       }
     } else if (objType == typeid(char)) {
-      return CompareString(std::string(1, ref_any_cast<char>(obj)), op, s);
+      const char& c = ref_any_cast<char>(obj);
+      return CompareString(std::string_view(&c, 1));
     } else if (objType == typeid(bool)) {
       if (op == LE || op == GE)
         return false;
 
-      std::string boolVal = any_cast<bool>(obj) ? "true" : "false";
-      return std::equal(s.begin(), s.end(), boolVal.begin(), stricomp);
+      return any_cast<bool>(obj) ? d->m_matchesTrue : d->m_matchesFalse;
     } else if (objType == typeid(short)) {
-      return CompareIntegralType<short>(obj, op, s);
+      return CompareIntegralType<short>(obj);
     } else if (objType == typeid(int)) {
-      return CompareIntegralType<int>(obj, op, s);
+      return CompareIntegralType<int>(obj);
     } else if (objType == typeid(long int)) {
-      return CompareIntegralType<long int>(obj, op, s);
+      return CompareIntegralType<long int>(obj);
     } else if (objType == typeid(long long int)) {
-      return CompareIntegralType<long long int>(obj, op, s);
+      return CompareIntegralType<long long int>(obj);
     } else if (objType == typeid(unsigned char)) {
-      return CompareIntegralType<unsigned char>(obj, op, s);
+      return CompareIntegralType<unsigned char>(obj);
     } else if (objType == typeid(unsigned short)) {
-      return CompareIntegralType<unsigned short>(obj, op, s);
+      return CompareIntegralType<unsigned short>(obj);
     } else if (objType == typeid(unsigned int)) {
-      return CompareIntegralType<unsigned int>(obj, op, s);
+      return CompareIntegralType<unsigned int>(obj);
     } else if (objType == typeid(unsigned long int)) {
-      return CompareIntegralType<unsigned long int>(obj, op, s);
+      return CompareIntegralType<unsigned long int>(obj);
     } else if (objType == typeid(unsigned long long int)) {
-      return CompareIntegralType<unsigned long long int>(obj, op, s);
+      return CompareIntegralType<unsigned long long int>(obj);
     } else if (objType == typeid(float)) {
-      errno = 0;
-      char* endptr = nullptr;
-      double sFloat = strtod(s.c_str(), &endptr);
-      if ((errno == ERANGE &&
-           (sFloat == 0 || sFloat == HUGE_VAL || sFloat == -HUGE_VAL)) ||
-          (errno != 0 && sFloat == 0) || endptr == s.c_str()) {
+      if (!d->m_hasDouble) {
         return false;
       }
+      const double sFloat = d->m_doubleValue;
 
       auto floatVal = static_cast<double>(any_cast<float>(obj));
 
@@ -407,14 +516,10 @@ bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
                  (diff > -std::numeric_limits<float>::epsilon());
       }
     } else if (objType == typeid(double)) {
-      errno = 0;
-      char* endptr = nullptr;
-      double sDouble = strtod(s.c_str(), &endptr);
-      if ((errno == ERANGE &&
-           (sDouble == 0 || sDouble == HUGE_VAL || sDouble == -HUGE_VAL)) ||
-          (errno != 0 && sDouble == 0) || endptr == s.c_str()) {
+      if (!d->m_hasDouble) {
         return false;
       }
+      const double sDouble = d->m_doubleValue;
 
       auto doubleVal = any_cast<double>(obj);
 
@@ -431,7 +536,7 @@ bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
     } else if (objType == typeid(std::vector<Any>)) {
       const auto& list = ref_any_cast<std::vector<Any>>(obj);
       for (std::size_t it = 0; it != list.size(); it++) {
-        if (Compare(list[it], op, s))
+        if (Compare(list[it]))
           return true;
       }
     }
@@ -443,23 +548,16 @@ bool LDAPExpr::Compare(const Any& obj, int op, const std::string& s) const
 }
 
 template<typename T>
-bool LDAPExpr::CompareIntegralType(const Any& obj,
-                                   const int op,
-                                   const std::string& s) const
+bool LDAPExpr::CompareIntegralType(const Any& obj) const
 {
-  errno = 0;
-  char* endptr = nullptr;
-  long longInt = strtol(s.c_str(), &endptr, 10);
-  if ((errno == ERANGE && (longInt == std::numeric_limits<long>::max() ||
-                           longInt == std::numeric_limits<long>::min())) ||
-      (errno != 0 && longInt == 0) || endptr == s.c_str()) {
+  if (!d->m_hasLong) {
     return false;
   }
 
-  auto sInt = static_cast<T>(longInt);
+  auto sInt = static_cast<T>(d->m_longValue);
   auto intVal = any_cast<T>(obj);
 
-  switch (op) {
+  switch (d->m_operator) {
     case LE:
       return intVal <= sInt;
     case GE:
@@ -469,19 +567,18 @@ bool LDAPExpr::CompareIntegralType(const Any& obj,
   }
 }
 
-bool LDAPExpr::CompareString(const std::string_view s1,
-                             int op,
-                             const std::string_view s2)
+bool LDAPExpr::CompareString(const std::string_view s) const
 {
-  switch (op) {
+  const std::string_view attrValue(d->m_attrValue);
+  switch (d->m_operator) {
     case LE:
-      return s1.compare(s2) <= 0;
+      return s.compare(attrValue) <= 0;
     case GE:
-      return s1.compare(s2) >= 0;
+      return s.compare(attrValue) >= 0;
     case EQ:
-      return PatSubstr(s1, s2);
+      return PatSubstr(s, attrValue);
     case APPROX:
-      return FixupString(s2) == FixupString(s1);
+      return ApproxEquals(s, d->m_approxValue);
     default:
       return false;
   }
@@ -503,6 +600,25 @@ std::string LDAPExpr::FixupString(const std::string_view s)
   return sb;
 }
 
+bool LDAPExpr::ApproxEquals(const std::string_view s,
+                            const std::string_view fixedPat)
+{
+  std::size_t pi = 0;
+  for (char c : s) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      continue;
+    }
+    if (std::isupper(static_cast<unsigned char>(c))) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (pi == fixedPat.size() || fixedPat[pi] != c) {
+      return false;
+    }
+    ++pi;
+  }
+  return pi == fixedPat.size();
+}
+
 bool LDAPExpr::PatSubstr(const std::string_view s,
                          int si,
                          const std::string_view pat,
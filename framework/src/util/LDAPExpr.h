@@ -82,6 +82,28 @@ public:
    */
   bool GetMatchedObjectClasses(ObjectClassSet& objClasses) const;
 
+  /**
+   * Get the values an attribute must be equal to for this LDAP expression
+   * to match. Like GetMatchedObjectClasses(), this will not work with
+   * wildcards and NOT expressions.
+   *
+   * \param attrName The attribute name, compared case-insensitively.
+   * \param values The values which can satisfy this expression will be
+   *        added to values.
+   * \return If the set cannot be determined, <code>false</code> is returned,
+   *         <code>true</code> otherwise.
+   */
+  bool GetMatchedValues(const std::string& attrName, StringList& values) const;
+
+  /**
+   * Get the attributes tested by this LDAP expression, i.e. the property
+   * keys its outcome can depend on.
+   *
+   * \param attrNames The lower-cased attribute names will be added to
+   *        attrNames.
+   */
+  void GetAttributeNames(ObjectClassSet& attrNames) const;
+
   /**
    * Checks if this LDAP expression is "simple". The definition of
    * a simple filter is:
@@ -125,6 +147,7 @@ public:
 
 private:
   class ParseState;
+  friend class LDAPExprData;
 
   //!
   LDAPExpr(int op, const std::vector<LDAPExpr>& args);
@@ -142,23 +165,24 @@ private:
 
   static std::string ToLower(const std::string& str);
 
-  //!
-  bool Compare(const Any& obj, int op, const std::string& s) const;
+  //! Compare a property value with the operand of this simple expression
+  bool Compare(const Any& obj) const;
 
   //!
   template<typename T>
-  bool CompareIntegralType(const Any& obj,
-                           const int op,
-                           const std::string& s) const;
+  bool CompareIntegralType(const Any& obj) const;
 
   //!
-  static bool CompareString(const std::string_view s1,
-                            int op,
-                            const std::string_view s2);
+  bool CompareString(const std::string_view s) const;
 
   //!
   static std::string FixupString(const std::string_view s);
 
+  //! Compare FixupString(s) with an already fixed up string, without
+  //! allocating
+  static bool ApproxEquals(const std::string_view s,
+                           const std::string_view fixedPat);
+
   //!
   static bool PatSubstr(const std::string_view s, const std::string_view pat);
 
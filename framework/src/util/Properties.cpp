@@ -22,6 +22,7 @@
 
 #include "Properties.h"
 
+#include <cctype>
 #include <limits>
 #include <stdexcept>
 #ifdef US_PLATFORM_WINDOWS
@@ -36,8 +37,31 @@ US_MSVC_PUSH_DISABLE_WARNING(4996)
 
 namespace cppmicroservices {
 
+namespace {
+
+void ThrowCaseVariant(const std::string& key)
+{
+  std::string msg("Properties contain case variants of the key: ");
+  msg += key;
+  throw std::runtime_error(msg.c_str());
+}
+}
+
 const Any Properties::emptyAny;
 
+// FNV-1a over the ASCII lower-cased characters, consistent with the
+// case-insensitive comparison done by ci_compare.
+std::size_t Properties::HashKey(const std::string& key) noexcept
+{
+  std::size_t hash = static_cast<std::size_t>(14695981039346656037ULL);
+  for (const char c : key) {
+    hash ^= static_cast<std::size_t>(
+      std::tolower(static_cast<unsigned char>(c)));
+    hash *= static_cast<std::size_t>(1099511628211ULL);
+  }
+  return hash;
+}
+
 Properties::Properties(const AnyMap& p)
 {
   if (p.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
@@ -47,39 +71,50 @@ Properties::Properties(const AnyMap& p)
   keys.reserve(p.size());
   values.reserve(p.size());
 
+  const bool indexed = p.size() > IndexThreshold;
   for (auto& iter : p) {
-    if (Find_unlocked(iter.first) > -1) {
-      std::string msg("Properties contain case variants of the key: ");
-      msg += iter.first;
-      throw std::runtime_error(msg.c_str());
+    // Case variants in larger sets are found while building the index
+    if (!indexed && Find_unlocked(iter.first) > -1) {
+      ThrowCaseVariant(iter.first);
     }
     keys.push_back(iter.first);
     values.push_back(iter.second);
   }
+  BuildIndex_unlocked();
 }
 
 Properties::Properties(Properties&& o) noexcept
   : keys(std::move(o.keys))
   , values(std::move(o.values))
+  , hashes(std::move(o.hashes))
+  , hashIndex(std::move(o.hashIndex))
 {}
 
 Properties& Properties::operator=(Properties&& o) noexcept
 {
   keys = std::move(o.keys);
   values = std::move(o.values);
+  hashes = std::move(o.hashes);
+  hashIndex = std::move(o.hashIndex);
   return *this;
 }
 
 Any Properties::Value_unlocked(const std::string& key) const
 {
-  int i = Find_unlocked(key);
-  if (i < 0) {
-    return emptyAny;
-  }
-  return values[i];
+  return ValueRef_unlocked(key);
 }
 
 Any Properties::Value_unlocked(int index) const
+{
+  return ValueRef_unlocked(index);
+}
+
+const Any& Properties::ValueRef_unlocked(const std::string& key) const noexcept
+{
+  return ValueRef_unlocked(Find_unlocked(key));
+}
+
+const Any& Properties::ValueRef_unlocked(int index) const noexcept
 {
   if (index < 0 || static_cast<std::size_t>(index) >= values.size()) {
     return emptyAny;
@@ -89,6 +124,24 @@ Any Properties::Value_unlocked(int index) const
 
 int Properties::Find_unlocked(const std::string& key) const
 {
+  return Find_unlocked(key, hashIndex.empty() ? 0 : HashKey(key));
+}
+
+int Properties::Find_unlocked(const std::string& key, std::size_t hash) const
+{
+  if (!hashIndex.empty()) {
+    const std::size_t mask = hashIndex.size() - 1;
+    for (std::size_t slot = hash & mask; hashIndex[slot] != -1;
+         slot = (slot + 1) & mask) {
+      const auto i = static_cast<std::size_t>(hashIndex[slot]);
+      if (hashes[i] == hash && key.size() == keys[i].size() &&
+          ci_compare(key.c_str(), keys[i].c_str(), key.size()) == 0) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
   for (std::size_t i = 0; i < keys.size(); ++i) {
     if (key.size() == keys[i].size() &&
         ci_compare(key.c_str(), keys[i].c_str(), key.size()) == 0) {
@@ -100,6 +153,20 @@ int Properties::Find_unlocked(const std::string& key) const
 
 int Properties::FindCaseSensitive_unlocked(const std::string& key) const
 {
+  return FindCaseSensitive_unlocked(key,
+                                    hashIndex.empty() ? 0 : HashKey(key));
+}
+
+int Properties::FindCaseSensitive_unlocked(const std::string& key,
+                                           std::size_t hash) const
+{
+  if (!hashIndex.empty()) {
+    // keys are unique ignoring case, so the case-insensitive match is
+    // the only candidate.
+    const int i = Find_unlocked(key, hash);
+    return (i > -1 && keys[static_cast<std::size_t>(i)] == key) ? i : -1;
+  }
+
   for (std::size_t i = 0; i < keys.size(); ++i) {
     if (key == keys[i]) {
       return static_cast<int>(i);
@@ -113,10 +180,83 @@ std::vector<std::string> Properties::Keys_unlocked() const
   return keys;
 }
 
+void Properties::Set_unlocked(const std::string& key, const Any& value)
+{
+  const int index = Find_unlocked(key);
+  if (index > -1) {
+    keys[static_cast<std::size_t>(index)] = key;
+    values[static_cast<std::size_t>(index)] = value;
+    return;
+  }
+
+  if (keys.size() >=
+      static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+    throw std::runtime_error("Properties contain too many keys");
+  }
+
+  keys.push_back(key);
+  values.push_back(value);
+  if (keys.size() > IndexThreshold) {
+    // The table is rebuilt rather than extended, since it may have
+    // to grow to keep its load factor; adding keys is rare compared
+    // to updating the value of an existing one.
+    BuildIndex_unlocked();
+  }
+}
+
+bool Properties::Remove_unlocked(const std::string& key)
+{
+  const int index = Find_unlocked(key);
+  if (index < 0) {
+    return false;
+  }
+
+  keys.erase(keys.begin() + index);
+  values.erase(values.begin() + index);
+  // removing a key shifts the indices of all keys after it
+  BuildIndex_unlocked();
+  return true;
+}
+
+void Properties::BuildIndex_unlocked()
+{
+  hashes.clear();
+  hashIndex.clear();
+  if (keys.size() <= IndexThreshold) {
+    return;
+  }
+
+  // Keep the load factor of the table at or below 0.5
+  std::size_t tableSize = 1;
+  while (tableSize < keys.size() * 2) {
+    tableSize <<= 1;
+  }
+  const std::size_t mask = tableSize - 1;
+
+  hashes.reserve(keys.size());
+  hashIndex.assign(tableSize, -1);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    const std::string& key = keys[i];
+    const std::size_t hash = HashKey(key);
+    std::size_t slot = hash & mask;
+    for (; hashIndex[slot] != -1; slot = (slot + 1) & mask) {
+      const auto j = static_cast<std::size_t>(hashIndex[slot]);
+      if (hashes[j] == hash && keys[j].size() == key.size() &&
+          ci_compare(keys[j].c_str(), key.c_str(), key.size()) == 0) {
+        ThrowCaseVariant(key);
+      }
+    }
+    hashIndex[slot] = static_cast<int>(i);
+    hashes.push_back(hash);
+  }
+}
+
 void Properties::Clear_unlocked()
 {
   keys.clear();
   values.clear();
+  hashes.clear();
+  hashIndex.clear();
 }
 }
 
@@ -44,17 +44,68 @@ public:
   Any Value_unlocked(const std::string& key) const;
   Any Value_unlocked(int index) const;
 
+  /**
+   * Borrowing variants of Value_unlocked. The returned reference is
+   * owned by this object and must only be used while the properties
+   * lock is held and the properties are not re-assigned. An empty Any
+   * is returned if the key or index does not exist.
+   */
+  const Any& ValueRef_unlocked(const std::string& key) const noexcept;
+  const Any& ValueRef_unlocked(int index) const noexcept;
+
   int Find_unlocked(const std::string& key) const;
   int FindCaseSensitive_unlocked(const std::string& key) const;
 
+  /**
+   * Variants of Find_unlocked and FindCaseSensitive_unlocked for callers
+   * which look up the same key repeatedly and cache HashKey(key).
+   */
+  int Find_unlocked(const std::string& key, std::size_t hash) const;
+  int FindCaseSensitive_unlocked(const std::string& key,
+                                 std::size_t hash) const;
+
+  /**
+   * Returns the hash of the case-folded key, as used by the key index.
+   */
+  static std::size_t HashKey(const std::string& key) noexcept;
+
   std::vector<std::string> Keys_unlocked() const;
 
+  /**
+   * Sets the value of a key in place. An existing key which differs
+   * only in case is replaced, including its spelling.
+   */
+  void Set_unlocked(const std::string& key, const Any& value);
+
+  /**
+   * Removes a key, compared case-insensitively.
+   *
+   * @return <code>true</code> if the key existed.
+   */
+  bool Remove_unlocked(const std::string& key);
+
   void Clear_unlocked();
 
 private:
   std::vector<std::string> keys;
   std::vector<Any> values;
 
+  // Case-folded hashes of the keys, parallel to "keys".
+  std::vector<std::size_t> hashes;
+
+  // Open-addressing (linear probing) table of indices into "keys",
+  // empty slots are -1. Its size is a power of two and it is only
+  // built for more than IndexThreshold keys; smaller property sets
+  // are scanned linearly, which is cheaper than hashing the key.
+  std::vector<int> hashIndex;
+
+  static constexpr std::size_t IndexThreshold = 8;
+
+  // (Re-)builds hashes and hashIndex for the current keys, or drops
+  // them if there are no more than IndexThreshold keys. Throws if two
+  // keys are case variants of each other.
+  void BuildIndex_unlocked();
+
   static const Any emptyAny;
 };
 
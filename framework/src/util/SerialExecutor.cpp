@@ -0,0 +1,219 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#include "SerialExecutor.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+
+namespace cppmicroservices {
+
+namespace {
+
+// The queue whose tasks the current thread runs, if any
+thread_local const void* currentQueue = nullptr;
+
+// The key of the task the current thread runs, if any
+thread_local const void* currentKey = nullptr;
+}
+
+struct SerialExecutor::Queue
+{
+  struct Pending
+  {
+    std::deque<Task> tasks;
+    bool running = false;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::condition_variable idle;
+  bool stopped = false;
+
+  // The pending tasks per key. A key is present while one of its tasks
+  // is queued or running, and at most one of its tasks runs at a time.
+  std::unordered_map<const void*, Pending> tasks;
+
+  // The keys whose next task may run, in the order they became ready
+  std::deque<const void*> ready;
+
+  void Run()
+  {
+    currentQueue = this;
+    std::unique_lock<std::mutex> l(mutex);
+    for (;;) {
+      cond.wait(l, [this] { return stopped || !ready.empty(); });
+      if (ready.empty()) {
+        return;
+      }
+      auto key = ready.front();
+      ready.pop_front();
+      // go to the back of the line so that one busy key does not
+      // starve the others
+      if (RunNext_unlocked(l, key)) {
+        ready.push_back(key);
+      }
+    }
+  }
+
+  // Runs the next task of a key which is not running, without the lock.
+  // Returns true if more tasks of the key are pending.
+  bool RunNext_unlocked(std::unique_lock<std::mutex>& l, const void* key)
+  {
+    auto& pending = tasks[key];
+    auto task = std::move(pending.tasks.front());
+    pending.tasks.pop_front();
+    pending.running = true;
+    auto outerKey = currentKey;
+    currentKey = key;
+    l.unlock();
+    try {
+      task();
+    } catch (...) {
+    }
+    // destroy the task and whatever it holds on to without the lock
+    task = nullptr;
+    currentKey = outerKey;
+    l.lock();
+    auto iter = tasks.find(key);
+    if (iter->second.tasks.empty()) {
+      tasks.erase(iter);
+      idle.notify_all();
+      return false;
+    }
+    iter->second.running = false;
+    return true;
+  }
+};
+
+SerialExecutor::SerialExecutor(std::size_t threads)
+  : queue(std::make_shared<Queue>())
+{
+  // the workers share the queue, so that a worker detached
+  // by Shutdown() can finish on its own
+  this->threads = StartThreads(threads, [q = queue] { q->Run(); });
+  if (this->threads.empty()) {
+    queue->stopped = true;
+  }
+}
+
+std::vector<std::thread> StartThreads(std::size_t count,
+                                      const std::function<void()>& fn)
+{
+  std::vector<std::thread> threads;
+  threads.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    try {
+      threads.emplace_back(fn);
+    } catch (const std::system_error&) {
+      // go on with the threads which could be started
+      break;
+    }
+  }
+  return threads;
+}
+
+SerialExecutor::~SerialExecutor()
+{
+  Shutdown();
+}
+
+void SerialExecutor::Post(const void* key, Task task)
+{
+  {
+    std::lock_guard<std::mutex> l(queue->mutex);
+    auto iter = queue->tasks.find(key);
+    if (iter != queue->tasks.end()) {
+      // the key's tasks are still being worked off, even if stopped
+      iter->second.tasks.push_back(std::move(task));
+      return;
+    }
+    if (!queue->stopped) {
+      queue->tasks[key].tasks.push_back(std::move(task));
+      queue->ready.push_back(key);
+      queue->cond.notify_one();
+      return;
+    }
+  }
+  try {
+    task();
+  } catch (...) {
+  }
+}
+
+void SerialExecutor::Flush(const void* key)
+{
+  std::unique_lock<std::mutex> l(queue->mutex);
+  if (IsWorkerThread()) {
+    if (key == currentKey) {
+      // the calling task would wait for itself
+      return;
+    }
+    // run the queued tasks of the key here rather than waiting for
+    // a worker, all of them might be busy flushing
+    for (;;) {
+      auto iter = queue->tasks.find(key);
+      if (iter == queue->tasks.end()) {
+        return;
+      }
+      if (iter->second.running) {
+        queue->idle.wait(l);
+        continue;
+      }
+      auto readyIter =
+        std::find(queue->ready.begin(), queue->ready.end(), key);
+      if (readyIter != queue->ready.end()) {
+        queue->ready.erase(readyIter);
+      }
+      queue->RunNext_unlocked(l, key);
+    }
+  }
+  queue->idle.wait(
+    l, [this, key] { return queue->tasks.count(key) == 0; });
+}
+
+void SerialExecutor::Shutdown()
+{
+  {
+    std::lock_guard<std::mutex> l(queue->mutex);
+    queue->stopped = true;
+  }
+  queue->cond.notify_all();
+  for (auto& th : threads) {
+    if (th.get_id() == std::this_thread::get_id()) {
+      th.detach();
+    } else if (th.joinable()) {
+      th.join();
+    }
+  }
+  threads.clear();
+}
+
+bool SerialExecutor::IsWorkerThread() const
+{
+  return currentQueue == queue.get();
+}
+}
@@ -0,0 +1,111 @@
+/*=============================================================================
+
+  Library: CppMicroServices
+
+  Copyright (c) The CppMicroServices developers. See the COPYRIGHT
+  file at the top-level directory of this distribution and at
+  https://github.com/CppMicroServices/CppMicroServices/COPYRIGHT .
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+=============================================================================*/
+
+#ifndef CPPMICROSERVICES_SERIALEXECUTOR_H
+#define CPPMICROSERVICES_SERIALEXECUTOR_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace cppmicroservices {
+
+/**
+ * Runs tasks on a fixed number of worker threads. Tasks are posted
+ * under a key, and the tasks of one key run one at a time in the order
+ * they were posted, while tasks of different keys run concurrently.
+ */
+class SerialExecutor
+{
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * Starts the worker threads. If no thread can be started, posted tasks
+   * run on the posting thread.
+   *
+   * @param threads The number of worker threads.
+   */
+  explicit SerialExecutor(std::size_t threads);
+
+  /**
+   * Shuts the executor down, see Shutdown().
+   */
+  ~SerialExecutor();
+
+  SerialExecutor(const SerialExecutor&) = delete;
+  SerialExecutor& operator=(const SerialExecutor&) = delete;
+
+  /**
+   * Queues a task after the tasks already posted under the same key.
+   * Once the executor was shut down, the task runs on the calling thread.
+   * Exceptions thrown by a task are ignored.
+   *
+   * @param key Identifies the sequence of tasks the task belongs to.
+   * @param task The task to run.
+   */
+  void Post(const void* key, Task task);
+
+  /**
+   * Waits until no task posted under the key is queued or running.
+   * Returns immediately if called from a task of the same key, which
+   * would otherwise wait for itself. Called from a task of another key,
+   * the queued tasks of the key run on the calling thread.
+   *
+   * @param key Identifies the sequence of tasks to wait for.
+   */
+  void Flush(const void* key);
+
+  /**
+   * Runs all queued tasks and stops the worker threads. If called from a
+   * worker thread, that thread is detached and stops once the queue is
+   * empty.
+   */
+  void Shutdown();
+
+  /**
+   * @return true if the calling thread is a worker thread of this executor.
+   */
+  bool IsWorkerThread() const;
+
+private:
+  struct Queue;
+
+  std::shared_ptr<Queue> queue;
+  std::vector<std::thread> threads;
+};
+
+/**
+ * Starts up to count threads running fn. Stops at the first thread which
+ * cannot be started, the caller goes on with the threads started so far.
+ *
+ * @param count The number of threads to start.
+ * @param fn The function each thread runs.
+ * @return The started threads, possibly none.
+ */
+std::vector<std::thread> StartThreads(std::size_t count,
+                                      const std::function<void()>& fn);
+}
+
+#endif // CPPMICROSERVICES_SERIALEXECUTOR_H
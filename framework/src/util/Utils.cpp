@@ -25,12 +25,16 @@
 #include "cppmicroservices/Bundle.h"
 #include "cppmicroservices/BundleContext.h"
 
+#include "cppmicroservices/detail/Threads.h"
 #include "cppmicroservices/util/Error.h"
 #include "cppmicroservices/util/FileSystem.h"
 
 #include "BundleResourceContainer.h"
 #include "CoreBundleContext.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <typeinfo>
 #include <vector>
@@ -218,5 +222,97 @@ std::string GetDemangledName(const std::type_info& typeInfo)
   return result;
 }
 
+namespace {
+
+/**
+ * Open addressing hash table of interned interface ids. Slots are only
+ * ever filled and never cleared, so lookups probe it without locking.
+ */
+struct InterfaceIdTable
+{
+  explicit InterfaceIdTable(std::size_t capacity)
+    : capacity(capacity)
+    , slots(new std::atomic<const std::string*>[capacity]())
+  {}
+
+  const std::string* Find(const std::string& interfaceId,
+                          std::size_t hash) const
+  {
+    const std::size_t mask = capacity - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+      const std::string* id = slots[i].load(std::memory_order_acquire);
+      if (id == nullptr || id == &interfaceId || *id == interfaceId) {
+        return id;
+      }
+    }
+  }
+
+  void Insert(const std::string* id, std::size_t hash)
+  {
+    std::size_t i = hash & (capacity - 1);
+    while (slots[i].load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & (capacity - 1);
+    }
+    slots[i].store(id, std::memory_order_release);
+    ++size;
+  }
+
+  const std::size_t capacity;
+  std::size_t size = 0;
+  std::unique_ptr<std::atomic<const std::string*>[]> slots;
+};
+
+struct InterfaceIds : MultiThreaded<>
+{
+  std::atomic<InterfaceIdTable*> table{ new InterfaceIdTable(256) };
+};
+
+InterfaceIds& GetInterfaceIds()
+{
+  // Never destroyed, interned ids may be used during static destruction
+  static InterfaceIds* ids = new InterfaceIds();
+  return *ids;
+}
+}
+
+const std::string& InternInterfaceId(const std::string& interfaceId)
+{
+  auto& ids = GetInterfaceIds();
+  const std::size_t hash = std::hash<std::string>()(interfaceId);
+  if (auto id = ids.table.load(std::memory_order_acquire)
+                  ->Find(interfaceId, hash)) {
+    return *id;
+  }
+
+  auto l = ids.Lock();
+  US_UNUSED(l);
+  InterfaceIdTable* table = ids.table.load(std::memory_order_relaxed);
+  if (auto id = table->Find(interfaceId, hash)) {
+    return *id;
+  }
+  if (2 * (table->size + 1) > table->capacity) {
+    // Readers may still probe the old table, so it is never freed.
+    // The tables grow geometrically, which bounds the leaked memory.
+    auto grown = new InterfaceIdTable(2 * table->capacity);
+    for (std::size_t i = 0; i < table->capacity; ++i) {
+      if (auto id = table->slots[i].load(std::memory_order_relaxed)) {
+        grown->Insert(id, std::hash<std::string>()(*id));
+      }
+    }
+    ids.table.store(grown, std::memory_order_release);
+    table = grown;
+  }
+  auto id = new std::string(interfaceId);
+  table->Insert(id, hash);
+  return *id;
+}
+
+const std::string* FindInterfaceId(const std::string& interfaceId)
+{
+  return GetInterfaceIds()
+    .table.load(std::memory_order_acquire)
+    ->Find(interfaceId, std::hash<std::string>()(interfaceId));
+}
+
 }
 } // namespaces
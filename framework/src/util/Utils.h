@@ -86,6 +86,16 @@ void TerminateForDebug(const std::exception_ptr ex);
 namespace detail {
 US_Framework_EXPORT std::string GetDemangledName(
   const std::type_info& typeInfo);
+
+US_Framework_EXPORT const std::string& InternInterfaceId(
+  const std::string& interfaceId);
+
+/**
+ * Returns the interned copy of an interface id, or <code>nullptr</code>
+ * if the id has never been interned. Unlike InternInterfaceId, this
+ * does not grow the table for ids that are only queried.
+ */
+const std::string* FindInterfaceId(const std::string& interfaceId);
 }
 
 } // namespace cppmicroservices
@@ -10,8 +10,11 @@
 
 #include <cassert>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "TestUtils.h"
+#include "allocationcounter.h"
 
 using namespace cppmicroservices;
 
@@ -192,3 +195,118 @@ BENCHMARK_REGISTER_F(AnyMapPerfTestFixture, ErrorPath_NoThrowOverload)
   ->Arg(15)
   ->Arg(18)
   ->Arg(20);
+
+namespace {
+
+template<typename T>
+T MakeValue();
+
+template<>
+bool MakeValue<bool>()
+{
+  return true;
+}
+
+template<>
+int MakeValue<int>()
+{
+  return 42;
+}
+
+template<>
+long MakeValue<long>()
+{
+  return 42L;
+}
+
+template<>
+double MakeValue<double>()
+{
+  return 42.0;
+}
+
+template<>
+std::string MakeValue<std::string>()
+{
+  return "a service property";
+}
+
+template<>
+std::vector<std::string> MakeValue<std::vector<std::string>>()
+{
+  return { "foo::IFoo", "foo::IBar" };
+}
+}
+
+// Measures creating and destroying an Any holding a value of type T.
+// The "allocs" counter is the number of allocations made per Any, not
+// counting the allocations made by T itself.
+template<typename T>
+static void AnyConstructCopy(benchmark::State& state)
+{
+  const T value = MakeValue<T>();
+  const std::size_t valueAllocations = [&value] {
+    benchmark::test::AllocationCounter counter;
+    T copy(value);
+    benchmark::DoNotOptimize(copy);
+    return counter.Count();
+  }();
+
+  std::size_t allocations = 0;
+  for (auto _ : state) {
+    benchmark::test::AllocationCounter counter;
+    Any any(value);
+    Any copy(any);
+    benchmark::DoNotOptimize(copy);
+    allocations += counter.Count() - 2 * valueAllocations;
+  }
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Measures building an AnyMap of scalar values, as done when parsing
+// a bundle manifest or creating service properties.
+static void AnyMapBuildScalars(benchmark::State& state)
+{
+  const auto count = state.range(0);
+  std::vector<std::string> keys;
+  for (int64_t i = 0; i < count; ++i) {
+    keys.push_back("relativelylongkeyname_element" + std::to_string(i));
+  }
+
+  std::size_t allocations = 0;
+  for (auto _ : state) {
+    benchmark::test::AllocationCounter counter;
+    AnyMap map(AnyMap::UNORDERED_MAP_CASEINSENSITIVE_KEYS);
+    for (int64_t i = 0; i < count; ++i) {
+      switch (i % 4) {
+        case 0:
+          map[keys[i]] = static_cast<int>(i);
+          break;
+        case 1:
+          map[keys[i]] = static_cast<long>(i);
+          break;
+        case 2:
+          map[keys[i]] = static_cast<double>(i);
+          break;
+        default:
+          map[keys[i]] = (i % 2) == 0;
+          break;
+      }
+    }
+    benchmark::DoNotOptimize(map);
+    allocations += counter.Count();
+  }
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(AnyConstructCopy, bool);
+BENCHMARK_TEMPLATE(AnyConstructCopy, int);
+BENCHMARK_TEMPLATE(AnyConstructCopy, long);
+BENCHMARK_TEMPLATE(AnyConstructCopy, double);
+BENCHMARK_TEMPLATE(AnyConstructCopy, std::string);
+BENCHMARK_TEMPLATE(AnyConstructCopy, std::vector<std::string>);
+BENCHMARK(AnyMapBuildScalars)->RangeMultiplier(4)->Range(4, 256);
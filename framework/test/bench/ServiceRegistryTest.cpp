@@ -10,10 +10,16 @@
 #include <cppmicroservices/ServiceFactory.h>
 #include <cppmicroservices/ServiceObjects.h>
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "allocationcounter.h"
+
 using namespace cppmicroservices;
 
 namespace {
@@ -188,6 +194,45 @@ BENCHMARK_REGISTER_F(ServiceRegistryFixture, UnregisterServices)
   ->Ranges({ { 1, 1000 }, { 1, 1000 } })
   ->UseManualTime();
 
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, RegisterUnregisterServices)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  auto fc = framework->GetBundleContext();
+  auto regCount = state.range(0);
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+
+  for (auto _ : state) {
+    std::vector<ServiceRegistrationBase> regs;
+    regs.reserve(static_cast<std::size_t>(regCount));
+    auto start = high_resolution_clock::now();
+    for (auto i = regCount; i > 0; --i) {
+      InterfaceMapPtr iMapCopy(std::make_shared<InterfaceMap>(*interfaceMap));
+      regs.push_back(fc.RegisterService(
+        iMapCopy,
+        { { Constants::SERVICE_RANKING, Any(static_cast<int>(i % 10)) } }));
+    }
+    // unregister the oldest services first, which are spread across the
+    // whole ranking order
+    for (auto& reg : regs) {
+      reg.Unregister();
+    }
+    auto end = high_resolution_clock::now();
+    auto elapsed_seconds = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+  }
+  state.SetItemsProcessed(state.iterations() * regCount);
+}
+
+// the parameter specifies the number of services registered and then
+// unregistered under the same interface
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, RegisterUnregisterServices)
+  ->RangeMultiplier(10)
+  ->Range(10, 100000)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+
 BENCHMARK_DEFINE_F(ServiceRegistryFixture, ModifyServices)
 (benchmark::State& state)
 {
@@ -228,3 +273,307 @@ BENCHMARK_REGISTER_F(ServiceRegistryFixture, ModifyServices)
 ->RangeMultiplier(4)
 ->Ranges({ { 1, 1000 }, { 1, 1000 } })
 ->UseManualTime();
+
+namespace {
+/*
+ * Adds listeners whose filters are not served by the listener cache, so
+ * that each service event evaluates every filter against the service
+ * properties.
+ */
+std::vector<ListenerToken> AddFilteredListeners(BundleContext& fc,
+                                                int64_t listenerCount)
+{
+  std::vector<ListenerToken> tokens;
+  for (auto i = listenerCount; i > 0; --i) {
+    tokens.push_back(fc.AddServiceListener(
+      [](const ServiceEvent&) {},
+      "(&(objectclass=TestInterface1)(perf.service.value>=" +
+        std::to_string(i) + "))"));
+  }
+  return tokens;
+}
+}
+
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, RegisterServicesAllocations)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  auto listenerCount = state.range(0);
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+  auto tokens = AddFilteredListeners(fc, listenerCount);
+
+  std::size_t allocations = 0;
+  for (auto _ : state) {
+    InterfaceMapPtr iMapCopy(std::make_shared<InterfaceMap>(*interfaceMap));
+    ServiceProperties props{ { "perf.service.value", Any(50) } };
+    ServiceRegistrationU reg;
+    {
+      benchmark::test::AllocationCounter counter;
+      reg = fc.RegisterService(iMapCopy, std::move(props));
+      allocations += counter.Count();
+    }
+    state.PauseTiming();
+    reg.Unregister();
+    state.ResumeTiming();
+  }
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+// the parameter specifies the number of service listeners with filters
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, RegisterServicesAllocations)
+  ->RangeMultiplier(10)
+  ->Range(1, 1000);
+
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, ModifyServicesAllocations)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  auto listenerCount = state.range(0);
+  auto tokens = AddFilteredListeners(fc, listenerCount);
+  auto reg = fc.RegisterService(MakeInterfaceMapWithNInterfaces(1),
+                                { { "perf.service.value", Any(50) } });
+
+  std::size_t allocations = 0;
+  int value = 0;
+  for (auto _ : state) {
+    ServiceProperties props{ { "perf.service.value", Any(value++ % 100) } };
+    benchmark::test::AllocationCounter counter;
+    reg.SetProperties(std::move(props));
+    allocations += counter.Count();
+  }
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+
+  reg.Unregister();
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+// the parameter specifies the number of service listeners with filters
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, ModifyServicesAllocations)
+  ->RangeMultiplier(10)
+  ->Range(1, 1000);
+
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, ServiceEventThroughput)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  auto listenerCount = state.range(0);
+
+  // One listener per interface, like a ServiceTracker for each of them
+  std::vector<ListenerToken> tokens;
+  for (auto i = listenerCount; i > 0; --i) {
+    tokens.push_back(fc.AddServiceListener(
+      [](const ServiceEvent&) {},
+      "(objectclass=TestInterface" + std::to_string(i) + ")"));
+  }
+  auto reg = fc.RegisterService(MakeInterfaceMapWithNInterfaces(1),
+                                { { "perf.service.value", Any(0) } });
+
+  int value = 0;
+  for (auto _ : state) {
+    reg.SetProperties({ { "perf.service.value", Any(++value) } });
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  reg.Unregister();
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+// the parameter specifies the number of service listeners, of which one
+// matches the modified service
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, ServiceEventThroughput)
+  ->RangeMultiplier(10)
+  ->Range(10, 10000);
+
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, UpdateLoadProperty)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  const bool patch = state.range(0) != 0;
+  auto listenerCount = state.range(1);
+
+  // Listeners which select providers by name, and a few which watch the
+  // load of all providers
+  std::vector<ListenerToken> tokens;
+  for (auto i = listenerCount; i > 0; --i) {
+    const std::string filter =
+      i % 10 == 0 ? "(perf.service.load<=" + std::to_string(i % 100) + ")"
+                  : "(&(perf.service.name=provider" + std::to_string(i) +
+                      ")(perf.service.vendor=acme))";
+    tokens.push_back(fc.AddServiceListener([](const ServiceEvent&) {}, filter));
+  }
+
+  std::vector<ServiceRegistrationU> regs;
+  for (int i = 0; i < 200; ++i) {
+    regs.push_back(fc.RegisterService(
+      MakeInterfaceMapWithNInterfaces(1),
+      { { "perf.service.name", Any("provider" + std::to_string(i)) },
+        { "perf.service.vendor", Any(std::string("acme")) },
+        { "perf.service.version", Any(std::string("1.0.0")) },
+        { "perf.service.load", Any(0) } }));
+  }
+
+  int load = 0;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < regs.size(); ++i) {
+      ++load;
+      if (patch) {
+        regs[i].UpdateProperties({ { "perf.service.load", Any(load % 100) } });
+      } else {
+        // SetProperties needs all properties, which the caller would keep
+        regs[i].SetProperties(
+          { { "perf.service.name", Any("provider" + std::to_string(i)) },
+            { "perf.service.vendor", Any(std::string("acme")) },
+            { "perf.service.version", Any(std::string("1.0.0")) },
+            { "perf.service.load", Any(load % 100) } });
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(regs.size()));
+
+  for (auto& reg : regs) {
+    reg.Unregister();
+  }
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+// the first parameter selects SetProperties (0) or UpdateProperties (1),
+// the second the number of service listeners with filters
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, UpdateLoadProperty)
+  ->ArgsProduct({ { 0, 1 }, { 10, 100, 1000 } })
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(ServiceRegistryFixture, TenantFilteredEventThroughput)
+(benchmark::State& state)
+{
+  auto fc = framework->GetBundleContext();
+  auto listenerCount = state.range(0);
+
+  // One tracker per tenant of the interface
+  std::vector<ListenerToken> tokens;
+  for (auto i = listenerCount; i > 0; --i) {
+    tokens.push_back(fc.AddServiceListener(
+      [](const ServiceEvent&) {},
+      "(&(objectclass=TestInterface1)(tenant=tenant" + std::to_string(i) +
+        "))"));
+  }
+  auto reg = fc.RegisterService(
+    MakeInterfaceMapWithNInterfaces(1),
+    { { "tenant", Any(std::string("tenant1")) },
+      { "perf.service.value", Any(0) } });
+
+  int value = 0;
+  for (auto _ : state) {
+    reg.UpdateProperties({ { "perf.service.value", Any(++value) } });
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  reg.Unregister();
+  for (auto& token : tokens) {
+    fc.RemoveListener(std::move(token));
+  }
+}
+
+// the parameter specifies the number of service listeners, of which one
+// matches the modified service
+BENCHMARK_REGISTER_F(ServiceRegistryFixture, TenantFilteredEventThroughput)
+  ->RangeMultiplier(10)
+  ->Range(10, 10000);
+
+static void RankChurn(benchmark::State& state)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_SNAPSHOTS] = state.range(1) != 0;
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto fc = framework.GetBundleContext();
+  auto regCount = state.range(0);
+
+  std::vector<ServiceRegistrationU> regs;
+  for (auto i = regCount; i > 0; --i) {
+    regs.push_back(
+      fc.RegisterService(MakeInterfaceMapWithNInterfaces(1),
+                         { { Constants::SERVICE_RANKING, Any(0) } }));
+  }
+
+  // A load balancer moving single providers up and down the ranking
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> provider(0, regs.size() - 1);
+  std::uniform_int_distribution<int> rank(0, 999);
+  for (auto _ : state) {
+    regs[provider(gen)].SetProperties(
+      { { Constants::SERVICE_RANKING, Any(rank(gen)) } });
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  for (auto& reg : regs) {
+    reg.Unregister();
+  }
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// the first parameter specifies the number of providers of the interface,
+// the second whether Constants::FRAMEWORK_SERVICE_SNAPSHOTS is set
+BENCHMARK(RankChurn)->ArgsProduct({ { 20, 200, 2000 }, { 0, 1 } });
+
+static void SlowListenerLatency(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_EVENT_THREADS] =
+    static_cast<int>(state.range(1));
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto fc = framework.GetBundleContext();
+
+  // listeners doing some blocking work, like I/O, for each event
+  for (auto i = state.range(0); i > 0; --i) {
+    fc.AddServiceListener([](const ServiceEvent&) {
+      std::this_thread::sleep_for(microseconds(100));
+    });
+  }
+
+  auto interfaceMap = MakeInterfaceMapWithNInterfaces(1);
+  std::vector<double> latencies;
+  for (auto _ : state) {
+    auto start = high_resolution_clock::now();
+    fc.RegisterService(interfaceMap).Unregister();
+    auto elapsed_seconds =
+      duration_cast<duration<double>>(high_resolution_clock::now() - start);
+    state.SetIterationTime(elapsed_seconds.count());
+    latencies.push_back(elapsed_seconds.count());
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (!latencies.empty()) {
+    auto p99 = latencies.begin() + (latencies.size() * 99) / 100;
+    std::nth_element(latencies.begin(), p99, latencies.end());
+    state.counters["p99_us"] = *p99 * 1e6;
+  }
+
+  // includes delivering the remaining events
+  framework.Stop();
+  framework.WaitForStop(milliseconds::zero());
+}
+
+// the first parameter specifies the number of service listeners which take
+// 100 microseconds per event, the second the number of service event
+// threads (Constants::FRAMEWORK_SERVICE_EVENT_THREADS)
+BENCHMARK(SlowListenerLatency)
+  ->ArgsProduct({ { 1, 4 }, { 0, 2 } })
+  ->Unit(benchmark::kMicrosecond)
+  ->UseManualTime();
@@ -7,7 +7,9 @@
 #include <cppmicroservices/ServiceTracker.h>
 
 #include <chrono>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "fooservice.h"
@@ -190,6 +192,49 @@ BENCHMARK_DEFINE_F(ServiceTrackerFixture,
   }
 }
 
+/// Benchmark concurrent ServiceTracker::GetService calls on a cached service
+BENCHMARK_DEFINE_F(ServiceTrackerFixture, ConcurrentGetService)
+(benchmark::State& state)
+{
+  using namespace std::chrono;
+  using namespace benchmark::test;
+  using namespace cppmicroservices;
+
+  constexpr int64_t callsPerThread = 100000;
+  const auto numThreads = static_cast<std::size_t>(state.range(0));
+
+  auto fc = framework->GetBundleContext();
+  auto serviceReg = fc.RegisterService<Foo>(std::make_shared<FooImpl>());
+  ServiceTracker<Foo> fooTracker(fc);
+  fooTracker.Open();
+  if (!fooTracker.GetService()) {
+    state.SkipWithError("ServiceTracker did not track the service");
+  }
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    auto start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < numThreads; ++i) {
+      threads.emplace_back([&fooTracker]() {
+        for (int64_t j = 0; j < callsPerThread; ++j) {
+          benchmark::DoNotOptimize(fooTracker.GetService());
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end = high_resolution_clock::now();
+    auto elapsed_seconds = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          callsPerThread);
+
+  fooTracker.Close();
+}
+
 static void CloseServiceTracker(benchmark::State& state)
 {
   using namespace std::chrono;
@@ -228,6 +273,10 @@ BENCHMARK_REGISTER_F(ServiceTrackerFixture, OpenServiceTrackerWithBundleContext)
   ->UseManualTime();
 BENCHMARK_REGISTER_F(ServiceTrackerFixture, OpenServiceTrackerWithInterfaceName)
   ->UseManualTime();
+BENCHMARK_REGISTER_F(ServiceTrackerFixture, ConcurrentGetService)
+  ->RangeMultiplier(2)
+  ->Range(1, 8)
+  ->UseManualTime();
 BENCHMARK(CloseServiceTracker)
   ->RangeMultiplier(2)
   ->Range(1000, 1000000);
@@ -0,0 +1,47 @@
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocationCount{ 0 };
+std::atomic<std::size_t> allocatedBytes{ 0 };
+}
+
+namespace benchmark {
+namespace test {
+
+std::size_t GetAllocationCount()
+{
+  return allocationCount.load(std::memory_order_relaxed);
+}
+
+std::size_t GetAllocatedBytes()
+{
+  return allocatedBytes.load(std::memory_order_relaxed);
+}
+}
+}
+
+// Replace the global (non-aligned) allocation functions. The array
+// forms and the default nothrow forms forward to these.
+void* operator new(std::size_t size)
+{
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
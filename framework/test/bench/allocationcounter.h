@@ -0,0 +1,48 @@
+#ifndef CPPMICROSERVICES_BENCH_ALLOCATIONCOUNTER_H
+#define CPPMICROSERVICES_BENCH_ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+namespace benchmark {
+namespace test {
+
+/**
+ * Returns the number of calls to the global operator new made by this
+ * process since it started.
+ *
+ * The counting operator new is defined in allocationcounter.cpp. On
+ * platforms where the framework is a shared library with its own heap
+ * (e.g. Windows DLLs) allocations made inside the framework are not
+ * counted.
+ */
+std::size_t GetAllocationCount();
+
+/**
+ * Returns the number of bytes requested from the global operator new by
+ * this process since it started. Deallocations are not subtracted.
+ */
+std::size_t GetAllocatedBytes();
+
+/**
+ * Counts the allocations made during the lifetime of an instance.
+ */
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+    : start(GetAllocationCount())
+    , startBytes(GetAllocatedBytes())
+  {}
+
+  std::size_t Count() const { return GetAllocationCount() - start; }
+
+  std::size_t Bytes() const { return GetAllocatedBytes() - startBytes; }
+
+private:
+  std::size_t start;
+  std::size_t startBytes;
+};
+}
+}
+
+#endif // CPPMICROSERVICES_BENCH_ALLOCATIONCOUNTER_H
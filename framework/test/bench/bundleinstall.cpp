@@ -2,14 +2,25 @@
 #include <cppmicroservices/Bundle.h>
 #include <cppmicroservices/BundleContext.h>
 #include <cppmicroservices/BundleEvent.h>
+#include <cppmicroservices/Constants.h>
 #include <cppmicroservices/Framework.h>
 #include <cppmicroservices/FrameworkEvent.h>
 #include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/BundleObjFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
 #include <future>
 
 #include "TestUtils.h"
+#include "TestingConfig.h"
 #include "benchmark/benchmark.h"
 
+namespace {
+struct BootstrapService
+{
+  virtual ~BootstrapService() = default;
+};
+}
+
 class BundleInstallFixture : public ::benchmark::Fixture
 {
 public:
@@ -61,6 +72,247 @@ protected:
     framework.WaitForStop(std::chrono::milliseconds::zero());
   }
 
+  // Registers the services an activator would register on bundle start,
+  // with listeners for them already in place
+  void RegisterBootstrapServices(benchmark::State& state, bool batched)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    auto framework = cppmicroservices::FrameworkFactory().NewFramework();
+    framework.Start();
+    auto context = framework.GetBundleContext();
+
+    std::vector<ListenerToken> tokens;
+    for (auto i = state.range(1); i > 0; --i) {
+      tokens.push_back(context.AddServiceListener(
+        [](const ServiceEvent&) {},
+        "(objectclass=" + us_service_interface_iid<BootstrapService>() +
+          ")"));
+    }
+
+    std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+    for (auto i = state.range(0); i > 0; --i) {
+      services.emplace_back(
+        MakeInterfaceMap<BootstrapService>(
+          std::make_shared<BootstrapService>()),
+        ServiceProperties{ { "bootstrap.index", Any(static_cast<int>(i)) } });
+    }
+
+    for (auto _ : state) {
+      std::vector<ServiceRegistrationU> regs;
+      auto start = high_resolution_clock::now();
+      if (batched) {
+        regs = context.RegisterServices(services);
+      } else {
+        for (auto& service : services) {
+          regs.push_back(
+            context.RegisterService(service.first, service.second));
+        }
+      }
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+
+      for (auto& reg : regs) {
+        reg.Unregister();
+      }
+    }
+
+    for (auto& token : tokens) {
+      context.RemoveListener(std::move(token));
+    }
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  // Writes bundleCount zip bundles to dir, each with a manifest and
+  // resourceCount small resource files, and returns their locations.
+  static std::vector<std::string> MakeZipBundles(const std::string& dir,
+                                                 int64_t bundleCount,
+                                                 int resourceCount)
+  {
+    using namespace cppmicroservices;
+
+    std::vector<std::string> locations;
+    for (auto i = bundleCount; i > 0; --i) {
+      std::string name("bundle_" + std::to_string(i));
+      std::vector<std::pair<std::string, std::string>> resources;
+      for (int r = 0; r < resourceCount; ++r) {
+        std::string resource("resources/file_" + std::to_string(r));
+        resources.emplace_back(resource, name + "/" + resource);
+      }
+      locations.push_back(dir + util::DIR_SEP + name + ".zip");
+      testing::WriteZipBundle(locations.back(), name, resources);
+    }
+    return locations;
+  }
+
+  // Installs generated zip bundles one location after the other, or all
+  // locations with a single BundleContext::InstallBundles call.
+  void InstallZipBundles(benchmark::State& state, bool batched)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    testing::TempDir bundleDir(testing::MakeUniqueTempDirectory());
+    auto locations = MakeZipBundles(bundleDir.Path, state.range(0), 20);
+
+    for (auto _ : state) {
+      auto framework = FrameworkFactory().NewFramework();
+      framework.Start();
+      auto context = framework.GetBundleContext();
+
+      auto start = high_resolution_clock::now();
+      if (batched) {
+        context.InstallBundles(locations);
+      } else {
+        for (auto const& location : locations) {
+          context.InstallBundles(location);
+        }
+      }
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  // Starts and stops generated zip bundles while bundle listeners, or
+  // bundle events listeners, are registered, which is dominated by the
+  // dispatching of the bundle events
+  void StartStopZipBundles(benchmark::State& state)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    testing::TempDir bundleDir(testing::MakeUniqueTempDirectory());
+    auto locations = MakeZipBundles(bundleDir.Path, state.range(0), 0);
+
+    auto framework = FrameworkFactory().NewFramework();
+    framework.Start();
+    auto context = framework.GetBundleContext();
+    auto bundles = context.InstallBundles(locations);
+
+    std::size_t events = 0;
+    for (auto i = state.range(1); i > 0; --i) {
+      if (state.range(2) == 0) {
+        context.AddBundleListener([&events](const BundleEvent&) { ++events; });
+      } else {
+        context.AddBundleEventsListener(
+          [&events](const std::vector<BundleEvent>& evts) {
+            events += evts.size();
+          });
+      }
+    }
+
+    for (auto _ : state) {
+      auto start = high_resolution_clock::now();
+      for (auto& bundle : bundles) {
+        bundle.Start();
+      }
+      for (auto& bundle : bundles) {
+        bundle.Stop();
+      }
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+    }
+    benchmark::DoNotOptimize(events);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    framework.Stop();
+    framework.WaitForStop(milliseconds::zero());
+  }
+
+  // Installs bundleCount generated zip bundles into a framework with the
+  // bundle cache enabled. A warm run restarts the framework on the storage
+  // the previous run left behind, a cold run starts from clean storage.
+  void InstallWithBundleCache(benchmark::State& state, bool warm)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    testing::TempDir bundleDir(testing::MakeUniqueTempDirectory());
+    testing::TempDir storage(testing::MakeUniqueTempDirectory());
+    auto locations = MakeZipBundles(bundleDir.Path, state.range(0), 0);
+
+    FrameworkConfiguration config{
+      { Constants::FRAMEWORK_STORAGE, storage.Path },
+      { Constants::FRAMEWORK_BUNDLE_CACHE, true }
+    };
+    if (!warm) {
+      config[Constants::FRAMEWORK_STORAGE_CLEAN] =
+        Constants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT;
+    }
+
+    auto installAll = [&locations](Framework& framework) {
+      auto context = framework.GetBundleContext();
+      for (auto const& location : locations) {
+        context.InstallBundles(location);
+      }
+    };
+
+    if (warm) {
+      auto framework = FrameworkFactory().NewFramework(config);
+      framework.Start();
+      installAll(framework);
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+
+    for (auto _ : state) {
+      auto start = high_resolution_clock::now();
+      auto framework = FrameworkFactory().NewFramework(config);
+      framework.Start();
+      installAll(framework);
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+
+      framework.Stop();
+      framework.WaitForStop(milliseconds::zero());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
+  // Reads the resource section of bundle libraries, which is the part of
+  // a bundle install that parses the object file
+  void ReadBundleObjFiles(benchmark::State& state)
+  {
+    using namespace std::chrono;
+    using namespace cppmicroservices;
+
+    std::vector<std::string> locations;
+    for (auto name : { "TestBundleA",   "TestBundleA2",     "TestBundleB",
+                       "TestBundleC1",  "TestBundleH",      "TestBundleLQ",
+                       "TestBundleM",   "TestBundleR",      "TestBundleRA",
+                       "TestBundleRL",  "TestBundleS",      "TestBundleSL1",
+                       "TestBundleSL3", "TestBundleSL4",    "TestStartBundleA",
+                       "TestStopBundleA", "dummyService",   "largeBundle" }) {
+      locations.push_back(testing::LIB_PATH + util::DIR_SEP + US_LIB_PREFIX +
+                          name + US_LIB_POSTFIX + US_LIB_EXT);
+    }
+
+    for (auto _ : state) {
+      auto start = high_resolution_clock::now();
+      for (auto i = state.range(0); i > 0; --i) {
+        auto objFile = BundleObjFactory().CreateBundleFileObj(
+          locations[static_cast<std::size_t>(i) % locations.size()]);
+        // null for bundles with resources appended to the library
+        auto resources = objFile->GetRawBundleResourceContainer();
+        benchmark::DoNotOptimize(resources);
+      }
+      auto end = high_resolution_clock::now();
+      auto elapsed = duration_cast<duration<double>>(end - start);
+      state.SetIterationTime(elapsed.count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+
   void InstallConcurrently(benchmark::State& state, uint32_t numThreads)
   {
     using namespace std::chrono;
@@ -136,6 +388,56 @@ BENCHMARK_DEFINE_F(BundleInstallFixture, LargeBundleInstallCppFramework)
   InstallWithCppFramework(state, "largeBundle");
 }
 
+BENCHMARK_DEFINE_F(BundleInstallFixture, BootstrapRegisterServices)
+(benchmark::State& state)
+{
+  RegisterBootstrapServices(state, false);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, BootstrapRegisterServicesBatched)
+(benchmark::State& state)
+{
+  RegisterBootstrapServices(state, true);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, ZipBundlesInstall)
+(benchmark::State& state)
+{
+  InstallZipBundles(state, false);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, ZipBundlesInstallBatched)
+(benchmark::State& state)
+{
+  InstallZipBundles(state, true);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, ZipBundlesStartStop)
+(benchmark::State& state)
+{
+  StartStopZipBundles(state);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, BundleCacheColdStart)
+(benchmark::State& state)
+{
+  InstallWithBundleCache(state, false);
+}
+
+BENCHMARK_DEFINE_F(BundleInstallFixture, BundleCacheWarmStart)
+(benchmark::State& state)
+{
+  InstallWithBundleCache(state, true);
+}
+
+#ifdef US_BUILD_SHARED_LIBS
+BENCHMARK_DEFINE_F(BundleInstallFixture, BundleObjFileRead)
+(benchmark::State& state)
+{
+  ReadBundleObjFiles(state);
+}
+#endif
+
 #if defined(PERFORM_LARGE_CONCURRENCY_TEST)
 BENCHMARK_DEFINE_F(BundleInstallFixture, ConcurrentBundleInstall1Thread)
 (benchmark::State& state)
@@ -173,6 +475,48 @@ BENCHMARK_REGISTER_F(BundleInstallFixture, BundleInstallCppFramework)
   ->UseManualTime();
 BENCHMARK_REGISTER_F(BundleInstallFixture, LargeBundleInstallCppFramework)
   ->UseManualTime();
+// first parameter in Ranges specifies the number of services registered
+// second parameter in Ranges specifies the number of service listeners
+BENCHMARK_REGISTER_F(BundleInstallFixture, BootstrapRegisterServices)
+  ->RangeMultiplier(10)
+  ->Ranges({ { 10, 1000 }, { 1, 100 } })
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleInstallFixture, BootstrapRegisterServicesBatched)
+  ->RangeMultiplier(10)
+  ->Ranges({ { 10, 1000 }, { 1, 100 } })
+  ->UseManualTime();
+// parameter specifies the number of bundle libraries installed
+BENCHMARK_REGISTER_F(BundleInstallFixture, ZipBundlesInstall)
+  ->Arg(400)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleInstallFixture, ZipBundlesInstallBatched)
+  ->Arg(400)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+// first parameter specifies the number of bundles started and stopped,
+// second the number of listeners, third whether they are bundle listeners
+// (0) or bundle events listeners (1)
+BENCHMARK_REGISTER_F(BundleInstallFixture, ZipBundlesStartStop)
+  ->ArgsProduct({ { 400 }, { 1, 100 }, { 0, 1 } })
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+// parameter specifies the number of bundles installed on framework start
+BENCHMARK_REGISTER_F(BundleInstallFixture, BundleCacheColdStart)
+  ->Arg(500)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+BENCHMARK_REGISTER_F(BundleInstallFixture, BundleCacheWarmStart)
+  ->Arg(500)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+#ifdef US_BUILD_SHARED_LIBS
+// parameter specifies the number of bundle libraries read
+BENCHMARK_REGISTER_F(BundleInstallFixture, BundleObjFileRead)
+  ->Arg(1000)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+#endif
 #if defined(PERFORM_LARGE_CONCURRENCY_TEST)
 BENCHMARK_REGISTER_F(BundleInstallFixture, ConcurrentBundleInstall1Thread)
   ->UseManualTime();
@@ -0,0 +1,84 @@
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TestUtils.h"
+#include "benchmark/benchmark.h"
+
+using namespace cppmicroservices;
+
+namespace {
+
+constexpr int LookupsPerThread = 1000;
+
+// Writes a zip bundle with only a manifest and returns its location
+std::string MakeBundle(const std::string& dir, int64_t i)
+{
+  std::string name("lookup_bundle_" + std::to_string(i));
+  auto location = dir + util::DIR_SEP + name + ".zip";
+  testing::WriteZipBundle(location, name, {}, false);
+  return location;
+}
+}
+
+// Looks up installed bundles by id, LookupsPerThread times on each of
+// state.range(0) threads, in a framework with state.range(1) bundles
+static void ConcurrentGetBundleById(benchmark::State& state)
+{
+  using namespace std::chrono;
+
+  testing::TempDir dir(testing::MakeUniqueTempDirectory());
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+  std::vector<long> ids;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    ids.push_back(
+      context.InstallBundles(MakeBundle(dir.Path, i)).at(0).GetBundleId());
+  }
+
+  auto numThreads = state.range(0);
+  for (auto _ : state) {
+    auto start = high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int64_t i = 0; i < numThreads; ++i) {
+      threads.emplace_back([&context, &ids, i] {
+        for (int j = 0; j < LookupsPerThread; ++j) {
+          auto id = ids[(i * LookupsPerThread + j) * 7919 % ids.size()];
+          benchmark::DoNotOptimize(context.GetBundle(id));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    auto end = high_resolution_clock::now();
+    auto elapsed_seconds = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+  }
+  state.SetItemsProcessed(state.iterations() * numThreads * LookupsPerThread);
+
+  framework.Stop();
+  framework.WaitForStop(milliseconds::zero());
+}
+
+// The arguments are the number of reader threads and the number of
+// installed bundles
+BENCHMARK(ConcurrentGetBundleById)
+  ->Args({ 1, 100 })
+  ->Args({ 4, 100 })
+  ->Args({ 16, 100 })
+  ->Args({ 1, 2000 })
+  ->Args({ 4, 2000 })
+  ->Args({ 16, 2000 })
+  ->UseManualTime();
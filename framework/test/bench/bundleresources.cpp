@@ -0,0 +1,312 @@
+#include <cppmicroservices/Bundle.h>
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/BundleResource.h>
+#include <cppmicroservices/BundleResourceStream.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/util/FileSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TestUtils.h"
+#include "allocationcounter.h"
+#include "benchmark/benchmark.h"
+
+#if defined(__GLIBC__)
+#  include <malloc.h>
+#endif
+
+using namespace cppmicroservices;
+
+namespace {
+
+const int NumResourceDirs = 100;
+
+std::string ResourceDir(int64_t i)
+{
+  return "dir_" + std::to_string(i) + "/";
+}
+
+// Writes a bundle with resourceCount resources, spread over
+// NumResourceDirs directories, and returns its location.
+std::string MakeResourceBundle(const std::string& dir,
+                               int64_t resourceCount,
+                               const std::string& resourceData = "{}",
+                               bool compress = false)
+{
+  const std::string name("resource_bundle");
+  auto location = dir + util::DIR_SEP + name + ".zip";
+
+  std::vector<std::pair<std::string, std::string>> resources;
+  for (int i = 0; i < NumResourceDirs; ++i) {
+    resources.emplace_back(ResourceDir(i), std::string());
+  }
+  for (int64_t i = 0; i < resourceCount; ++i) {
+    resources.emplace_back(ResourceDir(i % NumResourceDirs) +
+                             "some_resource_file_" + std::to_string(i) +
+                             ".json",
+                           resourceData);
+  }
+  testing::WriteZipBundle(location, name, resources, compress);
+  return location;
+}
+
+// Returns the number of bytes of heap memory in use, or 0 if it is not
+// known. Unlike the allocation counter, this includes the memory which
+// miniz allocates with malloc.
+std::size_t HeapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+// Measures installing a bundle, which builds the index of its resources.
+// The "bytes" and "allocs" counters are the memory allocated per install.
+void InstallResourceBundle(benchmark::State& state,
+                           const std::function<Bundle(BundleContext)>& install)
+{
+  using namespace std::chrono;
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  std::size_t bytes = 0;
+  std::size_t allocations = 0;
+  for (auto _ : state) {
+    benchmark::test::AllocationCounter counter;
+    auto start = high_resolution_clock::now();
+    auto bundle = install(context);
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed.count());
+    bytes += counter.Bytes();
+    allocations += counter.Count();
+    bundle.Uninstall();
+  }
+  state.counters["bytes"] = benchmark::Counter(
+    static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+
+  framework.Stop();
+  framework.WaitForStop(milliseconds::zero());
+}
+
+// Measures reading all of the given resources on state.range(0) threads
+// at once.
+void ReadResourcesConcurrently(benchmark::State& state,
+                               const std::vector<BundleResource>& resources)
+{
+  using namespace std::chrono;
+
+  const auto numThreads = static_cast<std::size_t>(state.range(0));
+  int64_t bytes = 0;
+  for (const auto& res : resources) {
+    bytes += res.GetSize();
+  }
+
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    auto start = high_resolution_clock::now();
+    for (std::size_t i = 0; i < numThreads; ++i) {
+      threads.emplace_back([&resources]() {
+        for (const auto& res : resources) {
+          BundleResourceStream rs(res, std::ios_base::binary);
+          std::string data(static_cast<std::size_t>(res.GetSize()), '\0');
+          rs.read(&data[0], res.GetSize());
+          benchmark::DoNotOptimize(data);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end = high_resolution_clock::now();
+    auto elapsed = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed.count());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * bytes);
+}
+}
+
+static void BundleResourceIndexLargeBundle(benchmark::State& state)
+{
+  InstallResourceBundle(state, [](BundleContext context) {
+    return testing::InstallLib(context, "largeBundle");
+  });
+}
+
+static void BundleResourceIndexGenerated(benchmark::State& state)
+{
+  testing::TempDir dir(testing::MakeUniqueTempDirectory());
+  auto location = MakeResourceBundle(dir.Path, state.range(0));
+  InstallResourceBundle(state, [&location](BundleContext context) {
+    return context.InstallBundles(location).at(0);
+  });
+}
+
+// Measures listing the resources of one directory of a bundle
+static void BundleResourceFindInDirectory(benchmark::State& state)
+{
+  testing::TempDir dir(testing::MakeUniqueTempDirectory());
+  auto location = MakeResourceBundle(dir.Path, state.range(0));
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle = framework.GetBundleContext().InstallBundles(location).at(0);
+
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto resources =
+      bundle.FindResources(ResourceDir(i++ % NumResourceDirs), "*", false);
+    benchmark::DoNotOptimize(resources);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Reads the resources of a bundle library, which are linked into the
+// library and read from memory
+static void BundleResourceReadInMemory(benchmark::State& state)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle =
+    testing::InstallLib(framework.GetBundleContext(), "largeStoredBundle");
+
+  ReadResourcesConcurrently(state, bundle.FindResources("", "*", true));
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Reads the resources of a zip file bundle, which are read from the file
+static void BundleResourceReadFromZipFile(benchmark::State& state)
+{
+  testing::TempDir dir(testing::MakeUniqueTempDirectory());
+  auto location =
+    MakeResourceBundle(dir.Path, 64, std::string(64 * 1024, 'x'));
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle = framework.GetBundleContext().InstallBundles(location).at(0);
+
+  ReadResourcesConcurrently(state, bundle.FindResources("", "*.json", true));
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Opens a stream on the 10 MB resource of largeStoredBundle, which is
+// stored uncompressed in the bundle library, and reads its first bytes
+static void BundleResourceOpenStored(benchmark::State& state)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle =
+    testing::InstallLib(framework.GetBundleContext(), "largeStoredBundle");
+  auto resource = bundle.GetResource("largeRes.zip");
+
+  char buffer[4096];
+  for (auto _ : state) {
+    BundleResourceStream rs(resource, std::ios_base::binary);
+    rs.read(buffer, sizeof(buffer));
+    benchmark::DoNotOptimize(buffer);
+  }
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+// Reads a 64 MB compressed resource of a zip file bundle in chunks. The
+// parameter specifies the window size of the stream, 0 reads the whole
+// resource at once. The "peak_heap" counter is the most heap memory in
+// use while reading, on platforms where it is known.
+static void BundleResourceReadLarge(benchmark::State& state)
+{
+  const std::size_t resourceSize = 64 * 1024 * 1024;
+  std::string data;
+  data.reserve(resourceSize);
+  for (int i = 0; data.size() < resourceSize; ++i) {
+    data += std::to_string((i * 7919) % 100003) + ",";
+  }
+  testing::TempDir dir(testing::MakeUniqueTempDirectory());
+  auto location =
+    MakeResourceBundle(dir.Path, 1, data, true);
+  data = std::string();
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bundle = framework.GetBundleContext().InstallBundles(location).at(0);
+  auto resource =
+    bundle.GetResource(ResourceDir(0) + "some_resource_file_0.json");
+
+  const auto windowSize = static_cast<std::size_t>(state.range(0));
+  std::vector<char> buffer(1024 * 1024);
+  std::size_t peakHeap = 0;
+  for (auto _ : state) {
+    const std::size_t baseline = HeapInUse();
+    auto rs = windowSize == 0 ? std::make_unique<BundleResourceStream>(
+                                  resource, std::ios_base::binary)
+                              : std::make_unique<BundleResourceStream>(
+                                  resource,
+                                  BundleResourceStream::Window(windowSize),
+                                  std::ios_base::binary);
+    while (rs->read(buffer.data(), buffer.size()) || rs->gcount() > 0) {
+      peakHeap = std::max(peakHeap, HeapInUse() - baseline);
+      benchmark::DoNotOptimize(buffer.data());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * resource.GetSize());
+  state.counters["peak_heap"] = static_cast<double>(peakHeap);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+BENCHMARK(BundleResourceIndexLargeBundle)->UseManualTime();
+// parameter specifies the number of resources in the bundle
+BENCHMARK(BundleResourceIndexGenerated)
+  ->Arg(1000)
+  ->Arg(20000)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+BENCHMARK(BundleResourceFindInDirectory)->Arg(1000)->Arg(20000);
+BENCHMARK(BundleResourceOpenStored);
+// parameter specifies the number of reading threads
+BENCHMARK(BundleResourceReadInMemory)
+  ->Arg(1)
+  ->Arg(2)
+  ->Arg(4)
+  ->Arg(8)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+BENCHMARK(BundleResourceReadFromZipFile)
+  ->Arg(1)
+  ->Arg(2)
+  ->Arg(4)
+  ->Arg(8)
+  ->Unit(benchmark::kMillisecond)
+  ->UseManualTime();
+// parameter specifies the window size in bytes
+BENCHMARK(BundleResourceReadLarge)
+  ->Arg(0)
+  ->Arg(64 * 1024)
+  ->Arg(1024 * 1024)
+  ->Unit(benchmark::kMillisecond);
@@ -7,6 +7,7 @@
 #include <cppmicroservices/LDAPProp.h>
 
 #include "TestUtils.h"
+#include "allocationcounter.h"
 #include "benchmark/benchmark.h"
 #include "fooservice.h"
 
@@ -116,6 +117,46 @@ static void MatchFilterWithServiceReference(benchmark::State& state,
   }
 }
 
+// A filter whose operands are numbers, booleans and approximate
+// strings, which are resolved when the filter is constructed.
+LDAPFilter GetTypedLDAPFilter()
+{
+  return LDAPFilter("(&(bundle_rank>=10)(bundle_load<=0.75)(Status=false)"
+                    "(bundle_start~=Greedy))");
+}
+
+template<class Filter>
+static void MatchTypedFilterWithServiceReference(benchmark::State& state,
+                                                 Filter filter)
+{
+  using namespace benchmark::test;
+
+  ScopedFramework scopedFramework;
+  ServiceProperties props;
+  auto framework = scopedFramework.framework;
+  props["bundle_rank"] = 42;
+  props["bundle_load"] = 0.5;
+  props["bundle_start"] = std::string("greedy");
+  props["Status"] = false;
+  auto s1 = std::make_shared<FooImpl>();
+  (void)framework.GetBundleContext().RegisterService<Foo>(s1, props);
+
+  auto sr = framework.GetBundleContext().GetServiceReference<Foo>();
+  if (!sr || !filter.Match(sr)) {
+    state.SkipWithError("Error: the service reference for interface 'Foo' "
+                        "does not match the filter.");
+  }
+
+  std::size_t allocations = 0;
+  for (auto _ : state) {
+    benchmark::test::AllocationCounter counter;
+    (void)filter.Match(sr);
+    allocations += counter.Count();
+  }
+  state.counters["allocs"] = benchmark::Counter(
+    static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
 // Register functions as benchmark
 BENCHMARK(ConstructFilterFromString);
 BENCHMARK(ConstructNonTrivialFilterFromString);
@@ -129,3 +170,6 @@ BENCHMARK_CAPTURE(MatchFilterWithServiceReference,
 BENCHMARK_CAPTURE(MatchFilterWithServiceReference,
                   Complex,
                   GetComplexLDAPFilter());
+BENCHMARK_CAPTURE(MatchTypedFilterWithServiceReference,
+                  Typed,
+                  GetTypedLDAPFilter());
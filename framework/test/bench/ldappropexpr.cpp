@@ -1,4 +1,6 @@
 #include "benchmark/benchmark.h"
+#include <cppmicroservices/AnyMap.h>
+#include <cppmicroservices/LDAPFilter.h>
 #include <cppmicroservices/LDAPProp.h>
 
 static void ConstructFilterIncremental(benchmark::State& state)
@@ -26,6 +28,28 @@ static void ConstructFilterNotOperator(benchmark::State& state)
   };
 }
 
+static void MatchFilterWithTypedOperands(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  LDAPPropExpr expr = LDAPProp("minProgLevel") >= 3;
+  expr &= LDAPProp("threshold") <= 0.5;
+  expr &= LDAPProp("IsDynamic") == "true";
+  expr &= LDAPProp("mode").Approx("Cloud Only");
+  LDAPFilter filter(expr);
+
+  AnyMap props(AnyMap::UNORDERED_MAP);
+  props["minProgLevel"] = 5;
+  props["threshold"] = 0.25;
+  props["IsDynamic"] = true;
+  props["mode"] = std::string("cloudonly");
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter.Match(props));
+  }
+}
+
 // Register functions as benchmarrk
 BENCHMARK(ConstructFilterIncremental);
 BENCHMARK(ConstructFilterNotOperator);
+BENCHMARK(MatchFilterWithTypedOperands);
@@ -0,0 +1,195 @@
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/LDAPFilter.h>
+#include <cppmicroservices/ServiceReference.h>
+
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef US_PLATFORM_WINDOWS
+#  include <string.h>
+#  define ci_compare strnicmp
+#else
+#  include <strings.h>
+#  define ci_compare strncasecmp
+#endif
+
+#include "benchmark/benchmark.h"
+
+#include "Properties.h"
+#include "fooservice.h"
+
+US_MSVC_PUSH_DISABLE_WARNING(4996)
+
+using namespace cppmicroservices;
+
+namespace {
+
+std::string PropertyKey(int64_t i)
+{
+  return "bench.property.key." + std::to_string(i);
+}
+
+std::vector<std::string> PropertyKeys(int64_t count)
+{
+  std::vector<std::string> keys;
+  for (int64_t i = 0; i < count; ++i) {
+    keys.push_back(PropertyKey(i));
+  }
+  return keys;
+}
+
+AnyMap MakeProperties(int64_t count)
+{
+  AnyMap props(AnyMap::UNORDERED_MAP);
+  for (int64_t i = 0; i < count; ++i) {
+    props[PropertyKey(i)] = std::string("value") + std::to_string(i);
+  }
+  return props;
+}
+
+ServiceProperties ToServiceProperties(const AnyMap& props)
+{
+  return ServiceProperties(props.begin(), props.end());
+}
+
+std::vector<std::string> UpperCase(std::vector<std::string> keys)
+{
+  for (auto& key : keys) {
+    for (auto& c : key) {
+      c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+  }
+  return keys;
+}
+
+// Mirrors the case-insensitive linear scan Properties used before it
+// maintained a hash index. Used as the baseline for the lookups below.
+class LinearProperties
+{
+public:
+  explicit LinearProperties(const AnyMap& props)
+  {
+    for (auto& p : props) {
+      keys.push_back(p.first);
+      values.push_back(p.second);
+    }
+  }
+
+  Any Value_unlocked(const std::string& key) const
+  {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      if (key.size() == keys[i].size() &&
+          ci_compare(key.c_str(), keys[i].c_str(), key.size()) == 0) {
+        return values[i];
+      }
+    }
+    return Any();
+  }
+
+private:
+  std::vector<std::string> keys;
+  std::vector<Any> values;
+};
+
+// Looks up every key once per iteration. Both property implementations
+// are built from the same map and queried with the same keys.
+template<class Props>
+void LookupAll(benchmark::State& state, bool upperCase)
+{
+  auto count = state.range(0);
+  auto data = MakeProperties(count);
+  Props props(data);
+  auto keys = PropertyKeys(count);
+  if (upperCase) {
+    keys = UpperCase(std::move(keys));
+  }
+  for (auto _ : state) {
+    for (auto& key : keys) {
+      benchmark::DoNotOptimize(props.Value_unlocked(key));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+class PropertiesFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State& state)
+  {
+    framework = std::make_shared<Framework>(FrameworkFactory().NewFramework());
+    framework->Start();
+    auto context = framework->GetBundleContext();
+    (void)context.RegisterService<benchmark::test::Foo>(
+      std::make_shared<benchmark::test::FooImpl>(),
+      ToServiceProperties(MakeProperties(state.range(0))));
+    ref = context.GetServiceReference<benchmark::test::Foo>();
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    using namespace std::chrono;
+
+    ref = nullptr;
+    framework->Stop();
+    framework->WaitForStop(milliseconds::zero());
+  }
+
+  ~PropertiesFixture() = default;
+
+  ServiceReferenceU ref;
+  std::shared_ptr<Framework> framework;
+};
+}
+
+static void PropertyLookupLinearScan(benchmark::State& state)
+{
+  LookupAll<LinearProperties>(state, false);
+}
+
+static void PropertyLookupLinearScanIgnoreCase(benchmark::State& state)
+{
+  LookupAll<LinearProperties>(state, true);
+}
+
+static void PropertyLookupIndexed(benchmark::State& state)
+{
+  LookupAll<Properties>(state, false);
+}
+
+static void PropertyLookupIndexedIgnoreCase(benchmark::State& state)
+{
+  LookupAll<Properties>(state, true);
+}
+
+BENCHMARK_DEFINE_F(PropertiesFixture, FilterMatchServiceReference)
+(benchmark::State& state)
+{
+  auto count = state.range(0);
+  LDAPFilter filter("(&(" + PropertyKey(count - 1) + "=value" +
+                    std::to_string(count - 1) + ")(" + PropertyKey(0) +
+                    "=value0))");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(filter.Match(ref));
+  }
+}
+
+// The argument is the number of user-defined properties
+BENCHMARK(PropertyLookupLinearScan)->RangeMultiplier(2)->Range(4, 128);
+BENCHMARK(PropertyLookupLinearScanIgnoreCase)
+  ->RangeMultiplier(2)
+  ->Range(4, 128);
+BENCHMARK(PropertyLookupIndexed)->RangeMultiplier(2)->Range(4, 128);
+BENCHMARK(PropertyLookupIndexedIgnoreCase)->RangeMultiplier(2)->Range(4, 128);
+BENCHMARK_REGISTER_F(PropertiesFixture, FilterMatchServiceReference)
+  ->RangeMultiplier(2)
+  ->Range(4, 128);
+
+US_MSVC_POP_WARNING
@@ -1,10 +1,13 @@
 #include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Constants.h>
 #include <cppmicroservices/Framework.h>
 #include <cppmicroservices/FrameworkEvent.h>
 #include <cppmicroservices/FrameworkFactory.h>
 #include <cppmicroservices/ServiceReference.h>
 
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 
@@ -58,6 +61,30 @@ BENCHMARK_DEFINE_F(ServiceFixture, GetServiceReferenceByClassName)
   }
 }
 
+BENCHMARK_DEFINE_F(ServiceFixture, GetServiceByInterface)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  for (auto _ : state) {
+    auto ref = context.GetServiceReference<benchmark::test::Foo>();
+    benchmark::DoNotOptimize(context.GetService(ref));
+  }
+}
+
+BENCHMARK_DEFINE_F(ServiceFixture, GetServiceByClassName)
+(benchmark::State& state)
+{
+  using namespace cppmicroservices;
+
+  auto context = framework->GetBundleContext();
+  const std::string className("benchmark::test::Foo");
+  for (auto _ : state) {
+    auto ref = context.GetServiceReference(className);
+    benchmark::DoNotOptimize(
+      ExtractInterface(context.GetService(ref), className));
+  }
+}
+
 BENCHMARK_DEFINE_F(ServiceFixture, GetAllServiceReferencesByInterface)
 (benchmark::State& state)
 {
@@ -96,12 +123,85 @@ BENCHMARK_DEFINE_F(ServiceFixture,
   }
 }
 
+// Registers many services of one interface which only differ by
+// a "plugin.id" property. The second argument enables the service
+// registry index on that property.
+class PluginServiceFixture : public ::benchmark::Fixture
+{
+public:
+  using benchmark::Fixture::SetUp;
+  using benchmark::Fixture::TearDown;
+
+  void SetUp(const ::benchmark::State& state)
+  {
+    using namespace cppmicroservices;
+    using namespace benchmark::test;
+
+    FrameworkConfiguration config;
+    if (state.range(1)) {
+      config[Constants::FRAMEWORK_SERVICE_INDEX_PROPERTIES] =
+        std::vector<std::string>{ "plugin.id" };
+    }
+    framework =
+      std::make_shared<Framework>(FrameworkFactory().NewFramework(config));
+    framework->Start();
+    auto context = framework->GetBundleContext();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      (void)context.RegisterService<Foo>(
+        std::make_shared<FooImpl>(),
+        ServiceProperties{ { "plugin.id", std::to_string(i) } });
+    }
+  }
+
+  void TearDown(const ::benchmark::State&)
+  {
+    using namespace std::chrono;
+
+    framework->Stop();
+    framework->WaitForStop(milliseconds::zero());
+  }
+
+  ~PluginServiceFixture() = default;
+
+  std::shared_ptr<cppmicroservices::Framework> framework;
+};
+
+BENCHMARK_DEFINE_F(PluginServiceFixture, GetServiceReferencesByPluginId)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  auto filter = "(plugin.id=" + std::to_string(state.range(0) / 2) + ")";
+  for (auto _ : state) {
+    (void)context.GetServiceReferences<benchmark::test::Foo>(filter);
+  }
+}
+
+BENCHMARK_DEFINE_F(PluginServiceFixture, GetServiceReferencesByPluginIdOnly)
+(benchmark::State& state)
+{
+  auto context = framework->GetBundleContext();
+  auto filter = "(plugin.id=" + std::to_string(state.range(0) / 2) + ")";
+  for (auto _ : state) {
+    (void)context.GetServiceReferences("", filter);
+  }
+}
+
 // Register benchmark functions
 BENCHMARK_REGISTER_F(ServiceFixture, GetServiceReferenceByInterface);
 BENCHMARK_REGISTER_F(ServiceFixture, GetServiceReferenceByClassName);
+BENCHMARK_REGISTER_F(ServiceFixture, GetServiceByInterface);
+BENCHMARK_REGISTER_F(ServiceFixture, GetServiceByClassName);
 BENCHMARK_REGISTER_F(ServiceFixture, GetAllServiceReferencesByInterface);
 BENCHMARK_REGISTER_F(ServiceFixture, GetAllServiceReferencesByClassName);
 BENCHMARK_REGISTER_F(ServiceFixture,
                      GetAllServiceReferencesByClassNameAndLDAPFilter);
 BENCHMARK_REGISTER_F(ServiceFixture,
                      GetAllServiceReferencesByInterfaceAndLDAPFilter);
+
+// The arguments are the number of services and whether "plugin.id" is indexed
+BENCHMARK_REGISTER_F(PluginServiceFixture, GetServiceReferencesByPluginId)
+  ->RangeMultiplier(10)
+  ->Ranges({ { 100, 10000 }, { 0, 1 } });
+BENCHMARK_REGISTER_F(PluginServiceFixture, GetServiceReferencesByPluginIdOnly)
+  ->RangeMultiplier(10)
+  ->Ranges({ { 100, 10000 }, { 0, 1 } });
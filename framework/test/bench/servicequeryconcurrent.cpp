@@ -0,0 +1,97 @@
+#include <cppmicroservices/BundleContext.h>
+#include <cppmicroservices/Constants.h>
+#include <cppmicroservices/Framework.h>
+#include <cppmicroservices/FrameworkEvent.h>
+#include <cppmicroservices/FrameworkFactory.h>
+#include <cppmicroservices/ServiceReference.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "fooservice.h"
+
+namespace {
+
+constexpr int LookupsPerThread = 1000;
+
+// Runs lookup LookupsPerThread times on each of state.range(0) threads
+// against a framework with 100 registered services. The second argument
+// enables service registry snapshots.
+template<class Lookup>
+void RunConcurrentLookups(benchmark::State& state, Lookup lookup)
+{
+  using namespace std::chrono;
+  using namespace cppmicroservices;
+  using namespace benchmark::test;
+
+  FrameworkConfiguration config;
+  if (state.range(1)) {
+    config[Constants::FRAMEWORK_SERVICE_SNAPSHOTS] = true;
+  }
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+  for (int i = 0; i < 100; ++i) {
+    (void)context.RegisterService<Foo>(
+      std::make_shared<FooImpl>(),
+      ServiceProperties{ { "name", std::string("foo") + std::to_string(i) } });
+  }
+
+  auto numThreads = state.range(0);
+  for (auto _ : state) {
+    auto start = high_resolution_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int64_t i = 0; i < numThreads; ++i) {
+      threads.emplace_back([&context, &lookup] {
+        for (int j = 0; j < LookupsPerThread; ++j) {
+          lookup(context);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    auto end = high_resolution_clock::now();
+    auto elapsed_seconds = duration_cast<duration<double>>(end - start);
+    state.SetIterationTime(elapsed_seconds.count());
+  }
+  state.SetItemsProcessed(state.iterations() * numThreads * LookupsPerThread);
+
+  framework.Stop();
+  framework.WaitForStop(milliseconds::zero());
+}
+}
+
+static void ConcurrentGetServiceReference(benchmark::State& state)
+{
+  RunConcurrentLookups(state, [](cppmicroservices::BundleContext& context) {
+    benchmark::DoNotOptimize(
+      context.GetServiceReference<benchmark::test::Foo>());
+  });
+}
+
+static void ConcurrentGetServiceReferencesWithLDAPFilter(
+  benchmark::State& state)
+{
+  RunConcurrentLookups(state, [](cppmicroservices::BundleContext& context) {
+    benchmark::DoNotOptimize(
+      context.GetServiceReferences<benchmark::test::Foo>("(name=foo42)"));
+  });
+}
+
+// The arguments are the number of reader threads and whether service
+// registry snapshots are enabled
+BENCHMARK(ConcurrentGetServiceReference)
+  ->RangeMultiplier(2)
+  ->Ranges({ { 1, 64 }, { 0, 1 } })
+  ->UseManualTime();
+BENCHMARK(ConcurrentGetServiceReferencesWithLDAPFilter)
+  ->RangeMultiplier(2)
+  ->Ranges({ { 1, 64 }, { 0, 1 } })
+  ->UseManualTime();
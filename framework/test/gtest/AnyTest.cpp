@@ -149,6 +149,21 @@ TEST(AnyTest, AnyVectorAny)
   EXPECT_EQ(anyVectorOfAnys.ToJSON(), "[1,\"bonjour\"]");
 }
 
+TEST(AnyTest, AnyMoveAssignFromOwnContent)
+{
+  Any a = std::vector<Any>{ Any(std::string(64, 'x')), Any(1) };
+  auto* vec = any_cast<std::vector<Any>>(&a);
+  ASSERT_NE(vec, nullptr);
+  // the source lives inside the vector that is destroyed by the assignment
+  a = std::move((*vec)[0]);
+  EXPECT_EQ(a.Type(), typeid(std::string));
+  EXPECT_EQ(any_cast<std::string>(a), std::string(64, 'x'));
+
+  Any b = std::vector<Any>{ Any(42) };
+  b = std::move((*any_cast<std::vector<Any>>(&b))[0]);
+  EXPECT_EQ(any_cast<int>(b), 42);
+}
+
 TEST(AnyTest, AnyListAny)
 {
   std::list<Any> listAny = { 1, std::string("bonjour") };
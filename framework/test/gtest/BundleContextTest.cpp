@@ -28,6 +28,7 @@
 #include "cppmicroservices/FrameworkFactory.h"
 #include "cppmicroservices/LDAPFilter.h"
 #include "cppmicroservices/LDAPProp.h"
+#include "cppmicroservices/ServiceEvent.h"
 #include "cppmicroservices/ServiceFactory.h"
 #include "cppmicroservices/ServiceObjects.h"
 #include "cppmicroservices/ServiceReference.h"
@@ -105,6 +106,15 @@ TEST(BundleContextTest, BundleContextThrowWhenInvalid)
     },
     std::runtime_error)
     << "RegisterService() on invalid BundleContext did not throw.";
+  EXPECT_THROW(
+    {
+      (void)context2.RegisterServices(
+        { { MakeInterfaceMap<bc_tests::TestService>(
+              std::make_shared<bc_tests::TestService>()),
+            {} } });
+    },
+    std::runtime_error)
+    << "RegisterServices() on invalid BundleContext did not throw.";
   EXPECT_THROW(
     { (void)context2.GetServiceReferences<bc_tests::TestService>(); },
     std::runtime_error)
@@ -159,6 +169,61 @@ TEST(BundleContextTest, BundleContextThrowWhenInvalid)
     << "InstallBundles() on invalid BundleContext did not throw.";
 }
 
+TEST(BundleContextTest, RegisterServices)
+{
+  cppmicroservices::Framework framework =
+    cppmicroservices::FrameworkFactory().NewFramework();
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  std::vector<long> registeredIds;
+  std::vector<std::size_t> visibleServices;
+  auto token = context.AddServiceListener(
+    [&](const ServiceEvent& evt) {
+      if (evt.GetType() == ServiceEvent::SERVICE_REGISTERED) {
+        registeredIds.push_back(any_cast<long>(
+          evt.GetServiceReference().GetProperty(Constants::SERVICE_ID)));
+        visibleServices.push_back(
+          context.GetServiceReferences<bc_tests::TestService>().size());
+      }
+    },
+    "(objectclass=" + us_service_interface_iid<bc_tests::TestService>() +
+      ")");
+
+  std::vector<std::pair<InterfaceMapConstPtr, ServiceProperties>> services;
+  for (int i = 0; i < 5; ++i) {
+    services.emplace_back(MakeInterfaceMap<bc_tests::TestService>(
+                            std::make_shared<bc_tests::TestService>()),
+                          ServiceProperties{ { "index", Any(i) } });
+  }
+  auto regs = context.RegisterServices(services);
+  ASSERT_EQ(regs.size(), services.size());
+
+  // Events are delivered in the order of the batch, and listeners see the
+  // whole batch as registered
+  ASSERT_EQ(registeredIds.size(), services.size());
+  for (std::size_t i = 0; i < regs.size(); ++i) {
+    auto ref = regs[i].GetReference();
+    EXPECT_EQ(any_cast<int>(ref.GetProperty("index")), static_cast<int>(i));
+    EXPECT_EQ(any_cast<long>(ref.GetProperty(Constants::SERVICE_ID)),
+              registeredIds[i]);
+    EXPECT_EQ(visibleServices[i], services.size());
+  }
+
+  // An invalid service in the batch registers none of the services
+  services.emplace_back(std::make_shared<InterfaceMap>(), ServiceProperties());
+  EXPECT_THROW(context.RegisterServices(services), std::invalid_argument);
+  EXPECT_EQ(context.GetServiceReferences<bc_tests::TestService>().size(),
+            regs.size());
+
+  context.RemoveListener(std::move(token));
+  for (auto& reg : regs) {
+    reg.Unregister();
+  }
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
 #if defined(US_ENABLE_THREADING_SUPPORT)
 TEST(BundleContextTest, NoSegfaultWithRegisterServiceShutdownRace)
 {
@@ -34,6 +34,9 @@
 #include "TestingConfig.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <functional>
+
 US_MSVC_PUSH_DISABLE_WARNING(4996)
 
 // conflicts with FrameworkEvent::GetMessage
@@ -110,6 +113,26 @@ public:
   }
 };
 
+class LambdaBundleEventHook : public BundleEventHook
+{
+public:
+  using Function =
+    std::function<void(const BundleEvent&, ShrinkableVector<BundleContext>&)>;
+
+  explicit LambdaBundleEventHook(Function f)
+    : f(std::move(f))
+  {}
+
+  void Event(const BundleEvent& event,
+             ShrinkableVector<BundleContext>& contexts)
+  {
+    f(event, contexts);
+  }
+
+private:
+  Function f;
+};
+
 class BundleHooksTest : public ::testing::Test
 {
 protected:
@@ -217,6 +240,42 @@ TEST_F(BundleHooksTest, TestEventHook)
     &bundleListener, &TestBundleListener::BundleChanged);
 }
 
+TEST_F(BundleHooksTest, TestEventHookBundleAndEventsListeners)
+{
+  auto context = framework.GetBundleContext();
+  auto bundleA =
+    cppmicroservices::testing::InstallLib(context, "TestBundleA");
+  ASSERT_TRUE(bundleA);
+
+  // a context with both kinds of bundle listeners is passed to the hook
+  // once, and removing it once filters both listeners
+  std::size_t events = 0;
+  std::size_t batches = 0;
+  auto token = context.AddBundleListener([&](const BundleEvent&) { ++events; });
+  auto batchToken = context.AddBundleEventsListener(
+    [&](const std::vector<BundleEvent>&) { ++batches; });
+  std::size_t frameworkContexts = 0;
+  auto eventHookReg = context.RegisterService<BundleEventHook>(
+    std::make_shared<LambdaBundleEventHook>(
+      [&](const BundleEvent&, ShrinkableVector<BundleContext>& contexts) {
+        auto iter = std::find(contexts.begin(), contexts.end(), context);
+        frameworkContexts = static_cast<std::size_t>(
+          std::count(contexts.begin(), contexts.end(), context));
+        if (iter != contexts.end()) {
+          contexts.erase(iter);
+        }
+      }));
+
+  bundleA.Start();
+  EXPECT_EQ(frameworkContexts, 1);
+  EXPECT_EQ(events, 0);
+  EXPECT_EQ(batches, 0);
+
+  eventHookReg.Unregister();
+  context.RemoveListener(std::move(token));
+  context.RemoveListener(std::move(batchToken));
+}
+
 TEST_F(BundleHooksTest, TestEventHookFailure)
 {
   auto bundleA = cppmicroservices::testing::InstallLib(
@@ -93,6 +93,25 @@ TEST(BundleObjFile, GetRawBundleResourceContainer)
 #endif
 }
 
+#if defined(US_BUILD_SHARED_LIBS) && defined(US_PLATFORM_LINUX)
+TEST(BundleObjFile, ElfResourceSection)
+{
+  // The container holds exactly the zip archive of the resource section
+  auto bundleObj =
+    cppmicroservices::BundleObjFactory().CreateBundleFileObj(testBundlePath);
+  auto data = bundleObj->GetRawBundleResourceContainer();
+  ASSERT_TRUE(data);
+  ASSERT_GT(data->GetSize(), 4u);
+  ASSERT_EQ(0, memcmp(data->GetData(), "PK\x03\x04", 4));
+
+  // Bundles with resources appended to the library have no section
+  auto appendedObj = cppmicroservices::BundleObjFactory().CreateBundleFileObj(
+    cppmicroservices::testing::LIB_PATH + cppmicroservices::util::DIR_SEP +
+    US_LIB_PREFIX + "TestBundleA" + US_LIB_POSTFIX + US_LIB_EXT);
+  ASSERT_FALSE(appendedObj->GetRawBundleResourceContainer());
+}
+#endif
+
 #if defined(US_BUILD_SHARED_LIBS)
 #  if defined(US_PLATFORM_APPLE) || defined(US_PLATFORM_POSIX)
 TEST(BundleObjFile, MappedFile)
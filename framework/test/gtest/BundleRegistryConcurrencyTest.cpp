@@ -21,6 +21,7 @@ limitations under the License.
 =============================================================================*/
 
 #include "cppmicroservices/BundleContext.h"
+#include "cppmicroservices/BundleEvent.h"
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/FrameworkFactory.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "TestingConfig.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -142,6 +144,273 @@ TEST(BundleRegistryConcurrencyTest, testConcurrent)
   framework.WaitForStop(std::chrono::milliseconds::zero());
 }
 #  endif
+
+std::string TestBundlePath(const std::string& bundleName)
+{
+  return cppmicroservices::testing::LIB_PATH + util::DIR_SEP + US_LIB_PREFIX +
+         bundleName + US_LIB_POSTFIX + US_LIB_EXT;
+}
+
+std::vector<std::string> TestBundlePaths()
+{
+  std::vector<std::string> paths;
+  for (auto const& name : { "TestBundleA",
+                            "TestBundleA2",
+                            "TestBundleB",
+                            "TestBundleH",
+                            "TestBundleLQ",
+                            "TestBundleM",
+                            "TestBundleR",
+                            "TestBundleRA",
+                            "TestBundleRL",
+                            "TestBundleS",
+                            "TestBundleSL1",
+                            "TestBundleSL3",
+                            "TestBundleSL4" }) {
+    paths.push_back(TestBundlePath(name));
+  }
+  return paths;
+}
+
+TEST(BundleRegistryConcurrencyTest, testBatchInstallOrder)
+{
+  auto paths = TestBundlePaths();
+
+  std::vector<std::pair<long, std::string>> expected;
+  {
+    auto framework = FrameworkFactory().NewFramework();
+    framework.Start();
+    auto bc = framework.GetBundleContext();
+    for (auto const& path : paths) {
+      for (auto const& b : bc.InstallBundles(path)) {
+        expected.emplace_back(b.GetBundleId(), b.GetSymbolicName());
+      }
+    }
+    framework.Stop();
+    framework.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  std::vector<std::pair<long, std::string>> events;
+  auto token = bc.AddBundleListener([&events](const BundleEvent& evt) {
+    if (evt.GetType() == BundleEvent::BUNDLE_INSTALLED) {
+      events.emplace_back(evt.GetBundle().GetBundleId(),
+                          evt.GetBundle().GetSymbolicName());
+    }
+  });
+
+  // the first location is already installed and the last one is a duplicate
+  auto first = bc.InstallBundles(paths.front());
+  ASSERT_EQ(first.size(), 1);
+  auto locations = paths;
+  locations.push_back(paths.back());
+  auto bundles = bc.InstallBundles(locations);
+  bc.RemoveListener(std::move(token));
+
+  std::vector<std::pair<long, std::string>> installed;
+  for (auto const& b : bundles) {
+    installed.emplace_back(b.GetBundleId(), b.GetSymbolicName());
+  }
+  EXPECT_EQ(installed, expected);
+  EXPECT_EQ(events, expected);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testBatchInstallEventsListener)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  std::vector<std::vector<BundleEvent>> batches;
+  std::vector<BundleEvent> events;
+  auto batchToken =
+    bc.AddBundleEventsListener([&batches](const std::vector<BundleEvent>& b) {
+      batches.push_back(b);
+    });
+  auto token = bc.AddBundleListener(
+    [&events](const BundleEvent& evt) { events.push_back(evt); });
+
+  // the events of a batch install arrive in one batch, in the same
+  // order as they reach bundle listeners
+  auto bundles = bc.InstallBundles(TestBundlePaths());
+  ASSERT_GT(bundles.size(), 1);
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_EQ(batches[0], events);
+  EXPECT_EQ(batches[0].size(), bundles.size());
+  for (auto const& evt : batches[0]) {
+    EXPECT_EQ(evt.GetType(), BundleEvent::BUNDLE_INSTALLED);
+  }
+
+  // other events arrive one at a time
+  batches.clear();
+  events.clear();
+  bundles[0].Start();
+  ASSERT_FALSE(events.empty());
+  ASSERT_EQ(batches.size(), events.size());
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(batches[i], std::vector<BundleEvent>{ events[i] });
+  }
+
+  // a removed listener gets no more batches
+  bc.RemoveListener(std::move(batchToken));
+  batches.clear();
+  bundles[0].Stop();
+  EXPECT_TRUE(batches.empty());
+  bc.RemoveListener(std::move(token));
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testBatchInstallOtherThreadEvents)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  auto paths = TestBundlePaths();
+  auto other = bc.InstallBundles(paths.front()).at(0);
+  paths.erase(paths.begin());
+
+  std::mutex batchesMutex;
+  std::vector<std::vector<BundleEvent>> batches;
+  bc.AddBundleEventsListener(
+    [&batches, &batchesMutex](const std::vector<BundleEvent>& b) {
+      std::lock_guard<std::mutex> lock(batchesMutex);
+      batches.push_back(b);
+    });
+  // the events of another thread are not held back by the batch install
+  bool otherStartedInBatch = false;
+  bool first = true;
+  bc.AddBundleListener([&](const BundleEvent& evt) {
+    if (evt.GetType() != BundleEvent::BUNDLE_INSTALLED || !first) {
+      return;
+    }
+    first = false;
+    std::thread([&other] { other.Start(); }).join();
+    std::lock_guard<std::mutex> lock(batchesMutex);
+    for (auto const& batch : batches) {
+      for (auto const& e : batch) {
+        otherStartedInBatch |= e.GetType() == BundleEvent::BUNDLE_STARTED &&
+                               e.GetBundle() == other;
+      }
+    }
+  });
+
+  bc.InstallBundles(paths);
+  EXPECT_TRUE(otherStartedInBatch);
+  {
+    // the events of the batch install still arrive in one batch
+    std::lock_guard<std::mutex> lock(batchesMutex);
+    ASSERT_FALSE(batches.empty());
+    EXPECT_GT(batches.back().size(), 1);
+    for (auto const& evt : batches.back()) {
+      EXPECT_EQ(evt.GetType(), BundleEvent::BUNDLE_INSTALLED);
+    }
+  }
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testBatchInstallFailure)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  std::vector<std::string> locations{ TestBundlePath("TestBundleA"),
+                                      TestBundlePath("DoesNotExist"),
+                                      TestBundlePath("TestBundleA2") };
+  EXPECT_THROW(bc.InstallBundles(locations), std::runtime_error);
+
+  EXPECT_FALSE(bc.GetBundles(locations[0]).empty());
+  EXPECT_TRUE(bc.GetBundles(locations[2]).empty());
+
+  // the failed install must not block later installs of the same location
+  auto bundles = bc.InstallBundles(locations[2]);
+  ASSERT_EQ(bundles.size(), 1);
+  EXPECT_EQ(bundles[0].GetSymbolicName(), "TestBundleA2");
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(BundleRegistryConcurrencyTest, testLookupAfterUninstall)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+
+  auto bundles = bc.InstallBundles(TestBundlePaths());
+  ASSERT_FALSE(bundles.empty());
+  for (auto const& b : bundles) {
+    EXPECT_EQ(bc.GetBundle(b.GetBundleId()), b);
+  }
+
+  auto uninstalled = bundles.front();
+  auto id = uninstalled.GetBundleId();
+  auto location = uninstalled.GetLocation();
+  uninstalled.Uninstall();
+  EXPECT_FALSE(bc.GetBundle(id));
+  for (auto const& b : bc.GetBundles(location)) {
+    EXPECT_NE(b.GetBundleId(), id);
+  }
+
+  // a reinstalled bundle gets a new id
+  auto reinstalled = bc.InstallBundles(location);
+  ASSERT_FALSE(reinstalled.empty());
+  EXPECT_NE(reinstalled.front().GetBundleId(), id);
+  EXPECT_EQ(bc.GetBundle(reinstalled.front().GetBundleId()),
+            reinstalled.front());
+  EXPECT_FALSE(bc.GetBundle(id));
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+#  ifdef US_ENABLE_THREADING_SUPPORT
+TEST(BundleRegistryConcurrencyTest, testConcurrentBatchInstall)
+{
+  auto framework = FrameworkFactory().NewFramework();
+  framework.Start();
+  auto bc = framework.GetBundleContext();
+  auto numBundles = bc.GetBundles().size();
+
+  // threads install overlapping locations in different orders
+  auto paths = TestBundlePaths();
+  const std::size_t numThreads = 8;
+  std::vector<std::size_t> numInstalled(numThreads, 0);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < numThreads; ++i) {
+    auto locations = paths;
+    std::rotate(locations.begin(), locations.begin() + i, locations.end());
+    if (i % 2) {
+      std::reverse(locations.begin(), locations.end());
+    }
+    threads.emplace_back([bc, locations, &numInstalled, i]() mutable {
+      numInstalled[i] = bc.InstallBundles(locations).size();
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  EXPECT_GE(numInstalled[0], paths.size());
+  for (auto n : numInstalled) {
+    EXPECT_EQ(n, numInstalled[0]);
+  }
+  EXPECT_EQ(bc.GetBundles().size(), numBundles + numInstalled[0]);
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+#  endif
 } // end anonymous namespace
 
 #endif
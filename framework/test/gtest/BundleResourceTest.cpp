@@ -27,8 +27,12 @@ limitations under the License.
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/FrameworkFactory.h"
+#include "cppmicroservices/util/FileSystem.h"
 
 #include "gtest/gtest.h"
+
+#include <iterator>
+#include <thread>
 #include <unordered_set>
 
 using namespace cppmicroservices;
@@ -513,6 +517,218 @@ TEST_F(BundleResourceTest, testSpecialCharacters)
   ASSERT_EQ(content, fileData);
 }
 
+TEST_F(BundleResourceTest, testDataView)
+{
+  ASSERT_FALSE(BundleResource().GetDataView());
+
+  // TestBundleRS stores its resources uncompressed
+  auto storedBundle =
+    cppmicroservices::testing::InstallLib(context, "TestBundleRS");
+  std::vector<BundleResource> stored;
+  std::vector<std::pair<std::shared_ptr<const char>, std::string>> views;
+  for (auto bundle : { testBundle, storedBundle }) {
+    for (const auto& res : bundle.FindResources("", "*", true)) {
+      if (res.IsDir()) {
+        continue;
+      }
+      auto view = res.GetDataView();
+      ASSERT_TRUE(view) << res.GetResourcePath();
+      BundleResourceStream rs(res, std::ios_base::binary);
+      std::string data(std::istreambuf_iterator<char>(rs),
+                       (std::istreambuf_iterator<char>()));
+      ASSERT_EQ(data.size(), static_cast<std::size_t>(res.GetSize()));
+      ASSERT_EQ(data, std::string(view.get(), data.size()))
+        << res.GetResourcePath();
+      if (res.GetCompressedSize() == res.GetSize()) {
+        stored.push_back(res);
+      }
+      views.emplace_back(std::move(view), std::move(data));
+    }
+  }
+  ASSERT_FALSE(stored.empty());
+
+#if defined(US_PLATFORM_APPLE) || defined(US_PLATFORM_POSIX)
+  // Stored resources of a bundle library are read from the mapped library
+  // without a copy
+  for (const auto& res : stored) {
+    EXPECT_EQ(res.GetDataView().get(), res.GetDataView().get())
+      << res.GetResourcePath();
+  }
+#endif
+
+  // The data outlives the bundles
+  testBundle.Uninstall();
+  storedBundle.Uninstall();
+  for (const auto& view : views) {
+    EXPECT_EQ(view.second, std::string(view.first.get(), view.second.size()));
+  }
+}
+
+namespace {
+
+std::string ReadResource(const BundleResource& res)
+{
+  BundleResourceStream rs(res, std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(rs),
+                     std::istreambuf_iterator<char>());
+}
+
+// Reads the given resources from several threads at once and checks that
+// every thread reads the same data as a single thread does.
+void TestConcurrentResourceReads(const std::vector<BundleResource>& resources)
+{
+  std::vector<std::string> expected;
+  for (const auto& res : resources) {
+    ASSERT_TRUE(res.IsValid());
+    expected.push_back(ReadResource(res));
+  }
+
+  const int numThreads = 8;
+  std::vector<int> mismatches(numThreads, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int round = 0; round < 10; ++round) {
+        for (std::size_t j = 0; j < resources.size(); ++j) {
+          if (ReadResource(resources[j]) != expected[j]) {
+            ++mismatches[i];
+          }
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < numThreads; ++i) {
+    EXPECT_EQ(mismatches[i], 0) << "thread " << i;
+  }
+}
+}
+
+namespace {
+
+// Checks that a resource reads the same with a small window as it does
+// when its data is read at once.
+void TestStreamedResource(const BundleResource& res, std::size_t windowSize)
+{
+  BundleResourceStream rs(
+    res, BundleResourceStream::Window(windowSize), std::ios_base::binary);
+  std::string data(std::istreambuf_iterator<char>(rs),
+                   (std::istreambuf_iterator<char>()));
+  EXPECT_EQ(data, ReadResource(res)) << res.GetResourcePath();
+  EXPECT_EQ(data.size(), static_cast<std::size_t>(res.GetSize()));
+}
+}
+
+TEST_F(BundleResourceTest, testStreamedResources)
+{
+  // TestBundleRS stores its resources uncompressed, TestStartBundleA links
+  // its compressed resources into the bundle library
+  auto storedBundle =
+    cppmicroservices::testing::InstallLib(context, "TestBundleRS");
+  auto linkedBundle =
+    cppmicroservices::testing::InstallLib(context, "TestStartBundleA");
+  for (auto bundle : { testBundle, storedBundle, linkedBundle }) {
+    for (const auto& res : bundle.FindResources("", "*", true)) {
+      if (!res.IsDir()) {
+        TestStreamedResource(res, 7);
+        TestStreamedResource(res, 4096);
+      }
+    }
+  }
+  storedBundle.Uninstall();
+  linkedBundle.Uninstall();
+}
+
+TEST_F(BundleResourceTest, testStreamedResourceSeek)
+{
+  BundleResource res = testBundle.GetResource("/icons/compressable.bmp");
+  ASSERT_LT(res.GetCompressedSize(), res.GetSize());
+  const std::string expected = ReadResource(res);
+
+  BundleResourceStream rs(
+    res, BundleResourceStream::Window(1000), std::ios_base::binary);
+  rs.seekg(0, std::ios_base::end);
+  ASSERT_EQ(rs.tellg(), res.GetSize());
+  ASSERT_EQ(rs.peek(), std::char_traits<char>::eof());
+  rs.clear();
+
+  // seek forward, past the window and backward before it
+  char buffer[100];
+  for (std::size_t pos : { 0, 150000, 150050, 149990, 42, 299000, 10 }) {
+    rs.seekg(pos);
+    ASSERT_EQ(rs.tellg(), pos);
+    rs.read(buffer, sizeof(buffer));
+    ASSERT_EQ(rs.gcount(), sizeof(buffer));
+    ASSERT_EQ(std::string(buffer, sizeof(buffer)),
+              expected.substr(pos, sizeof(buffer)))
+      << pos;
+  }
+  rs.seekg(-10, std::ios_base::cur);
+  ASSERT_EQ(rs.tellg(), 100);
+  rs.seekg(-50, std::ios_base::end);
+  rs.read(buffer, sizeof(buffer));
+  ASSERT_EQ(rs.gcount(), 50);
+  ASSERT_TRUE(rs.eof());
+  ASSERT_EQ(std::string(buffer, 50), expected.substr(expected.size() - 50));
+
+  rs.clear();
+  rs.seekg(res.GetSize() + 1);
+  ASSERT_TRUE(rs.fail());
+
+  // text mode reads the whole resource
+  BundleResourceStream text(res, BundleResourceStream::Window(1000));
+  ASSERT_EQ(std::string(std::istreambuf_iterator<char>(text),
+                        std::istreambuf_iterator<char>()),
+            expected);
+}
+
+TEST_F(BundleResourceTest, testConcurrentResourceReads)
+{
+  TestConcurrentResourceReads(
+    { testBundle.GetResource("/icons/compressable.bmp"),
+      testBundle.GetResource("/icons/cppmicroservices.png"),
+      testBundle.GetResource("foo.ptxt") });
+}
+
+TEST_F(BundleResourceTest, testConcurrentResourceReadsFromZipFile)
+{
+  cppmicroservices::testing::TempDir dir(
+    cppmicroservices::testing::MakeUniqueTempDirectory());
+  const std::string name("ZipResourceBundle");
+  const std::string location(dir.Path + util::DIR_SEP + name + ".zip");
+
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (int i = 0; i < 16; ++i) {
+    std::string data;
+    for (int j = 0; j < 1000; ++j) {
+      data += std::to_string(i * j);
+    }
+    entries.emplace_back("res" + std::to_string(i) + ".txt", data);
+  }
+  // spans several chunks of compressed data
+  std::string large;
+  for (int i = 0; large.size() < 4 * 1024 * 1024; ++i) {
+    large += std::to_string((i * 7919) % 100003);
+  }
+  entries.emplace_back("large.txt", large);
+  cppmicroservices::testing::WriteZipBundle(location, name, entries);
+
+  auto bundles = context.InstallBundles(location);
+  ASSERT_EQ(bundles.size(), 1);
+  auto resources = bundles[0].FindResources("", "res*", false);
+  ASSERT_EQ(resources.size(), 16);
+  TestConcurrentResourceReads(resources);
+  for (const auto& res : resources) {
+    TestStreamedResource(res, 100);
+  }
+  auto largeRes = bundles[0].GetResource("large.txt");
+  ASSERT_GT(largeRes.GetCompressedSize(), 64 * 1024);
+  TestStreamedResource(largeRes, 1000);
+  bundles[0].Uninstall();
+}
+
 class BundleResourceDataOnlyTest : public ::testing::Test
 {
 protected:
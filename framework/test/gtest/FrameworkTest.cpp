@@ -20,11 +20,14 @@ limitations under the License.
 
 =============================================================================*/
 
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <unordered_map>
 
 #include "TestUtilBundleListener.h"
 #include "TestUtils.h"
@@ -848,6 +851,11 @@ TEST(FrameworkTest, LoadLibraryLogsMessagesTest)
   // The logger should receive 2 Log() calls as a result of the bundle being started.
   EXPECT_CALL(*logger, Log(logservice::SeverityLevel::LOG_INFO, ::testing::_))
     .Times(2);
+  // Starting the bundle logs how long loading and activating it took.
+  EXPECT_CALL(*logger,
+              Log(logservice::SeverityLevel::LOG_DEBUG,
+                  ::testing::HasSubstr("the activator took")))
+    .Times(1);
 
   auto loggerReg = context.RegisterService<logservice::LogService>(logger);
 
@@ -861,4 +869,293 @@ TEST(FrameworkTest, LoadLibraryLogsMessagesTest)
 }
 #endif
 
+namespace {
+
+std::unordered_map<std::string, Bundle> GetBundlesByName(Framework& f)
+{
+  std::unordered_map<std::string, Bundle> bundles;
+  for (auto const& b : f.GetBundleContext().GetBundles()) {
+    bundles.emplace(b.GetSymbolicName(), b);
+  }
+  return bundles;
+}
+
+void WriteManifestZip(const std::string& path,
+                      const std::string& bundleName,
+                      const std::string& version,
+                      const std::string& extraHeaders = std::string())
+{
+  cppmicroservices::testing::WriteZipBundle(
+    path,
+    bundleName,
+    {},
+    true,
+    "\"bundle.version\" : \"" + version + "\"" + extraHeaders);
+}
+}
+
+#if defined(US_BUILD_SHARED_LIBS)
+TEST(FrameworkTest, BundleCacheRestoresInstalledBundles)
+{
+  TempDir storage(MakeUniqueTempDirectory());
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_STORAGE, storage.Path },
+    { Constants::FRAMEWORK_BUNDLE_CACHE, true }
+  };
+
+  long idA = 0;
+  long idA2 = 0;
+  {
+    auto f = FrameworkFactory().NewFramework(config);
+    f.Start();
+    auto context = f.GetBundleContext();
+    using cppmicroservices::testing::InstallLib;
+    auto bundleA = InstallLib(context, "TestBundleA");
+    auto bundleA2 = InstallLib(context, "TestBundleA2");
+    auto bundleM = InstallLib(context, "TestBundleM");
+    bundleA.Start();
+    bundleM.Uninstall();
+    idA = bundleA.GetBundleId();
+    idA2 = bundleA2.GetBundleId();
+    f.Stop();
+    f.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  auto bundles = GetBundlesByName(f);
+  ASSERT_EQ(bundles.count("TestBundleA"), 1);
+  ASSERT_EQ(bundles.count("TestBundleA2"), 1);
+  EXPECT_EQ(bundles.count("TestBundleM"), 0);
+
+  auto bundleA = bundles["TestBundleA"];
+  EXPECT_EQ(bundleA.GetBundleId(), idA);
+  EXPECT_EQ(bundleA.GetState(), Bundle::STATE_ACTIVE);
+  EXPECT_EQ(bundles["TestBundleA2"].GetBundleId(), idA2);
+  EXPECT_NE(bundles["TestBundleA2"].GetState(), Bundle::STATE_ACTIVE);
+  EXPECT_EQ(bundleA.GetHeaders().at(Constants::BUNDLE_SYMBOLICNAME),
+            std::string("TestBundleA"));
+
+  // installing again returns the restored bundle
+  auto reinstalled = cppmicroservices::testing::InstallLib(
+    f.GetBundleContext(), "TestBundleA");
+  EXPECT_EQ(reinstalled, bundleA);
+
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(FrameworkTest, BundleCacheIgnoredWhenStorageCleaned)
+{
+  TempDir storage(MakeUniqueTempDirectory());
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_STORAGE, storage.Path },
+    { Constants::FRAMEWORK_BUNDLE_CACHE, true }
+  };
+
+  {
+    auto f = FrameworkFactory().NewFramework(config);
+    f.Start();
+    cppmicroservices::testing::InstallLib(f.GetBundleContext(), "TestBundleA");
+    f.Stop();
+    f.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  config[Constants::FRAMEWORK_STORAGE_CLEAN] =
+    Constants::FRAMEWORK_STORAGE_CLEAN_ONFIRSTINIT;
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  EXPECT_EQ(GetBundlesByName(f).count("TestBundleA"), 0);
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
+#endif
+
+TEST(FrameworkTest, BundleCacheDropsModifiedBundleFiles)
+{
+  TempDir storage(MakeUniqueTempDirectory());
+  TempDir bundleDir(MakeUniqueTempDirectory());
+  std::string location = bundleDir.Path + util::DIR_SEP + "cached.zip";
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_STORAGE, storage.Path },
+    { Constants::FRAMEWORK_BUNDLE_CACHE, true }
+  };
+
+  WriteManifestZip(location, "CachedBundle", "1.0.0");
+  {
+    auto f = FrameworkFactory().NewFramework(config);
+    f.Start();
+    auto bundles = f.GetBundleContext().InstallBundles(location);
+    ASSERT_EQ(bundles.size(), 1);
+    EXPECT_EQ(bundles[0].GetVersion().ToString(), "1.0.0");
+    f.Stop();
+    f.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  // a file of a different size cannot be mistaken for the cached one
+  ASSERT_EQ(std::remove(location.c_str()), 0);
+  WriteManifestZip(location, "CachedBundle", "10.0.0");
+
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  EXPECT_EQ(GetBundlesByName(f).count("CachedBundle"), 0);
+  auto bundles = f.GetBundleContext().InstallBundles(location);
+  ASSERT_EQ(bundles.size(), 1);
+  EXPECT_EQ(bundles[0].GetVersion().ToString(), "10.0.0");
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(FrameworkTest, BundleCacheRestoresReinstalledBundleFiles)
+{
+  TempDir storage(MakeUniqueTempDirectory());
+  TempDir bundleDir(MakeUniqueTempDirectory());
+  std::string location = bundleDir.Path + util::DIR_SEP + "reinstalled.zip";
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_STORAGE, storage.Path },
+    { Constants::FRAMEWORK_BUNDLE_CACHE, true }
+  };
+
+  WriteManifestZip(location, "CachedBundle", "1.0.0");
+  {
+    auto f = FrameworkFactory().NewFramework(config);
+    f.Start();
+    auto context = f.GetBundleContext();
+    context.InstallBundles(location).at(0).Uninstall();
+
+    // the file changed before it was installed again
+    ASSERT_EQ(std::remove(location.c_str()), 0);
+    WriteManifestZip(location, "CachedBundle", "10.0.0");
+    ASSERT_EQ(context.InstallBundles(location).size(), 1);
+    f.Stop();
+    f.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  auto bundles = GetBundlesByName(f);
+  ASSERT_EQ(bundles.count("CachedBundle"), 1);
+  EXPECT_EQ(bundles["CachedBundle"].GetVersion().ToString(), "10.0.0");
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+namespace {
+
+void TestLaunchStartOrder(int startThreads)
+{
+  TempDir storage(MakeUniqueTempDirectory());
+  TempDir bundleDir(MakeUniqueTempDirectory());
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_STORAGE, storage.Path },
+    { Constants::FRAMEWORK_BUNDLE_CACHE, true },
+    { Constants::FRAMEWORK_BUNDLE_START_THREADS, startThreads }
+  };
+
+  // bundle name and start level header, in bundle id order
+  const std::vector<std::pair<std::string, std::string>> levels{
+    { "Level3", ", \"bundle.start_level\" : 3" },
+    { "Default", "" },
+    { "Level2", ", \"bundle.start_level\" : 2" },
+    { "Level1", ", \"bundle.start_level\" : 1" },
+    { "Invalid", ", \"bundle.start_level\" : \"high\"" }
+  };
+  {
+    auto f = FrameworkFactory().NewFramework(config);
+    f.Start();
+    for (auto const& level : levels) {
+      std::string location =
+        bundleDir.Path + util::DIR_SEP + level.first + ".zip";
+      WriteManifestZip(location, level.first, "1.0.0", level.second);
+      f.GetBundleContext().InstallBundles(location).at(0).Start();
+    }
+    f.Stop();
+    f.WaitForStop(std::chrono::milliseconds::zero());
+  }
+
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Init();
+  std::mutex eventsMutex;
+  std::vector<std::string> started;
+  std::vector<std::string> stopping;
+  int warnings = 0;
+  f.GetBundleContext().AddBundleListener([&](const BundleEvent& evt) {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if (evt.GetBundle().GetBundleId() == 0) {
+      return;
+    }
+    if (evt.GetType() == BundleEvent::BUNDLE_STARTED) {
+      started.push_back(evt.GetBundle().GetSymbolicName());
+    } else if (evt.GetType() == BundleEvent::BUNDLE_STOPPING) {
+      stopping.push_back(evt.GetBundle().GetSymbolicName());
+    }
+  });
+  f.GetBundleContext().AddFrameworkListener([&](const FrameworkEvent& evt) {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if (evt.GetType() == FrameworkEvent::FRAMEWORK_WARNING &&
+        evt.GetBundle().GetSymbolicName() == "Invalid") {
+      ++warnings;
+    }
+  });
+  // the sizes of the batches with BUNDLE_STARTED events of launched bundles
+  std::vector<std::size_t> startedBatches;
+  f.GetBundleContext().AddBundleEventsListener(
+    [&](const std::vector<BundleEvent>& evts) {
+      std::lock_guard<std::mutex> lock(eventsMutex);
+      auto count = std::count_if(evts.begin(), evts.end(), [](auto& evt) {
+        return evt.GetType() == BundleEvent::BUNDLE_STARTED &&
+               evt.GetBundle().GetBundleId() != 0;
+      });
+      if (count != 0) {
+        startedBatches.push_back(static_cast<std::size_t>(count));
+      }
+    });
+  // the launch reports the bundle events it dispatched
+  auto logger = std::make_shared<MockLogger>();
+  EXPECT_CALL(*logger, Log(::testing::_, ::testing::_))
+    .Times(::testing::AnyNumber());
+  EXPECT_CALL(*logger,
+              Log(logservice::SeverityLevel::LOG_DEBUG,
+                  ::testing::HasSubstr("bundle events were dispatched in")))
+    .Times(1);
+  auto loggerReg =
+    f.GetBundleContext().RegisterService<logservice::LogService>(logger);
+  f.Start();
+  loggerReg.Unregister();
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+
+  EXPECT_EQ(warnings, 1);
+  EXPECT_EQ(startedBatches, std::vector<std::size_t>{ levels.size() });
+  ASSERT_EQ(started.size(), levels.size());
+  ASSERT_EQ(stopping.size(), levels.size());
+  if (startThreads <= 1) {
+    EXPECT_EQ(started,
+              std::vector<std::string>(
+                { "Default", "Level1", "Invalid", "Level2", "Level3" }));
+  } else {
+    // the order within a start level is unspecified
+    std::sort(started.begin(), started.begin() + 3);
+    EXPECT_EQ(started,
+              std::vector<std::string>(
+                { "Default", "Invalid", "Level1", "Level2", "Level3" }));
+  }
+  // bundles of the same start level stop in reverse registry (location) order
+  EXPECT_EQ(stopping,
+            std::vector<std::string>(
+              { "Level3", "Level2", "Level1", "Invalid", "Default" }));
+}
+
+}
+
+TEST(FrameworkTest, LaunchStartsBundlesByStartLevel)
+{
+  TestLaunchStartOrder(1);
+}
+
+TEST(FrameworkTest, LaunchStartsBundlesByStartLevelConcurrently)
+{
+  TestLaunchStartOrder(4);
+}
+
 US_MSVC_POP_WARNING
@@ -99,6 +99,15 @@ TEST_F(LDAPQueryTest, TestLDAPFilterMatchNoException)
 
   // Testing exception for case variants of the same key.
   ASSERT_THROW(ldapMatch.Match(props1), std::runtime_error);
+
+  // Same for property sets large enough to be hash indexed.
+  AnyMap props2(AnyMap::UNORDERED_MAP);
+  for (int i = 0; i < 16; ++i) {
+    props2["key" + std::to_string(i)] = i;
+  }
+  props2["hosed"] = std::string("1");
+  props2["HOSED"] = std::string("yum");
+  ASSERT_THROW(ldapMatch.Match(props2), std::runtime_error);
 }
 
 TEST_F(LDAPQueryTest, TestLDAPFilterMatchServiceReferenceBase)
@@ -36,6 +36,12 @@
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
 US_MSVC_PUSH_DISABLE_WARNING(4996)
 
 using namespace cppmicroservices;
@@ -377,4 +383,247 @@ TEST_F(ServiceListenerTest, frameSL25a)
   sListen.clearEvents();
 }
 
+namespace {
+struct ITenantService
+{
+  virtual ~ITenantService() = default;
+};
+
+struct TenantService : public ITenantService
+{};
+}
+
+TEST_F(ServiceListenerTest, equalityFilters)
+{
+  auto context = framework.GetBundleContext();
+  const std::string clazz = us_service_interface_iid<ITenantService>();
+
+  // Filters which require a property to equal one of a few values are
+  // cached under the values, they must match like any other filter
+  const std::vector<std::string> filters{
+    "(&(objectclass=" + clazz + ")(tenant=abc))",
+    "(|(tenant=abc)(TENANT=xyz))",
+    "(&(objectclass=" + clazz + ")(service.ranking>=1))",
+    "(&(tenant=abc)(!(region=eu)))",
+    "(&(objectclass=" + clazz + ")(tenant=42))"
+  };
+  std::vector<std::vector<ServiceEvent::Type>> events(filters.size());
+  std::vector<ListenerToken> tokens;
+  for (std::size_t i = 0; i < filters.size(); ++i) {
+    tokens.push_back(context.AddServiceListener(
+      [&events, i](const ServiceEvent& evt) {
+        events[i].push_back(evt.GetType());
+      },
+      filters[i]));
+  }
+
+  const auto registered = [&events] {
+    std::vector<std::size_t> counts;
+    for (auto& e : events) {
+      counts.push_back(static_cast<std::size_t>(
+        std::count(e.begin(), e.end(), ServiceEvent::SERVICE_REGISTERED)));
+    }
+    return counts;
+  };
+
+  auto reg1 = context.RegisterService<ITenantService>(
+    std::make_shared<TenantService>(), { { "Tenant", std::string("abc") } });
+  ASSERT_EQ(registered(), (std::vector<std::size_t>{ 1, 1, 0, 1, 0 }));
+
+  context.RegisterService<ITenantService>(
+    std::make_shared<TenantService>(),
+    { { "tenant", std::vector<std::string>{ "xyz", "abc" } },
+      { "region", std::string("eu") },
+      { Constants::SERVICE_RANKING, 1 } });
+  ASSERT_EQ(registered(), (std::vector<std::size_t>{ 2, 2, 1, 1, 0 }));
+
+  context.RegisterService<ITenantService>(std::make_shared<TenantService>(),
+                                          { { "tenant", std::string("ab") } });
+  context.RegisterService<ITenantService>(std::make_shared<TenantService>(),
+                                          { { "tenant", 42 } });
+  ASSERT_EQ(registered(), (std::vector<std::size_t>{ 2, 2, 1, 1, 1 }));
+
+  // a change of the cached property ends the match
+  reg1.UpdateProperties({ { "tenant", std::string("def") } });
+  ASSERT_EQ(events[0].back(), ServiceEvent::SERVICE_MODIFIED_ENDMATCH);
+  ASSERT_EQ(events[1].back(), ServiceEvent::SERVICE_MODIFIED_ENDMATCH);
+  reg1.UpdateProperties({ { "tenant", std::string("abc") } });
+  ASSERT_EQ(events[0].back(), ServiceEvent::SERVICE_MODIFIED);
+
+  // removed listeners are no longer cached
+  for (auto& token : tokens) {
+    context.RemoveListener(std::move(token));
+  }
+  context.RegisterService<ITenantService>(
+    std::make_shared<TenantService>(), { { "tenant", std::string("abc") } });
+  ASSERT_EQ(registered(), (std::vector<std::size_t>{ 2, 2, 1, 1, 1 }));
+}
+
 US_MSVC_POP_WARNING
+
+TEST_F(ServiceListenerTest, nestedEqualityFilters)
+{
+  auto context = framework.GetBundleContext();
+
+  // the listener is cached under the values a, b and c of tenant
+  std::vector<std::string> events;
+  auto token = context.AddServiceListener(
+    [&events](const ServiceEvent& evt) {
+      events.push_back(
+        any_cast<std::string>(evt.GetServiceReference().GetProperty("tenant")));
+    },
+    "(|(tenant=a)(&(|(tenant=b)(x=1))(tenant=c)))");
+
+  for (auto tenant : { "a", "b", "c", "d" }) {
+    context.RegisterService<ITenantService>(
+      std::make_shared<TenantService>(), { { "tenant", std::string(tenant) } });
+  }
+  context.RegisterService<ITenantService>(
+    std::make_shared<TenantService>(),
+    { { "tenant", std::string("c") }, { "x", std::string("1") } });
+  ASSERT_EQ(events, (std::vector<std::string>{ "a", "c" }));
+
+  context.RemoveListener(std::move(token));
+}
+
+#ifdef US_ENABLE_THREADING_SUPPORT
+TEST(ServiceListenerAsyncTest, asyncServiceEvents)
+{
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_SERVICE_EVENT_THREADS, 2 }
+  };
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  auto context = f.GetBundleContext();
+  const std::string clazz = us_service_interface_iid<ITenantService>();
+  const auto callerThread = std::this_thread::get_id();
+
+  // the listener is blocked until all events were caused
+  std::promise<void> gate;
+  auto opened = gate.get_future().share();
+  std::mutex eventsMutex;
+  std::condition_variable eventsCond;
+  std::vector<std::pair<int, ServiceEvent::Type>> events;
+  bool callerCalled = false;
+  context.AddServiceListener(
+    [&](const ServiceEvent& evt) {
+      opened.wait();
+      std::lock_guard<std::mutex> lock(eventsMutex);
+      callerCalled |= std::this_thread::get_id() == callerThread;
+      events.emplace_back(
+        any_cast<int>(evt.GetServiceReference().GetProperty("index")),
+        evt.GetType());
+      eventsCond.notify_all();
+    },
+    "(objectclass=" + clazz + ")");
+  const auto waitForEvents = [&](std::size_t count) {
+    std::unique_lock<std::mutex> lock(eventsMutex);
+    return eventsCond.wait_for(lock, std::chrono::seconds(30), [&] {
+      return events.size() >= count;
+    });
+  };
+
+  std::vector<std::pair<int, ServiceEvent::Type>> expected;
+  std::vector<ServiceRegistration<ITenantService>> regs;
+  for (int i = 0; i < 3; ++i) {
+    regs.push_back(context.RegisterService<ITenantService>(
+      std::make_shared<TenantService>(), { { "index", i } }));
+    expected.emplace_back(i, ServiceEvent::SERVICE_REGISTERED);
+  }
+  for (int i = 0; i < 3; ++i) {
+    regs[i].SetProperties({ { "index", i }, { "tenant", std::string("a") } });
+    expected.emplace_back(i, ServiceEvent::SERVICE_MODIFIED);
+    regs[i].Unregister();
+    expected.emplace_back(i, ServiceEvent::SERVICE_UNREGISTERING);
+  }
+
+  // none of the calls above waited for the listener
+  {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    ASSERT_TRUE(events.empty());
+  }
+  gate.set_value();
+
+  // the events arrive on another thread in the order they occurred
+  ASSERT_TRUE(waitForEvents(expected.size()));
+  {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    ASSERT_EQ(events, expected);
+    ASSERT_FALSE(callerCalled);
+  }
+
+  // pending events are delivered before the framework has stopped
+  context.RegisterService<ITenantService>(std::make_shared<TenantService>(),
+                                          { { "index", 3 } });
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+  std::lock_guard<std::mutex> lock(eventsMutex);
+  ASSERT_GE(events.size(), expected.size() + 1);
+  ASSERT_EQ(events[expected.size()],
+            std::make_pair(3, ServiceEvent::SERVICE_REGISTERED));
+}
+
+namespace {
+
+// A listener of one bundle stops another bundle, whose listener is called
+// at the same time (with more than one thread) or is queued behind it.
+void TestStopBundleFromAsyncListener(int threads)
+{
+  FrameworkConfiguration config{
+    { Constants::FRAMEWORK_SERVICE_EVENT_THREADS, threads }
+  };
+  auto f = FrameworkFactory().NewFramework(config);
+  f.Start();
+  auto context = f.GetBundleContext();
+  auto bundle = InstallLib(context, "TestBundleA");
+  bundle.Start();
+  const std::string filter =
+    "(objectclass=" + us_service_interface_iid<ITenantService>() + ")";
+
+  std::promise<void> called;
+  auto calledFuture = called.get_future();
+  std::atomic<bool> inListener{ false };
+  bundle.GetBundleContext().AddServiceListener(
+    [&](const ServiceEvent&) {
+      inListener = true;
+      called.set_value();
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      inListener = false;
+    },
+    filter);
+
+  std::promise<bool> stopped;
+  auto stoppedFuture = stopped.get_future();
+  context.AddServiceListener(
+    [&](const ServiceEvent&) {
+      if (threads > 1) {
+        calledFuture.wait();
+      }
+      bundle.Stop();
+      // the bundle's listener has returned before its bundle stopped
+      stopped.set_value(!inListener);
+    },
+    filter);
+
+  auto reg = context.RegisterService<ITenantService>(
+    std::make_shared<TenantService>());
+  ASSERT_EQ(stoppedFuture.wait_for(std::chrono::seconds(30)),
+            std::future_status::ready);
+  EXPECT_TRUE(stoppedFuture.get());
+  EXPECT_EQ(bundle.GetState(), Bundle::STATE_RESOLVED);
+  reg.Unregister();
+  f.Stop();
+  f.WaitForStop(std::chrono::milliseconds::zero());
+}
+}
+
+TEST(ServiceListenerAsyncTest, stopBundleFromAsyncListener)
+{
+  TestStopBundleFromAsyncListener(2);
+}
+
+TEST(ServiceListenerAsyncTest, stopBundleFromAsyncListenerOneThread)
+{
+  TestStopBundleFromAsyncListener(1);
+}
+#endif
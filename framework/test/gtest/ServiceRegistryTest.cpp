@@ -24,10 +24,14 @@
 #include "cppmicroservices/Framework.h"
 #include "cppmicroservices/FrameworkEvent.h"
 #include "cppmicroservices/FrameworkFactory.h"
+#include "cppmicroservices/ServiceEvent.h"
 
 #include "TestUtils.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <unordered_set>
 
 using namespace cppmicroservices;
@@ -45,6 +49,9 @@ struct ITestServiceB
 struct TestServiceA : public ITestServiceA
 {};
 
+struct TestServiceB : public ITestServiceB
+{};
+
 // Test the optional macro to provide custom name for a service interface class
 CPPMICROSERVICES_DECLARE_SERVICE_INTERFACE(ITestServiceB,
                                            "com.mycompany.ITestService/1.0");
@@ -219,3 +226,305 @@ TEST_F(ServiceRegistryTest, TestServicePropertiesUpdate)
   reg2.Unregister();
   ASSERT_TRUE(context.GetServiceReferences<ITestServiceA>().empty());
 }
+
+TEST_F(ServiceRegistryTest, TestServicePropertiesPatch)
+{
+  ServiceProperties props;
+  props["name"] = std::string("s1");
+  props["load"] = 1;
+  auto reg1 = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(), props);
+  auto reg2 = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>());
+  auto ref1 = reg1.GetReference();
+
+  std::vector<ServiceEvent::Type> loadEvents;
+  std::vector<ServiceEvent::Type> nameEvents;
+  auto loadToken = context.AddServiceListener(
+    [&loadEvents](const ServiceEvent& evt) {
+      loadEvents.push_back(evt.GetType());
+    },
+    "(load<=5)");
+  auto nameToken = context.AddServiceListener(
+    [&nameEvents](const ServiceEvent& evt) {
+      nameEvents.push_back(evt.GetType());
+    },
+    "(name=s1)");
+
+  // only the patched keys change
+  reg1.UpdateProperties({ { "LOAD", 3 } });
+  ASSERT_EQ(any_cast<int>(ref1.GetProperty("load")), 3);
+  ASSERT_EQ(any_cast<std::string>(ref1.GetProperty("name")), "s1");
+  ASSERT_EQ(loadEvents,
+            std::vector<ServiceEvent::Type>{ ServiceEvent::SERVICE_MODIFIED });
+  ASSERT_EQ(nameEvents,
+            std::vector<ServiceEvent::Type>{ ServiceEvent::SERVICE_MODIFIED });
+
+  // the filter referencing the changed key no longer matches
+  reg1.UpdateProperties({ { "load", 7 } });
+  ASSERT_EQ(loadEvents.back(), ServiceEvent::SERVICE_MODIFIED_ENDMATCH);
+  ASSERT_EQ(nameEvents.back(), ServiceEvent::SERVICE_MODIFIED);
+  ASSERT_TRUE(
+    context.GetServiceReferences<ITestServiceA>("(load<=5)").empty());
+
+  // an empty value removes the key, framework keys are ignored
+  reg1.UpdateProperties(
+    { { "name", Any() }, { Constants::SERVICE_ID, 42L } });
+  ASSERT_TRUE(ref1.GetProperty("name").Empty());
+  ASSERT_NE(any_cast<long>(ref1.GetProperty(Constants::SERVICE_ID)), 42L);
+  ASSERT_EQ(nameEvents.back(), ServiceEvent::SERVICE_MODIFIED_ENDMATCH);
+  ASSERT_EQ(nameEvents.size(), 3);
+
+  // an empty patch fires no event
+  reg1.UpdateProperties({ { Constants::OBJECTCLASS, std::string("x") } });
+  ASSERT_EQ(nameEvents.size(), 3);
+
+  // a ranking change reorders the services
+  ASSERT_EQ(context.GetServiceReference<ITestServiceA>(),
+            reg1.GetReference());
+  reg2.UpdateProperties({ { Constants::SERVICE_RANKING, 10 } });
+  ASSERT_EQ(context.GetServiceReference<ITestServiceA>(),
+            reg2.GetReference());
+
+  // invalid patches leave the properties unchanged
+  ASSERT_THROW(
+    reg1.UpdateProperties({ { Constants::SERVICE_RANKING, std::string("1") },
+                            { "load", 1 } }),
+    std::invalid_argument);
+  ASSERT_THROW(reg1.UpdateProperties({ { "load", 1 }, { "Load", 2 } }),
+               std::invalid_argument);
+  ASSERT_EQ(any_cast<int>(ref1.GetProperty("load")), 7);
+
+  // properties with enough keys to be hashed stay consistent
+  ServiceProperties manyProps;
+  for (int i = 0; i < 12; ++i) {
+    manyProps["key" + std::to_string(i)] = i;
+  }
+  auto reg3 = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(), manyProps);
+  reg3.UpdateProperties(
+    { { "KEY0", Any() }, { "key5", 50 }, { "key12", 12 } });
+  auto ref3 = reg3.GetReference();
+  ASSERT_TRUE(ref3.GetProperty("key0").Empty());
+  ASSERT_EQ(any_cast<int>(ref3.GetProperty("KEY5")), 50);
+  ASSERT_EQ(any_cast<int>(ref3.GetProperty("key11")), 11);
+  ASSERT_EQ(any_cast<int>(ref3.GetProperty("Key12")), 12);
+  ASSERT_EQ(ref3.GetPropertyKeys().size(), manyProps.size() + 3);
+  reg3.Unregister();
+
+  context.RemoveListener(std::move(loadToken));
+  context.RemoveListener(std::move(nameToken));
+  reg1.Unregister();
+  ASSERT_THROW(reg1.UpdateProperties({ { "load", 1 } }), std::logic_error);
+  reg2.Unregister();
+}
+
+TEST_F(ServiceRegistryTest, InvalidFilterForClassWithoutServices)
+{
+  // the class is known to the registry but has no services left, so
+  // the filter is not parsed
+  context
+    .RegisterService<ITestServiceA>(std::make_shared<TestServiceA>())
+    .Unregister();
+  std::vector<ServiceReference<ITestServiceA>> refs;
+  EXPECT_NO_THROW(refs = context.GetServiceReferences<ITestServiceA>("(x="));
+  EXPECT_TRUE(refs.empty());
+}
+
+TEST(ServiceRegistryIndexTest, TestIndexedPropertyQueries)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_INDEX_PROPERTIES] =
+    std::vector<std::string>{ "Plugin.Id" };
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  ServiceProperties propsA;
+  propsA["plugin.id"] = std::string("a");
+  ServiceProperties propsB;
+  propsB["plugin.id"] = std::vector<std::string>{ "b", "c" };
+  propsB[Constants::SERVICE_RANKING] = 10;
+  ServiceProperties propsC;
+  propsC["plugin.id"] = 42;
+
+  auto regA = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(), propsA);
+  auto regB = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(), propsB);
+  auto regC = context.RegisterService<ITestServiceA>(
+    std::make_shared<TestServiceA>(), propsC);
+  (void)context.RegisterService<ITestServiceB>(
+    std::make_shared<TestServiceB>(), propsA);
+
+  auto refs = context.GetServiceReferences<ITestServiceA>("(plugin.id=a)");
+  ASSERT_EQ(refs.size(), 1);
+  ASSERT_EQ(refs.front(), regA.GetReference());
+  refs = context.GetServiceReferences<ITestServiceA>("(PLUGIN.ID=c)");
+  ASSERT_EQ(refs.size(), 1);
+  ASSERT_EQ(refs.front(), regB.GetReference());
+  refs = context.GetServiceReferences<ITestServiceA>("(plugin.id=42)");
+  ASSERT_EQ(refs.size(), 1);
+  ASSERT_EQ(refs.front(), regC.GetReference());
+  ASSERT_TRUE(
+    context.GetServiceReferences<ITestServiceA>("(plugin.id=d)").empty());
+  ASSERT_EQ(context.GetServiceReferences("", "(plugin.id=a)").size(), 2);
+
+  // disjunctions and conjunctions of equality terms are served by the
+  // index, in ranking order
+  refs = context.GetServiceReferences<ITestServiceA>(
+    "(&(|(plugin.id=a)(plugin.id=b))(service.id>=0))");
+  ASSERT_EQ(refs.size(), 2);
+  ASSERT_EQ(refs[0], regB.GetReference());
+  ASSERT_EQ(refs[1], regA.GetReference());
+
+  // a service filed under several of the values is returned once
+  refs = context.GetServiceReferences<ITestServiceA>(
+    "(|(plugin.id=c)(plugin.id=a)(plugin.id=b))");
+  ASSERT_EQ(refs.size(), 2);
+  ASSERT_EQ(refs[0], regB.GetReference());
+  ASSERT_EQ(refs[1], regA.GetReference());
+
+  // a nested disjunction which cannot be served by the index must not
+  // drop the values collected before it
+  refs = context.GetServiceReferences<ITestServiceA>(
+    "(|(plugin.id=a)(&(|(plugin.id=b)(x=1))(plugin.id=c)))");
+  ASSERT_EQ(refs.size(), 2);
+  ASSERT_EQ(refs[0], regB.GetReference());
+  ASSERT_EQ(refs[1], regA.GetReference());
+
+  // wildcards fall back to evaluating every service
+  ASSERT_EQ(
+    context.GetServiceReferences<ITestServiceA>("(plugin.id=*)").size(), 3);
+
+  propsA["plugin.id"] = std::string("d");
+  regA.SetProperties(propsA);
+  ASSERT_TRUE(
+    context.GetServiceReferences<ITestServiceA>("(plugin.id=a)").empty());
+  refs = context.GetServiceReferences<ITestServiceA>("(plugin.id=d)");
+  ASSERT_EQ(refs.size(), 1);
+  ASSERT_EQ(refs.front(), regA.GetReference());
+
+  // a ranking change moves the service in the indexed lists
+  regB.UpdateProperties({ { "plugin.id", std::string("d") } });
+  regA.UpdateProperties({ { Constants::SERVICE_RANKING, 20 } });
+  refs = context.GetServiceReferences<ITestServiceA>("(plugin.id=d)");
+  ASSERT_EQ(refs.size(), 2);
+  ASSERT_EQ(refs[0], regA.GetReference());
+  ASSERT_EQ(refs[1], regB.GetReference());
+
+  regB.Unregister();
+  ASSERT_TRUE(
+    context.GetServiceReferences<ITestServiceA>("(plugin.id=b)").empty());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(ServiceRegistrySnapshotTest, TestSnapshotLookups)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_SNAPSHOTS] = true;
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  auto s1 = std::make_shared<TestServiceA>();
+  auto s2 = std::make_shared<TestServiceA>();
+  ServiceProperties props;
+  props["name"] = std::string("s1");
+  auto reg1 = context.RegisterService<ITestServiceA>(s1, props);
+  props["name"] = std::string("s2");
+  props[Constants::SERVICE_RANKING] = 10;
+  auto reg2 = context.RegisterService<ITestServiceA>(s2, props);
+
+  ASSERT_EQ(context.GetServiceReferences<ITestServiceA>().size(), 2);
+  ASSERT_EQ(context.GetServiceReference<ITestServiceA>(), reg2.GetReference());
+  ASSERT_EQ(context.GetServiceReferences<ITestServiceA>("(name=s1)").size(),
+            1);
+  ASSERT_EQ(context.GetServiceReferences("", "(name=s*)").size(), 2);
+
+  // a ranking change publishes the new order
+  props["name"] = std::string("s1");
+  props[Constants::SERVICE_RANKING] = 20;
+  reg1.SetProperties(props);
+  ASSERT_EQ(context.GetServiceReference<ITestServiceA>(), reg1.GetReference());
+
+  // lookups are consistent while services are concurrently (un)registered
+  std::atomic<bool> stop(false);
+  std::thread writer([&context, &stop] {
+    while (!stop) {
+      context.RegisterService<ITestServiceA>(std::make_shared<TestServiceA>())
+        .Unregister();
+    }
+  });
+  // no ASSERT in the loop, the writer must be joined before returning
+  for (int i = 0; i < 1000; ++i) {
+    auto refs = context.GetServiceReferences<ITestServiceA>();
+    EXPECT_TRUE(refs.size() == 2 || refs.size() == 3);
+    EXPECT_TRUE(!refs.empty() && refs.front() == reg1.GetReference());
+  }
+  stop = true;
+  writer.join();
+
+  reg1.Unregister();
+  ASSERT_EQ(context.GetServiceReference<ITestServiceA>(), reg2.GetReference());
+  reg2.Unregister();
+  ASSERT_TRUE(context.GetServiceReferences<ITestServiceA>().empty());
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
+
+TEST(ServiceRegistrySnapshotTest, TestSnapshotManyServices)
+{
+  FrameworkConfiguration config;
+  config[Constants::FRAMEWORK_SERVICE_SNAPSHOTS] = true;
+  auto framework = FrameworkFactory().NewFramework(config);
+  framework.Start();
+  auto context = framework.GetBundleContext();
+
+  // enough services to spread the snapshot lists over several chunks
+  std::vector<ServiceRegistration<ITestServiceA>> regs;
+  for (int i = 0; i < 300; ++i) {
+    regs.push_back(context.RegisterService<ITestServiceA>(
+      std::make_shared<TestServiceA>(),
+      { { Constants::SERVICE_RANKING, i % 7 } }));
+  }
+  auto expectOrder = [&context](std::vector<ServiceReferenceU> expected) {
+    std::stable_sort(
+      expected.begin(), expected.end(), [](const auto& r1, const auto& r2) {
+        return any_cast<int>(r1.GetProperty(Constants::SERVICE_RANKING)) >
+               any_cast<int>(r2.GetProperty(Constants::SERVICE_RANKING));
+      });
+    auto refs = context.GetServiceReferences<ITestServiceA>();
+    ASSERT_EQ(refs.size(), expected.size());
+    for (std::size_t i = 0; i < refs.size(); ++i) {
+      EXPECT_EQ(ServiceReferenceU(refs[i]), expected[i]) << i;
+    }
+    EXPECT_EQ(context.GetServiceReferences("", "(service.ranking=*)").size(),
+              expected.size());
+  };
+  std::vector<ServiceReferenceU> expected;
+  for (auto& reg : regs) {
+    expected.push_back(reg.GetReference());
+  }
+  expectOrder(expected);
+
+  // reorder some services and unregister others
+  for (std::size_t i = 0; i < regs.size(); i += 5) {
+    regs[i].SetProperties({ { Constants::SERVICE_RANKING, 10 } });
+  }
+  expected.clear();
+  for (std::size_t i = 0; i < regs.size(); ++i) {
+    if (i % 3 == 0) {
+      regs[i].Unregister();
+    } else {
+      expected.push_back(regs[i].GetReference());
+    }
+  }
+  expectOrder(expected);
+
+  framework.Stop();
+  framework.WaitForStop(std::chrono::milliseconds::zero());
+}
@@ -20,12 +20,16 @@ limitations under the License.
 
 =============================================================================*/
 
+#include "cppmicroservices/detail/Threads.h"
 #include "cppmicroservices/util/FileSystem.h"
 
 #include <TestUtils.h>
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 using namespace cppmicroservices;
 using namespace cppmicroservices::testing;
 using namespace cppmicroservices::util;
@@ -149,3 +153,54 @@ TEST_F(UtilsFs, MakeAndRemovePath)
   ASSERT_NO_THROW(MakePath(validPath));
   ASSERT_NO_THROW(RemoveDirectoryRecursive(validPath));
 }
+
+TEST(UtilsAtomic, SharedPtrOperations)
+{
+  detail::Atomic<std::shared_ptr<int>> a;
+  EXPECT_EQ(nullptr, a.Load());
+
+  auto one = std::make_shared<int>(1);
+  a.Store(one);
+  EXPECT_EQ(one, a.Load());
+  EXPECT_EQ(2, one.use_count());
+
+  auto two = std::make_shared<int>(2);
+  EXPECT_EQ(one, a.Exchange(two));
+  EXPECT_EQ(1, one.use_count());
+
+  std::shared_ptr<int> expected = one;
+  EXPECT_FALSE(a.CompareExchange(expected, one));
+  EXPECT_EQ(two, expected);
+  EXPECT_TRUE(a.CompareExchange(expected, one));
+  EXPECT_EQ(one, a.Load());
+
+  a.Store(nullptr);
+  EXPECT_EQ(nullptr, a.Load());
+  EXPECT_EQ(1, one.use_count());
+  EXPECT_EQ(2, two.use_count());
+}
+
+TEST(UtilsAtomic, SharedPtrConcurrentLoadStore)
+{
+  detail::Atomic<std::shared_ptr<int>> a(std::make_shared<int>(0));
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&a]() {
+      for (int j = 0; j < 100000; ++j) {
+        auto value = a.Load();
+        ASSERT_TRUE(value);
+        ASSERT_GE(*value, 0);
+      }
+    });
+  }
+  for (int i = 1; i < 20000; ++i) {
+    a.Store(std::make_shared<int>(i));
+    auto expected = a.Load();
+    a.CompareExchange(expected, std::make_shared<int>(i));
+  }
+  for (auto& t : readers) {
+    t.join();
+  }
+  EXPECT_EQ(19999, *a.Load());
+}
@@ -30,6 +30,8 @@ limitations under the License.
 
 #include <TestingConfig.h>
 
+#include "miniz.h"
+
 #ifndef US_PLATFORM_WINDOWS
 #  include <sys/time.h> // gettimeofday etc.
 #else
@@ -42,6 +44,7 @@ limitations under the License.
 #  include <unistd.h> // chdir, getpid, close, etc.
 #endif
 
+#include <cstring>
 #include <fcntl.h>
 #include <sys/stat.h> // mkdir, _S_IREAD, etc.
 
@@ -488,6 +491,44 @@ Bundle GetBundle(const std::string& bsn, BundleContext context)
   }
   return {};
 }
+
+void WriteZipBundle(
+  const std::string& location,
+  const std::string& bundleName,
+  const std::vector<std::pair<std::string, std::string>>& resources,
+  bool compress,
+  const std::string& manifestHeaders)
+{
+  const std::string manifest("{ \"bundle.symbolic_name\" : \"" +
+                             bundleName + "\", " + manifestHeaders + " }");
+  const mz_uint stored = MZ_NO_COMPRESSION;
+  const mz_uint level =
+    compress ? static_cast<mz_uint>(MZ_DEFAULT_COMPRESSION) : stored;
+
+  mz_zip_archive zip;
+  memset(&zip, 0, sizeof(mz_zip_archive));
+  if (!mz_zip_writer_init_file(&zip, location.c_str(), 0)) {
+    throw std::runtime_error("Could not create zip file " + location);
+  }
+  auto addEntry = [&zip, stored, level](const std::string& path,
+                                const std::string& data) {
+    return mz_zip_writer_add_mem(&zip,
+                                 path.c_str(),
+                                 data.c_str(),
+                                 data.size(),
+                                 data.empty() ? stored : level);
+  };
+  bool ok = addEntry(bundleName + "/", std::string()) &&
+            addEntry(bundleName + "/manifest.json", manifest);
+  for (auto const& resource : resources) {
+    ok = ok && addEntry(bundleName + "/" + resource.first, resource.second);
+  }
+  ok = mz_zip_writer_finalize_archive(&zip) && ok;
+  mz_zip_writer_end(&zip);
+  if (!ok) {
+    throw std::runtime_error("Could not write zip file " + location);
+  }
+}
 }
 }
 
@@ -27,6 +27,8 @@ limitations under the License.
 #include "cppmicroservices/BundleContext.h"
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #ifdef US_PLATFORM_APPLE
 #  include <mach/mach_time.h>
@@ -156,6 +158,22 @@ File MakeUniqueTempFile(const std::string& base);
 Bundle GetBundle(const std::string& bsn,
                  BundleContext context = BundleContext());
 
+/*
+ * Writes a zip file bundle to location. Its manifest.json contains the
+ * bundle symbolic name followed by manifestHeaders, which is inserted
+ * verbatim into the JSON object. The resources are pairs of paths,
+ * relative to the bundle root directory, and contents; paths ending
+ * with '/' add directory entries.
+ *
+ * @throws std::runtime_error if the zip file cannot be written
+ */
+void WriteZipBundle(
+  const std::string& location,
+  const std::string& bundleName,
+  const std::vector<std::pair<std::string, std::string>>& resources = {},
+  bool compress = true,
+  const std::string& manifestHeaders = "\"bundle.version\" : \"1.0.0\"");
+
 } // namespace testing
 } // namespace cppmicroservices
 
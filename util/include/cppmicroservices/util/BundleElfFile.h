@@ -25,13 +25,11 @@
 #  include "BundleObjFile.h"
 #  include "MappedFile.h"
 
+#  include <algorithm>
 #  include <cerrno>
 #  include <cstring>
 #  include <elf.h>
-#  include <fstream>
-#  include <map>
 #  include <memory>
-#  include <new>
 
 #  include <sys/stat.h>
 
@@ -44,6 +42,46 @@ struct InvalidElfException : public InvalidObjFileException
   {}
 };
 
+// Closes a file descriptor at the end of its scope
+struct ElfFileDescriptor
+{
+  explicit ElfFileDescriptor(int fileDesc)
+    : fileDesc(fileDesc)
+  {}
+  ~ElfFileDescriptor()
+  {
+    if (0 <= fileDesc) {
+      close(fileDesc);
+    }
+  }
+  ElfFileDescriptor(const ElfFileDescriptor&) = delete;
+  ElfFileDescriptor& operator=(const ElfFileDescriptor&) = delete;
+
+  int fileDesc;
+};
+
+// Reads size bytes at offset, without moving the file position
+inline bool ReadElfFile(int fileDesc,
+                        void* buffer,
+                        std::size_t size,
+                        std::size_t offset)
+{
+  auto* data = static_cast<char*>(buffer);
+  while (size > 0) {
+    auto read = pread(fileDesc, data, size, static_cast<off_t>(offset));
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return false;
+    }
+    data += read;
+    offset += static_cast<std::size_t>(read);
+    size -= static_cast<std::size_t>(read);
+  }
+  return true;
+}
+
 template<int>
 struct Elf;
 
@@ -101,7 +139,11 @@ public:
   typedef typename ElfType::Word Word;
   typedef typename ElfType::Off Off;
 
-  BundleElfFile(std::ifstream& fs,
+  /// Finds the .us_resources section with one read each for the section
+  /// headers and the section names. The section is then mapped into
+  /// memory.
+  BundleElfFile(int fileDesc,
+                const char* header,
                 std::size_t fileSize,
                 const std::string& fileName)
     : m_rawData()
@@ -110,51 +152,66 @@ public:
       throw InvalidElfException("Missing ELF header");
     }
 
-    fs.seekg(0);
-
-    // Read the ELF header
     Ehdr elfHeader;
-    fs.read(reinterpret_cast<char*>(&elfHeader), sizeof elfHeader);
+    memcpy(&elfHeader, header, sizeof elfHeader);
 
     if (elfHeader.e_type != ET_DYN) {
       throw InvalidElfException("Not an ELF shared library");
     }
 
-    if (elfHeader.e_shoff + (elfHeader.e_shnum * elfHeader.e_shentsize) >
-        fileSize) {
+    if (elfHeader.e_shentsize != sizeof(Shdr) ||
+        elfHeader.e_shoff > fileSize ||
+        elfHeader.e_shnum * sizeof(Shdr) > fileSize - elfHeader.e_shoff) {
       throw InvalidElfException("ELF section headers missing");
     }
+    if (elfHeader.e_shstrndx >= elfHeader.e_shnum) {
+      return;
+    }
 
     // read in all section headers
     auto sectionHeaders = std::make_unique<Shdr[]>(elfHeader.e_shnum);
-    fs.seekg(elfHeader.e_shoff);
-    fs.read(reinterpret_cast<char*>(sectionHeaders.get()),
-            sizeof(Shdr) * elfHeader.e_shnum);
+    if (!ReadElfFile(fileDesc,
+                     sectionHeaders.get(),
+                     sizeof(Shdr) * elfHeader.e_shnum,
+                     elfHeader.e_shoff)) {
+      throw InvalidElfException("Reading ELF section headers failed", errno);
+    }
+
+    const Shdr& names = sectionHeaders[elfHeader.e_shstrndx];
+    if (names.sh_offset > fileSize ||
+        names.sh_size > fileSize - names.sh_offset) {
+      throw InvalidElfException("ELF section names missing");
+    }
+    auto buffer = std::make_unique<char[]>(names.sh_size);
+    if (!ReadElfFile(fileDesc, buffer.get(), names.sh_size, names.sh_offset)) {
+      throw InvalidElfException("Reading ELF section names failed", errno);
+    }
 
     // parse the .us_resources section
-    // keep the buffer in a smart pointer to correctly clean up at end
-    // of scope even if exceptions occur.
-    auto buffer =
-      std::make_unique<char[]>(sectionHeaders[elfHeader.e_shstrndx].sh_size);
-    if (nullptr != buffer) {
-      fs.seekg(sectionHeaders[elfHeader.e_shstrndx].sh_offset);
-      fs.read(buffer.get(), sectionHeaders[elfHeader.e_shstrndx].sh_size);
-
-      for (int i = 0; i < elfHeader.e_shnum; ++i) {
-        if (0 == strcmp(".us_resources",
-                        (buffer.get() + sectionHeaders[i].sh_name))) {
-          fs.seekg(sectionHeaders[i].sh_offset);
-          auto zipContentSize = sectionHeaders[i].sh_size;
-          if (0 < zipContentSize) {
-            off_t pa_offset =
-              (sectionHeaders[i].sh_offset) & ~(sysconf(_SC_PAGESIZE) - 1);
-            size_t mappedLength =
-              zipContentSize + (sectionHeaders[i].sh_offset) - pa_offset;
-            m_rawData = std::make_shared<RawBundleResources>(
-              std::make_unique<MappedFile>(fileName, mappedLength, pa_offset));
-            break;
-          }
-        }
+    static const char resourceSection[] = ".us_resources";
+    for (int i = 0; i < elfHeader.e_shnum; ++i) {
+      const Shdr& section = sectionHeaders[i];
+      if (section.sh_name >= names.sh_size ||
+          names.sh_size - section.sh_name < sizeof resourceSection ||
+          0 != memcmp(resourceSection,
+                      buffer.get() + section.sh_name,
+                      sizeof resourceSection)) {
+        continue;
+      }
+      auto zipContentSize = section.sh_size;
+      if (0 < zipContentSize && section.sh_offset <= fileSize &&
+          zipContentSize <= fileSize - section.sh_offset) {
+        off_t pa_offset = section.sh_offset & ~(sysconf(_SC_PAGESIZE) - 1);
+        size_t mappedLength = zipContentSize + section.sh_offset - pa_offset;
+        // expose the section itself, without the leading bytes of the
+        // first mapped page
+        m_rawData = std::make_shared<RawBundleResources>(
+          std::make_unique<MappedFileRange>(
+            std::make_shared<const MappedFile>(
+              fileName, mappedLength, pa_offset),
+            section.sh_offset - pa_offset,
+            zipContentSize));
+        break;
       }
     }
   }
@@ -171,9 +228,10 @@ private:
 
 std::unique_ptr<BundleObjFile> CreateBundleElfFile(const std::string& fileName)
 {
-  struct stat elfStat;
   errno = 0;
-  if (stat(fileName.c_str(), &elfStat) != 0) {
+  ElfFileDescriptor elfFile(open(fileName.c_str(), O_RDONLY));
+  struct stat elfStat;
+  if (elfFile.fileDesc < 0 || fstat(elfFile.fileDesc, &elfStat) != 0) {
     throw InvalidElfException("Stat for " + fileName + " failed", errno);
   }
 
@@ -183,30 +241,25 @@ std::unique_ptr<BundleObjFile> CreateBundleElfFile(const std::string& fileName)
     throw InvalidElfException("Missing ELF identification");
   }
 
-  std::ifstream elfFile(fileName.c_str(), std::ios_base::binary);
-  elfFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-  char elfIdent[EI_NIDENT];
-  elfFile.read(elfIdent, sizeof elfIdent);
-
-  if (memcmp(elfIdent, ELFMAG, SELFMAG) != 0) {
-    throw InvalidElfException("Not an ELF object file");
+  // Read the identification and the ELF header of either class at once
+  char elfHeader[sizeof(Elf64_Ehdr)];
+  if (!ReadElfFile(elfFile.fileDesc,
+                   elfHeader,
+                   std::min(fileSize, sizeof elfHeader),
+                   0)) {
+    throw InvalidElfException("Reading " + fileName + " failed", errno);
   }
 
-  std::ifstream selfFile(fileName, std::ios_base::binary);
-  char selfIdent[EI_NIDENT];
-  selfFile.read(selfIdent, sizeof selfIdent);
-  selfFile.close();
-  if (memcmp(elfIdent, selfIdent, EI_VERSION) != 0) {
-    throw InvalidElfException("Not a compatible ELF object file");
+  if (memcmp(elfHeader, ELFMAG, SELFMAG) != 0) {
+    throw InvalidElfException("Not an ELF object file");
   }
 
-  if (elfIdent[EI_CLASS] == ELFCLASS32) {
-    return std::unique_ptr<BundleObjFile>(
-      new BundleElfFile<Elf<ELFCLASS32>>(elfFile, fileSize, fileName));
-  } else if (elfIdent[EI_CLASS] == ELFCLASS64) {
-    return std::unique_ptr<BundleObjFile>(
-      new BundleElfFile<Elf<ELFCLASS64>>(elfFile, fileSize, fileName));
+  if (elfHeader[EI_CLASS] == ELFCLASS32) {
+    return std::unique_ptr<BundleObjFile>(new BundleElfFile<Elf<ELFCLASS32>>(
+      elfFile.fileDesc, elfHeader, fileSize, fileName));
+  } else if (elfHeader[EI_CLASS] == ELFCLASS64) {
+    return std::unique_ptr<BundleObjFile>(new BundleElfFile<Elf<ELFCLASS64>>(
+      elfFile.fileDesc, elfHeader, fileSize, fileName));
   } else {
     throw InvalidElfException("Unknown ELF format");
   }
@@ -23,6 +23,7 @@
 #ifndef CPPMICROSERVICES_UTIL_FILESYSTEM_H
 #define CPPMICROSERVICES_UTIL_FILESYSTEM_H
 
+#include <cstdint>
 #include <string>
 
 namespace cppmicroservices {
@@ -48,6 +49,11 @@ bool IsDirectory(const std::string& path);
 bool IsFile(const std::string& path);
 bool IsRelative(const std::string& path);
 
+// Get the size in bytes and the last modification time in nanoseconds
+// since the epoch of a file. Returns false if the file does not exist.
+// The modification time has the resolution of the file system.
+bool GetFileInfo(const std::string& path, uint64_t& size, int64_t& modified);
+
 std::string GetAbsolute(const std::string& path, const std::string& base);
 
 void MakePath(const std::string& path);
@@ -27,6 +27,9 @@
 
 #    include "DataContainer.h"
 
+#    include <memory>
+#    include <utility>
+
 #    include <fcntl.h>
 #    include <sys/mman.h>
 #    include <sys/stat.h>
@@ -77,6 +80,30 @@ private:
   size_t mapSize;
 };
 
+/// A range of bytes of a mapped file, which keeps the mapping alive.
+class MappedFileRange final : public DataContainer
+{
+public:
+  MappedFileRange(std::shared_ptr<const MappedFile> file,
+                  std::size_t offset,
+                  std::size_t size)
+    : file(std::move(file))
+    , offset(offset)
+    , size(size)
+  {}
+
+  void* GetData() const override
+  {
+    return static_cast<char*>(file->GetData()) + offset;
+  }
+  std::size_t GetSize() const override { return size; }
+
+private:
+  std::shared_ptr<const MappedFile> file;
+  std::size_t offset;
+  std::size_t size;
+};
+
 }
 #  endif // CPPMICROSERVICES_MAPPEDFILE_H
 
@@ -247,6 +247,26 @@ bool IsFile(const std::string& path)
   return S_ISREG(s.st_mode);
 }
 
+bool GetFileInfo(const std::string& path, uint64_t& size, int64_t& modified)
+{
+  US_STAT s;
+  errno = 0;
+  if (us_stat(path.c_str(), &s)) {
+    if (not_found_c_error(errno))
+      return false;
+    else
+      throw std::invalid_argument(GetLastCErrorStr());
+  }
+  size = static_cast<uint64_t>(s.st_size);
+  modified = static_cast<int64_t>(s.st_mtime) * 1000000000;
+#if defined(US_PLATFORM_APPLE)
+  modified += s.st_mtimespec.tv_nsec;
+#elif defined(US_PLATFORM_LINUX)
+  modified += s.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
 bool IsRelative(const std::string& path)
 {
 #ifdef US_PLATFORM_WINDOWS